@@ -0,0 +1,101 @@
+#ifndef ONEAPI_CRYSTAL_BITPACKED_HPP
+#define ONEAPI_CRYSTAL_BITPACKED_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <cstdint>
+
+namespace crystal {
+
+    // number of values sharing a reference and a bit width,
+    // must match BITPACK_BLOCK_SIZE of ssb/loader/bitpack.c
+    constexpr int bitpack_block_size = 128;
+
+    /**
+     * @brief Decodes the i-th value of a bit-packed column.
+     *        Every block of the data section starts with its
+     *        reference and bit width, followed by the packed
+     *        differences from the reference
+     */
+    template <typename T>
+    inline T unpack(
+            const uint32_t *block_starts,
+            const uint32_t *data,
+            int i
+    )
+    {
+        const uint32_t *block = data + block_starts[i / bitpack_block_size];
+        uint32_t reference = block[0];
+        uint32_t bit_width = block[1];
+
+        uint32_t bit_pos = (i % bitpack_block_size) * bit_width;
+        const uint32_t *word = block + 2 + (bit_pos >> 5);
+
+        // a value may straddle two words, the encoder
+        // pads the column so reading word[1] is always safe
+        uint64_t packed = ((uint64_t)word[1] << 32) | word[0];
+        uint32_t mask = (uint32_t)(((uint64_t)1 << bit_width) - 1);
+
+        return (T)(reference + ((uint32_t)(packed >> (bit_pos & 31)) & mask));
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load_bitpacked_direct (
+            const unsigned int tid,
+            const uint32_t *block_starts,
+            const uint32_t *data,
+            int tile_offset,
+            T (&items)[items_per_thread]
+    )
+    {
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            items[i] = unpack<T>(block_starts, data, tile_offset + tid + i * block_threads);
+        }
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load_bitpacked_direct (
+            const unsigned int tid,
+            const uint32_t *block_starts,
+            const uint32_t *data,
+            int tile_offset,
+            T (&items)[items_per_thread],
+            int num_items
+    )
+    {
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_items) {
+                items[i] = unpack<T>(block_starts, data, tile_offset + tid + i * block_threads);
+            }
+        }
+    }
+
+    /**
+     * @brief Loads the tile starting at tile_offset of a bit-packed
+     *        column, as written by ssb/loader/bitpack.c, decoding
+     *        it into the same blocked arrangement used by load
+     */
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load_bitpacked(
+            const uint32_t *block_starts,
+            const uint32_t *data,
+            int tile_offset,
+            T (&items)[items_per_thread],
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        if ((block_threads * items_per_thread) == num_items) {
+            load_bitpacked_direct<T, block_threads, items_per_thread>(
+                    item_ct1.get_local_id(0), block_starts, data, tile_offset, items);
+        } else {
+            load_bitpacked_direct<T, block_threads, items_per_thread>(
+                    item_ct1.get_local_id(0), block_starts, data, tile_offset, items, num_items);
+        }
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_BITPACKED_HPP
@@ -0,0 +1,172 @@
+#ifndef ONEAPI_CRYSTAL_COMPACT_HPP
+#define ONEAPI_CRYSTAL_COMPACT_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include "join.hpp"
+#include "scan.hpp"
+
+namespace crystal {
+
+    /**
+     * Compacted tiles: block_compact writes the positions (within the
+     * tile) of the selected items into a selection vector in local
+     * memory and returns how many they are. Later stages gather only
+     * those rows with load_selected / probe_selected_linear_2, in the
+     * same striped arrangement as load: thread tid holds entries
+     * tid, tid + block_threads, ... of the selection vector. Any other
+     * block function works on the compacted arrays by passing the
+     * number of selected rows as num_items.
+     * Every thread of the work-group must call block_compact, and
+     * gets the same result.
+     */
+
+    /**
+     * @brief Compacts a tile of num_items items into the selection
+     *        vector, which needs block_threads * items_per_thread
+     *        entries. Afterwards selection_flags are all set
+     * @return int      number of selected items
+     */
+    template <int block_threads, int items_per_thread>
+    inline int block_compact(
+            int (&selection_flags)[items_per_thread],
+            int *selection,
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        int tid = item_ct1.get_local_id(0);
+        int count = 0;
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_items && selection_flags[i]) {
+                count++;
+            }
+        }
+
+        int num_selected;
+        int offset = group_exclusive_sum(count, num_selected, item_ct1);
+
+        // the selection vector may still be read by a previous stage
+        item_ct1.barrier(sycl::access::fence_space::local_space);
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_items && selection_flags[i]) {
+                selection[offset++] = tid + (i * block_threads);
+            }
+        }
+
+        item_ct1.barrier(sycl::access::fence_space::local_space);
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            selection_flags[i] = 1;
+        }
+
+        return num_selected;
+    }
+
+    /**
+     * @brief Same as block_compact, also moving values (e.g. the
+     *        result of a probe) to the compacted arrangement, so
+     *        that they need not be gathered again
+     * @param local_values  local memory of block_threads * items_per_thread
+     *                      entries
+     */
+    template <typename T, int block_threads, int items_per_thread>
+    inline int block_compact(
+            T (&values)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            int *selection,
+            T *local_values,
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        int tid = item_ct1.get_local_id(0);
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_items && selection_flags[i]) {
+                local_values[tid + (i * block_threads)] = values[i];
+            }
+        }
+
+        int num_selected = block_compact<block_threads, items_per_thread>(
+                selection_flags, selection, num_items, item_ct1);
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_selected) {
+                values[i] = local_values[selection[tid + (i * block_threads)]];
+            }
+        }
+
+        // local_values may be reused by the next stage
+        item_ct1.barrier(sycl::access::fence_space::local_space);
+
+        return num_selected;
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load_selected_direct(
+            const unsigned int tid,
+            const T *block_itr,
+            const int *selection,
+            T (&items)[items_per_thread],
+            int num_selected
+    )
+    {
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_selected) {
+                items[i] = block_itr[selection[tid + (i * block_threads)]];
+            }
+        }
+    }
+
+    /**
+     * @brief Gathers the selected rows of the tile starting at
+     *        block_itr, in the compacted arrangement
+     */
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load_selected(
+            const T *block_itr,
+            const int *selection,
+            T (&items)[items_per_thread],
+            int num_selected,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        load_selected_direct<T, block_threads, items_per_thread>(
+                item_ct1.get_local_id(0), block_itr, selection, items, num_selected);
+    }
+
+    /**
+     * @brief Gathers the foreign keys of the selected rows and
+     *        probes them in an open addressing table, as
+     *        probe_linear_2, fetching the values in res
+     */
+    template <typename K, typename V, int block_threads, int items_per_thread>
+    inline void probe_selected_linear_2(
+            const K *block_itr,
+            const int *selection,
+            K (&items)[items_per_thread],
+            V (&res)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            K *ht,
+            int ht_len,
+            int num_selected,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        load_selected<K, block_threads, items_per_thread>(block_itr, selection, items, num_selected, item_ct1);
+        probe_linear_2<K, V, block_threads, items_per_thread>(items, res, selection_flags, ht, ht_len,
+                num_selected, item_ct1);
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_COMPACT_HPP
@@ -0,0 +1,146 @@
+#ifndef ONEAPI_CRYSTAL_DICT_HPP
+#define ONEAPI_CRYSTAL_DICT_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <cstdint>
+
+namespace crystal {
+
+    /**
+     * @brief Extracts the i-th code of a dictionary-encoded
+     *        column, packed 32 / bit_width codes per word with
+     *        the first code in the least significant bits
+     */
+    inline int dict_code(
+            const uint32_t *codes,
+            int bit_width,
+            int i
+    )
+    {
+        int codes_per_word = 32 / bit_width;
+        uint32_t word = codes[i / codes_per_word];
+        uint32_t mask = (1u << bit_width) - 1;
+
+        return (word >> ((i % codes_per_word) * bit_width)) & mask;
+    }
+
+    template <int block_threads, int items_per_thread>
+    inline void load_dict_codes_direct (
+            const unsigned int tid,
+            const uint32_t *codes,
+            int bit_width,
+            int tile_offset,
+            int (&items)[items_per_thread]
+    )
+    {
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            items[i] = dict_code(codes, bit_width, tile_offset + tid + i * block_threads);
+        }
+    }
+
+    template <int block_threads, int items_per_thread>
+    inline void load_dict_codes_direct (
+            const unsigned int tid,
+            const uint32_t *codes,
+            int bit_width,
+            int tile_offset,
+            int (&items)[items_per_thread],
+            int num_items
+    )
+    {
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_items) {
+                items[i] = dict_code(codes, bit_width, tile_offset + tid + i * block_threads);
+            }
+        }
+    }
+
+    /**
+     * @brief Loads the codes of a tile of a dictionary-encoded
+     *        column without decoding them, so that equality
+     *        predicates can run on the codes directly
+     */
+    template <int block_threads, int items_per_thread>
+    inline void load_dict_codes(
+            const uint32_t *codes,
+            int bit_width,
+            int tile_offset,
+            int (&items)[items_per_thread],
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        if ((block_threads * items_per_thread) == num_items) {
+            load_dict_codes_direct<block_threads, items_per_thread>(
+                    item_ct1.get_local_id(0), codes, bit_width, tile_offset, items);
+        } else {
+            load_dict_codes_direct<block_threads, items_per_thread>(
+                    item_ct1.get_local_id(0), codes, bit_width, tile_offset, items, num_items);
+        }
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load_dict_direct (
+            const unsigned int tid,
+            const uint32_t *codes,
+            const T *dict,
+            int bit_width,
+            int tile_offset,
+            T (&items)[items_per_thread]
+    )
+    {
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            items[i] = dict[dict_code(codes, bit_width, tile_offset + tid + i * block_threads)];
+        }
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load_dict_direct (
+            const unsigned int tid,
+            const uint32_t *codes,
+            const T *dict,
+            int bit_width,
+            int tile_offset,
+            T (&items)[items_per_thread],
+            int num_items
+    )
+    {
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_items) {
+                items[i] = dict[dict_code(codes, bit_width, tile_offset + tid + i * block_threads)];
+            }
+        }
+    }
+
+    /**
+     * @brief Loads a tile of a dictionary-encoded column
+     *        decoding every code into its dictionary value
+     */
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load_dict(
+            const uint32_t *codes,
+            const T *dict,
+            int bit_width,
+            int tile_offset,
+            T (&items)[items_per_thread],
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        if ((block_threads * items_per_thread) == num_items) {
+            load_dict_direct<T, block_threads, items_per_thread>(
+                    item_ct1.get_local_id(0), codes, dict, bit_width, tile_offset, items);
+        } else {
+            load_dict_direct<T, block_threads, items_per_thread>(
+                    item_ct1.get_local_id(0), codes, dict, bit_width, tile_offset, items, num_items);
+        }
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_DICT_HPP
@@ -0,0 +1,455 @@
+#ifndef ONEAPI_CRYSTAL_GROUP_BY_HPP
+#define ONEAPI_CRYSTAL_GROUP_BY_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "oneapi_crystal/utils/atomic.hpp"
+
+namespace crystal {
+
+    /**
+     * Aggregate functors for group_by: identity is the value the
+     * accumulators start from, operator() folds a value into a
+     * global accumulator and fold_local into a work-group local one,
+     * merge folds a partial aggregate into a global accumulator.
+     * Accumulators are 64 bit signed integers
+     */
+    struct Sum {
+        static constexpr long long identity = 0;
+
+        inline void operator()(long long &acc, long long value) const {
+            atomicAdd(acc, value);
+        }
+
+        inline void fold_local(long long &acc, long long value) const {
+            atomicAddLocal(acc, value);
+        }
+
+        inline void merge(long long &acc, long long partial) const {
+            atomicAdd(acc, partial);
+        }
+    };
+
+    struct Count {
+        static constexpr long long identity = 0;
+
+        inline void operator()(long long &acc, long long) const {
+            atomicAdd(acc, 1LL);
+        }
+
+        inline void fold_local(long long &acc, long long) const {
+            atomicAddLocal(acc, 1LL);
+        }
+
+        inline void merge(long long &acc, long long partial) const {
+            atomicAdd(acc, partial);
+        }
+    };
+
+    struct Min {
+        static constexpr long long identity = LLONG_MAX;
+
+        inline void operator()(long long &acc, long long value) const {
+            atomicMin(acc, value);
+        }
+
+        inline void fold_local(long long &acc, long long value) const {
+            atomicMinLocal(acc, value);
+        }
+
+        inline void merge(long long &acc, long long partial) const {
+            atomicMin(acc, partial);
+        }
+    };
+
+    struct Max {
+        static constexpr long long identity = LLONG_MIN;
+
+        inline void operator()(long long &acc, long long value) const {
+            atomicMax(acc, value);
+        }
+
+        inline void fold_local(long long &acc, long long value) const {
+            atomicMaxLocal(acc, value);
+        }
+
+        inline void merge(long long &acc, long long partial) const {
+            atomicMax(acc, partial);
+        }
+    };
+
+    /**
+     * @brief Packs two grouping values into a single group key
+     */
+    inline uint64_t group_key(int a, int b)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+    }
+
+    /**
+     * @brief Key marking an empty slot of an aggregate table, all
+     *        bits set, i.e. what memset(keys, 0xff, ...) writes
+     */
+    template <typename K>
+    constexpr K group_empty_key()
+    {
+        return static_cast<K>(~static_cast<K>(0));
+    }
+
+    /**
+     * @brief Multiplicative hashing of all the bits of a
+     *        (possibly 64 bit) group key into [0, ht_len)
+     */
+    template <typename K>
+    inline int group_hash(K key, int ht_len)
+    {
+        uint64_t h = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+        return static_cast<int>(((h >> 32) * static_cast<uint64_t>(ht_len)) >> 32);
+    }
+
+    /**
+     * Open addressing aggregate table (linear probing):
+     * keys[ht_len] holds the group keys and aggs[ht_len] their
+     * accumulators. Before the first group_by, keys must be
+     * filled with group_empty_key (memset to 0xff) and aggs with
+     * the identity of the aggregate. Several aggregates over the
+     * same groups can share keys, each with its own aggs.
+     * ht_len must exceed the number of groups: size it from the
+     * group cardinality with get_linear_ht_len. Should the table
+     * still fill up, the rows (or local groups) of the groups it
+     * cannot take are counted in *overflow, which the host zeroes
+     * with the table and checks once the aggregation is done (see
+     * check_group_by_overflow): the table is then incomplete.
+     * find_or_insert_group returns -1 when the table is full, and
+     * can also target a work-group local table by passing
+     * local_space as address space.
+     */
+    template <typename K, sycl::access::address_space
+              addressSpace = sycl::access::address_space::global_space>
+    inline int find_or_insert_group(K key, K *keys, int ht_len)
+    {
+        constexpr K empty = group_empty_key<K>();
+        int slot = group_hash(key, ht_len);
+
+        for (int n = 0; n < ht_len; n++) {
+            K slot_key = keys[slot];
+            if (slot_key == key) {
+                return slot;
+            }
+            if (slot_key == empty) {
+                K old = atomicCAS<K, addressSpace>(&keys[slot], empty, key);
+                if (old == empty || old == key) {
+                    return slot;
+                }
+            }
+            slot = (slot + 1 == ht_len) ? 0 : slot + 1;
+        }
+
+        return -1;
+    }
+
+    template <typename K, typename V, typename AggOp, int block_threads, int items_per_thread>
+    inline void group_by_direct(
+            int tid,
+            K (&items)[items_per_thread],
+            V (&values)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            AggOp agg_op,
+            K *keys,
+            long long *aggs,
+            int ht_len,
+            int *overflow
+    )
+    {
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (selection_flags[i]) {
+                int slot = find_or_insert_group(items[i], keys, ht_len);
+                if (slot >= 0) {
+                    agg_op(aggs[slot], static_cast<long long>(values[i]));
+                } else {
+                    atomicAdd(*overflow, 1);
+                }
+            }
+        }
+    }
+
+    template <typename K, typename V, typename AggOp, int block_threads, int items_per_thread>
+    inline void group_by_direct(
+            int tid,
+            K (&items)[items_per_thread],
+            V (&values)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            AggOp agg_op,
+            K *keys,
+            long long *aggs,
+            int ht_len,
+            int *overflow,
+            int num_items
+    )
+    {
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_items && selection_flags[i]) {
+                int slot = find_or_insert_group(items[i], keys, ht_len);
+                if (slot >= 0) {
+                    agg_op(aggs[slot], static_cast<long long>(values[i]));
+                } else {
+                    atomicAdd(*overflow, 1);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Aggregates with agg_op the values of the selected
+     *        items into the accumulator of their group key
+     * @param items     group key of every item
+     * @param values    value aggregated for every item
+     * @param keys      keys of the aggregate table
+     * @param aggs      accumulators of the aggregate table
+     * @param overflow  count of the rows the full table could not take
+     */
+    template <typename K, typename V, typename AggOp, int block_threads, int items_per_thread>
+    inline void group_by(
+            K (&items)[items_per_thread],
+            V (&values)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            AggOp agg_op,
+            K *keys,
+            long long *aggs,
+            int ht_len,
+            int *overflow,
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        if ((block_threads * items_per_thread) == num_items) {
+            group_by_direct<K, V, AggOp, block_threads, items_per_thread>(
+                    item_ct1.get_local_id(0), items, values, selection_flags, agg_op, keys, aggs, ht_len,
+                    overflow);
+        } else {
+            group_by_direct<K, V, AggOp, block_threads, items_per_thread>(
+                    item_ct1.get_local_id(0), items, values, selection_flags, agg_op, keys, aggs, ht_len,
+                    overflow, num_items);
+        }
+    }
+
+    /**
+     * @brief Empties a work-group local aggregate table. Every thread
+     *        of the work-group must call it, and a barrier is needed
+     *        before the table is used
+     */
+    template <typename K, typename AggOp, int block_threads>
+    inline void group_by_local_init(
+            K *local_keys,
+            long long *local_aggs,
+            int local_len,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        constexpr K empty = group_empty_key<K>();
+
+        for (int slot = item_ct1.get_local_id(0); slot < local_len; slot += block_threads) {
+            local_keys[slot] = empty;
+            local_aggs[slot] = AggOp::identity;
+        }
+    }
+
+    /**
+     * @brief Aggregates a tile into the local table; rows whose group
+     *        does not fit in it go straight to the global one. Can be
+     *        called for many tiles before group_by_local_flush
+     */
+    template <typename K, typename V, typename AggOp, int block_threads, int items_per_thread>
+    inline void group_by_local_fold(
+            K (&items)[items_per_thread],
+            V (&values)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            AggOp agg_op,
+            K *local_keys,
+            long long *local_aggs,
+            int local_len,
+            K *keys,
+            long long *aggs,
+            int ht_len,
+            int *overflow,
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        int tid = item_ct1.get_local_id(0);
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_items && selection_flags[i]) {
+                long long value = static_cast<long long>(values[i]);
+                int slot = find_or_insert_group<K, sycl::access::address_space::local_space>(
+                        items[i], local_keys, local_len);
+                if (slot >= 0) {
+                    agg_op.fold_local(local_aggs[slot], value);
+                } else {
+                    slot = find_or_insert_group(items[i], keys, ht_len);
+                    if (slot >= 0) {
+                        agg_op(aggs[slot], value);
+                    } else {
+                        atomicAdd(*overflow, 1);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Merges the local table into the global one. Every thread
+     *        of the work-group must call it, after a barrier
+     */
+    template <typename K, typename AggOp, int block_threads>
+    inline void group_by_local_flush(
+            AggOp agg_op,
+            K *local_keys,
+            long long *local_aggs,
+            int local_len,
+            K *keys,
+            long long *aggs,
+            int ht_len,
+            int *overflow,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        constexpr K empty = group_empty_key<K>();
+
+        for (int slot = item_ct1.get_local_id(0); slot < local_len; slot += block_threads) {
+            K key = local_keys[slot];
+            if (key != empty) {
+                int global_slot = find_or_insert_group(key, keys, ht_len);
+                if (global_slot >= 0) {
+                    agg_op.merge(aggs[global_slot], local_aggs[slot]);
+                } else {
+                    atomicAdd(*overflow, 1);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Same as group_by, but the tile is first aggregated in
+     *        a work-group local table (e.g. a sycl::local_accessor of
+     *        local_len keys and one of local_len accumulators), which
+     *        is then merged into the global table once per tile.
+     *        With few groups this turns one global atomic per row
+     *        into one per group and tile. Rows whose group does not
+     *        fit in the local table go straight to the global one.
+     *        Persistent kernels rather call group_by_local_init once,
+     *        group_by_local_fold per tile and group_by_local_flush
+     *        once, merging once per group and work-group.
+     *        Every thread of the work-group must call it
+     * @param local_keys    keys of the local table
+     * @param local_aggs    accumulators of the local table
+     * @param local_len     slots of the local table, get_linear_ht_len
+     *                      of the tile size never overflows it
+     */
+    template <typename K, typename V, typename AggOp, int block_threads, int items_per_thread>
+    inline void group_by_local(
+            K (&items)[items_per_thread],
+            V (&values)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            AggOp agg_op,
+            K *local_keys,
+            long long *local_aggs,
+            int local_len,
+            K *keys,
+            long long *aggs,
+            int ht_len,
+            int *overflow,
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        group_by_local_init<K, AggOp, block_threads>(local_keys, local_aggs, local_len, item_ct1);
+        item_ct1.barrier(sycl::access::fence_space::local_space);
+
+        group_by_local_fold<K, V, AggOp, block_threads, items_per_thread>(items, values, selection_flags,
+                agg_op, local_keys, local_aggs, local_len, keys, aggs, ht_len, overflow, num_items, item_ct1);
+        item_ct1.barrier(sycl::access::fence_space::local_space);
+
+        group_by_local_flush<K, AggOp, block_threads>(agg_op, local_keys, local_aggs, local_len,
+                keys, aggs, ht_len, overflow, item_ct1);
+    }
+
+    /**
+     * @brief Empties an aggregate table for agg_op, and zeroes its
+     *        overflow count, on the device without waiting, once deps
+     *        are done
+     * @return std::vector<sycl::event>  events the kernels filling
+     *         the table must depend on
+     */
+    template <typename K, typename AggOp>
+    inline std::vector<sycl::event> init_group_by_async(
+            sycl::queue &q,
+            K *keys,
+            long long *aggs,
+            int ht_len,
+            int *overflow,
+            AggOp agg_op,
+            const std::vector<sycl::event> &deps = {}
+    )
+    {
+        sycl::event keys_event = q.submit([&](sycl::handler &h) {
+            h.depends_on(deps);
+            h.memset(keys, 0xff, ht_len * sizeof(K));
+        });
+        sycl::event aggs_event = q.submit([&](sycl::handler &h) {
+            h.depends_on(deps);
+            h.fill(aggs, AggOp::identity, ht_len);
+        });
+        sycl::event overflow_event = q.submit([&](sycl::handler &h) {
+            h.depends_on(deps);
+            h.memset(overflow, 0, sizeof(int));
+        });
+        return {keys_event, aggs_event, overflow_event};
+    }
+
+    /**
+     * @brief Empties an aggregate table for agg_op on the device
+     */
+    template <typename K, typename AggOp>
+    inline void init_group_by(
+            sycl::queue &q,
+            K *keys,
+            long long *aggs,
+            int ht_len,
+            int *overflow,
+            AggOp agg_op
+    )
+    {
+        for (sycl::event &e : init_group_by_async(q, keys, aggs, ht_len, overflow, agg_op)) {
+            e.wait();
+        }
+    }
+
+    /**
+     * @brief Reads the overflow count of an aggregate table once the
+     *        kernels filling it are done, and reports an incomplete
+     *        table on cerr
+     * @return bool  true if no row was left out of the table
+     */
+    inline bool check_group_by_overflow(sycl::queue &q, const int *overflow, int ht_len)
+    {
+        int h_overflow = 0;
+        q.memcpy(&h_overflow, overflow, sizeof(int)).wait();
+
+        if (h_overflow != 0) {
+            std::cerr << "[Error] aggregate table of " << ht_len << " slots is full, "
+                      << h_overflow << " rows or partial groups left out" << std::endl;
+        }
+        return h_overflow == 0;
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_GROUP_BY_HPP
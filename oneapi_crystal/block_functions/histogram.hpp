@@ -0,0 +1,95 @@
+#ifndef ONEAPI_CRYSTAL_HISTOGRAM_HPP
+#define ONEAPI_CRYSTAL_HISTOGRAM_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include "oneapi_crystal/utils/atomic.hpp"
+
+namespace crystal {
+
+    /**
+     * @brief Bin functor for block_histogram: the bits
+     *        [shift, shift + bits) of the key, as in radix
+     *        partitioning
+     */
+    template <typename T>
+    struct RadixBin {
+        int shift;
+        int bits;
+
+        inline RadixBin(int shift, int bits) : shift(shift), bits(bits) {}
+
+        inline int operator()(const T &a) const {
+            return (static_cast<unsigned int>(a) >> shift) & ((1u << bits) - 1);
+        }
+    };
+
+    /**
+     * @brief Bin functor for block_histogram: equal-width bins
+     *        of width values starting from lo
+     */
+    template <typename T>
+    struct RangeBin {
+        T lo;
+        T width;
+
+        inline RangeBin(T lo, T width) : lo(lo), width(width) {}
+
+        inline int operator()(const T &a) const {
+            // the division truncates toward zero: values just below lo
+            // would otherwise land in bin 0
+            if (a < lo) return -1;
+            return static_cast<int>((a - lo) / width);
+        }
+    };
+
+    /**
+     * @brief Counts the selected items of a tile per bin in a
+     *        work-group local histogram, then adds it to the
+     *        global one with one atomic per non-empty bin.
+     *        Items whose bin falls outside [0, num_bins) are
+     *        ignored. Every thread of the work-group must call it
+     * @param bin_op        maps an item to its bin
+     * @param local_hist    local memory of num_bins counters
+     * @param hist          global histogram of num_bins counters
+     */
+    template <typename T, typename BinOp, int block_threads, int items_per_thread>
+    inline void block_histogram(
+            T (&items)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            BinOp bin_op,
+            int *local_hist,
+            int *hist,
+            int num_bins,
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        int tid = item_ct1.get_local_id(0);
+
+        for (int b = tid; b < num_bins; b += block_threads) {
+            local_hist[b] = 0;
+        }
+        item_ct1.barrier(sycl::access::fence_space::local_space);
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_items && selection_flags[i]) {
+                int bin = bin_op(items[i]);
+                if (bin >= 0 && bin < num_bins) {
+                    atomicAddLocal(local_hist[bin], 1);
+                }
+            }
+        }
+        item_ct1.barrier(sycl::access::fence_space::local_space);
+
+        for (int b = tid; b < num_bins; b += block_threads) {
+            if (local_hist[b] != 0) {
+                atomicAdd(hist[b], local_hist[b]);
+            }
+        }
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_HISTOGRAM_HPP
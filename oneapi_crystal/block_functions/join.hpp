@@ -3,6 +3,9 @@
 #pragma once 
 
 #include <CL/sycl.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include "oneapi_crystal/utils/atomic.hpp"
 
 #define HASH(X,Y,Z) ((X-Z) % Y)
@@ -343,6 +346,682 @@ namespace crystal {
           build_selective_2<K, V, work_groups, group_size>(
                 keys, res, selection_flags, ht, ht_len, 0, num_items, item_ct1);
         }        
+
+
+        /**
+         * @brief Multiplicative (Fibonacci) hash of a key into [0, ht_len).
+         *        The 32 bit product is reduced with a multiply-shift
+         *        rather than a modulo, so ht_len can be any size.
+         */
+        template <typename K>
+        inline int hash_mult(K key, int ht_len)
+        {
+                uint32_t h = static_cast<uint32_t>(key) * 0x9E3779B1u;
+                return static_cast<int>((static_cast<uint64_t>(h) * ht_len) >> 32);
+        }
+
+        /**
+         * @brief Number of slots an open addressing table needs to hold
+         *        num_keys keys without exceeding the given load factor.
+         *        Memory scales with the number of build rows, not with
+         *        the key range as for the direct mapped tables above.
+         */
+        inline int get_linear_ht_len(int num_keys, float load_factor = 0.5f)
+        {
+                return std::max(1, static_cast<int>(std::ceil(num_keys / load_factor)));
+        }
+
+        /**
+         * Open addressing hash tables (linear probing).
+         * Key 0 marks an empty slot, hence keys must be non-zero and
+         * the table must be zeroed before the build, as for the direct
+         * mapped tables. The _2 variants keep the [key, value] layout
+         * of build_selective_2, i.e. ht holds 2 * ht_len entries.
+         * The insert helpers can also target a work-group local table
+         * by passing local_space as address space.
+         */
+        template <typename K, sycl::access::address_space
+                  addressSpace = sycl::access::address_space::global_space>
+        inline void insert_linear_1(K key, K *ht, int ht_len)
+        {
+                int slot = hash_mult(key, ht_len);
+
+                for (int n = 0; n < ht_len; n++) {
+                        K old = atomicCAS<K, addressSpace>(&ht[slot], K(0), key);
+                        if (old == 0 || old == key) {
+                                return;
+                        }
+                        slot = (slot + 1 == ht_len) ? 0 : slot + 1;
+                }
+        }
+
+        template <typename K, typename V, sycl::access::address_space
+                  addressSpace = sycl::access::address_space::global_space>
+        inline void insert_linear_2(K key, V val, K *ht, int ht_len)
+        {
+                int slot = hash_mult(key, ht_len);
+
+                for (int n = 0; n < ht_len; n++) {
+                        K old = atomicCAS<K, addressSpace>(&ht[slot << 1], K(0), key);
+                        if (old == 0 || old == key) {
+                                ht[(slot << 1) + 1] = val;
+                                return;
+                        }
+                        slot = (slot + 1 == ht_len) ? 0 : slot + 1;
+                }
+        }
+
+        template <typename K>
+        inline bool lookup_linear_1(K key, K *ht, int ht_len)
+        {
+                int slot = hash_mult(key, ht_len);
+
+                for (int n = 0; n < ht_len; n++) {
+                        K slot_key = ht[slot];
+                        if (slot_key == key) {
+                                return true;
+                        }
+                        if (slot_key == 0) {
+                                return false;
+                        }
+                        slot = (slot + 1 == ht_len) ? 0 : slot + 1;
+                }
+                return false;
+        }
+
+        template <typename K, typename V>
+        inline bool lookup_linear_2(K key, V &val, K *ht, int ht_len)
+        {
+                int slot = hash_mult(key, ht_len);
+
+                for (int n = 0; n < ht_len; n++) {
+                        // key and value are fetched with a single access
+                        uint64_t entry = *reinterpret_cast<uint64_t*>(&ht[slot << 1]);
+                        K slot_key = static_cast<K>(entry & 0xFFFFFFFF);
+                        if (slot_key == key) {
+                                val = (entry >> 32);
+                                return true;
+                        }
+                        if (slot_key == 0) {
+                                return false;
+                        }
+                        slot = (slot + 1 == ht_len) ? 0 : slot + 1;
+                }
+                return false;
+        }
+
+        template <typename K, int work_groups, int group_size>
+        inline void probe_direct_linear_1 (
+                int tid,
+                K (&items)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int ht_len
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+            if (selection_flags[i]) {
+                selection_flags[i] = lookup_linear_1(items[i], ht, ht_len);
+            }
+          }
+        }
+
+        template <typename K, int work_groups, int group_size>
+        inline void probe_direct_linear_1 (
+                int tid,
+                K (&items)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int ht_len,
+                int num_items
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+            if (tid + (i * work_groups) < num_items) {
+                if (selection_flags[i]) {
+                  selection_flags[i] = lookup_linear_1(items[i], ht, ht_len);
+                }
+            }
+          }
+        }
+
+        template <typename K, int work_groups, int group_size>
+        inline void probe_linear_1 (
+                K (&items)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int ht_len,
+                int num_items,
+                sycl::nd_item<1> item_ct1
+        )
+        {
+                if ((work_groups * group_size) == num_items) {
+                        probe_direct_linear_1<K, work_groups, group_size>(
+                                item_ct1.get_local_id(0), items, selection_flags, ht, ht_len);
+                } else {
+                        probe_direct_linear_1<K, work_groups, group_size>(
+                                item_ct1.get_local_id(0), items, selection_flags, ht, ht_len,
+                                num_items);
+                }
+        }
+
+        template <typename K, typename V, int work_groups, int group_size>
+        inline void probe_direct_linear_2 (
+                int tid,
+                K (&keys)[group_size],
+                V (&res)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int ht_len
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+            if (selection_flags[i]) {
+                selection_flags[i] = lookup_linear_2(keys[i], res[i], ht, ht_len);
+            }
+          }
+        }
+
+        template <typename K, typename V, int work_groups, int group_size>
+        inline void probe_direct_linear_2 (
+                int tid,
+                K (&keys)[group_size],
+                V (&res)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int ht_len,
+                int num_items
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+            if (tid + (i * work_groups) < num_items) {
+                if (selection_flags[i]) {
+                  selection_flags[i] = lookup_linear_2(keys[i], res[i], ht, ht_len);
+                }
+            }
+          }
+        }
+
+        template <typename K, typename V, int work_groups, int group_size>
+        inline void probe_linear_2 (
+                K (&keys)[group_size],
+                V (&res)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int ht_len,
+                int num_items,
+                sycl::nd_item<1> item_ct1
+        )
+        {
+                if ((work_groups * group_size) == num_items) {
+                        probe_direct_linear_2<K, V, work_groups, group_size>(
+                                item_ct1.get_local_id(0), keys, res, selection_flags, ht, ht_len);
+                } else {
+                        probe_direct_linear_2<K, V, work_groups, group_size>(
+                                item_ct1.get_local_id(0), keys, res, selection_flags, ht, ht_len,
+                                num_items);
+                }
+        }
+
+        template <typename K, int work_groups, int group_size>
+        inline void build_direct_selective_linear_1 (
+                int tid,
+                K (&keys)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int ht_len
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+                if (selection_flags[i]) {
+                  insert_linear_1(keys[i], ht, ht_len);
+                }
+          }
+        }
+
+        template <typename K, int work_groups, int group_size>
+        inline void build_direct_selective_linear_1 (
+                int tid,
+                K (&keys)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int ht_len,
+                int num_items
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+             if (tid + (i * work_groups) < num_items) {
+                if (selection_flags[i]) {
+                   insert_linear_1(keys[i], ht, ht_len);
+                }
+             }
+          }
+        }
+
+        template <typename K, int work_groups, int group_size>
+        inline void build_selective_linear_1 (
+                K (&keys)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int ht_len,
+                int num_items,
+                sycl::nd_item<1> item_ct1
+        )
+        {
+          if ((work_groups * group_size) == num_items) {
+                build_direct_selective_linear_1<K, work_groups, group_size>(
+                        item_ct1.get_local_id(0), keys, selection_flags, ht, ht_len);
+          } else {
+                build_direct_selective_linear_1<K, work_groups, group_size>(
+                        item_ct1.get_local_id(0), keys, selection_flags, ht, ht_len,
+                        num_items);
+          }
+        }
+
+        template <typename K, typename V, int work_groups, int group_size>
+        inline void build_direct_selective_linear_2 (
+                int tid,
+                K (&keys)[group_size],
+                V (&res)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int ht_len
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+                if (selection_flags[i]) {
+                  insert_linear_2(keys[i], res[i], ht, ht_len);
+                }
+          }
+        }
+
+        template <typename K, typename V, int work_groups, int group_size>
+        inline void build_direct_selective_linear_2 (
+                int tid,
+                K (&keys)[group_size],
+                V (&res)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int ht_len,
+                int num_items
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+             if (tid + (i * work_groups) < num_items) {
+                if (selection_flags[i]) {
+                   insert_linear_2(keys[i], res[i], ht, ht_len);
+                }
+             }
+          }
+        }
+
+        template <typename K, typename V, int work_groups, int group_size>
+        inline void build_selective_linear_2 (
+                K (&keys)[group_size],
+                V (&res)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int ht_len,
+                int num_items,
+                sycl::nd_item<1> item_ct1
+        )
+        {
+          if ((work_groups * group_size) == num_items) {
+                build_direct_selective_linear_2<K, V, work_groups, group_size>(
+                        item_ct1.get_local_id(0), keys, res, selection_flags, ht, ht_len);
+          } else {
+                build_direct_selective_linear_2<K, V, work_groups, group_size>(
+                        item_ct1.get_local_id(0), keys, res, selection_flags, ht, ht_len,
+                        num_items);
+          }
+        }
+
+        /**
+         * Bucketized hash tables.
+         * Each bucket packs bucket_size keys followed by their bucket_size
+         * payloads, so for 4 byte keys and payloads a bucket is exactly one
+         * 64 byte cache line and a probe touches a single line even when
+         * keys collide. Buckets are addressed with hash_mult and overflow
+         * into the next bucket. The line holds only if ht is 64 byte
+         * aligned (usm_pool blocks are; malloc_device gives no such
+         * guarantee). As for the other tables key 0 marks an empty slot
+         * and ht must be zeroed before the build; ht holds
+         * 2 * bucket_size * num_buckets entries.
+         */
+        constexpr int bucket_size = 8;
+
+        /**
+         * @brief Number of buckets needed to hold num_keys keys
+         *        without exceeding the given load factor
+         */
+        inline int get_bucketed_ht_len(int num_keys, float load_factor = 0.75f)
+        {
+                return std::max(1, static_cast<int>(
+                        std::ceil(num_keys / (load_factor * bucket_size))));
+        }
+
+        template <typename K, typename V>
+        inline void insert_bucketed(K key, V val, K *ht, int num_buckets)
+        {
+                int bucket = hash_mult(key, num_buckets);
+
+                for (int n = 0; n < num_buckets; n++) {
+                        K *bucket_itr = ht + bucket * (bucket_size << 1);
+
+                        for (int s = 0; s < bucket_size; s++) {
+                                K old = atomicCAS(&bucket_itr[s], K(0), key);
+                                if (old == 0 || old == key) {
+                                        bucket_itr[bucket_size + s] = val;
+                                        return;
+                                }
+                        }
+                        bucket = (bucket + 1 == num_buckets) ? 0 : bucket + 1;
+                }
+        }
+
+        template <typename K, typename V>
+        inline bool lookup_bucketed(K key, V &val, K *ht, int num_buckets)
+        {
+                int bucket = hash_mult(key, num_buckets);
+
+                for (int n = 0; n < num_buckets; n++) {
+                        K *bucket_itr = ht + bucket * (bucket_size << 1);
+
+                        #pragma unroll
+                        for (int s = 0; s < bucket_size; s++) {
+                                K slot_key = bucket_itr[s];
+                                if (slot_key == key) {
+                                        val = bucket_itr[bucket_size + s];
+                                        return true;
+                                }
+                                if (slot_key == 0) {
+                                        return false;
+                                }
+                        }
+                        bucket = (bucket + 1 == num_buckets) ? 0 : bucket + 1;
+                }
+                return false;
+        }
+
+        template <typename K, typename V, int work_groups, int group_size>
+        inline void probe_direct_bucketed (
+                int tid,
+                K (&keys)[group_size],
+                V (&res)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int num_buckets
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+            if (selection_flags[i]) {
+                selection_flags[i] = lookup_bucketed(keys[i], res[i], ht, num_buckets);
+            }
+          }
+        }
+
+        template <typename K, typename V, int work_groups, int group_size>
+        inline void probe_direct_bucketed (
+                int tid,
+                K (&keys)[group_size],
+                V (&res)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int num_buckets,
+                int num_items
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+            if (tid + (i * work_groups) < num_items) {
+                if (selection_flags[i]) {
+                  selection_flags[i] = lookup_bucketed(keys[i], res[i], ht, num_buckets);
+                }
+            }
+          }
+        }
+
+        template <typename K, typename V, int work_groups, int group_size>
+        inline void probe_bucketed (
+                K (&keys)[group_size],
+                V (&res)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int num_buckets,
+                int num_items,
+                sycl::nd_item<1> item_ct1
+        )
+        {
+                if ((work_groups * group_size) == num_items) {
+                        probe_direct_bucketed<K, V, work_groups, group_size>(
+                                item_ct1.get_local_id(0), keys, res, selection_flags, ht,
+                                num_buckets);
+                } else {
+                        probe_direct_bucketed<K, V, work_groups, group_size>(
+                                item_ct1.get_local_id(0), keys, res, selection_flags, ht,
+                                num_buckets, num_items);
+                }
+        }
+
+        template <typename K, typename V, int work_groups, int group_size>
+        inline void build_direct_bucketed (
+                int tid,
+                K (&keys)[group_size],
+                V (&res)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int num_buckets
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+                if (selection_flags[i]) {
+                  insert_bucketed(keys[i], res[i], ht, num_buckets);
+                }
+          }
+        }
+
+        template <typename K, typename V, int work_groups, int group_size>
+        inline void build_direct_bucketed (
+                int tid,
+                K (&keys)[group_size],
+                V (&res)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int num_buckets,
+                int num_items
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+             if (tid + (i * work_groups) < num_items) {
+                if (selection_flags[i]) {
+                   insert_bucketed(keys[i], res[i], ht, num_buckets);
+                }
+             }
+          }
+        }
+
+        template <typename K, typename V, int work_groups, int group_size>
+        inline void build_bucketed (
+                K (&keys)[group_size],
+                V (&res)[group_size],
+                int (&selection_flags)[group_size],
+                K *ht,
+                int num_buckets,
+                int num_items,
+                sycl::nd_item<1> item_ct1
+        )
+        {
+          if ((work_groups * group_size) == num_items) {
+                build_direct_bucketed<K, V, work_groups, group_size>(
+                        item_ct1.get_local_id(0), keys, res, selection_flags, ht, num_buckets);
+          } else {
+                build_direct_bucketed<K, V, work_groups, group_size>(
+                        item_ct1.get_local_id(0), keys, res, selection_flags, ht, num_buckets,
+                        num_items);
+          }
+        }
+
+        /**
+         * Register blocked Bloom filters.
+         * A key sets bloom_num_bits bits of a single 32 bit word, thus a
+         * probe costs one load and the whole filter (bloom_bits_per_key
+         * bits per build key) is small enough to stay in L1/L2. Probe
+         * kernels can discard most of the non-matching rows with it
+         * before touching the hash table. The filter must be zeroed
+         * before the build.
+         */
+        constexpr int bloom_bits_per_key = 8;
+        constexpr int bloom_num_bits = 3;
+
+        /**
+         * @brief Number of 32 bit words of a Bloom filter for num_keys keys
+         */
+        inline int get_bloom_len(int num_keys, int bits_per_key = bloom_bits_per_key)
+        {
+                return std::max(1, (num_keys * bits_per_key + 31) / 32);
+        }
+
+        template <typename K>
+        inline uint32_t bloom_mask(K key)
+        {
+                // a second multiplicative hash picks the bits in the word
+                uint32_t h = static_cast<uint32_t>(key) * 0x2545F491u;
+                uint32_t mask = 0;
+
+                #pragma unroll
+                for (int b = 0; b < bloom_num_bits; b++) {
+                        mask |= 1u << ((h >> (27 - 5 * b)) & 31);
+                }
+                return mask;
+        }
+
+        template <typename K, int work_groups, int group_size>
+        inline void build_direct_bloom (
+                int tid,
+                K (&keys)[group_size],
+                int (&selection_flags)[group_size],
+                uint32_t *filter,
+                int filter_len
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+                if (selection_flags[i]) {
+                  atomicOr(filter[hash_mult(keys[i], filter_len)], bloom_mask(keys[i]));
+                }
+          }
+        }
+
+        template <typename K, int work_groups, int group_size>
+        inline void build_direct_bloom (
+                int tid,
+                K (&keys)[group_size],
+                int (&selection_flags)[group_size],
+                uint32_t *filter,
+                int filter_len,
+                int num_items
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+             if (tid + (i * work_groups) < num_items) {
+                if (selection_flags[i]) {
+                   atomicOr(filter[hash_mult(keys[i], filter_len)], bloom_mask(keys[i]));
+                }
+             }
+          }
+        }
+
+        template <typename K, int work_groups, int group_size>
+        inline void build_bloom (
+                K (&keys)[group_size],
+                int (&selection_flags)[group_size],
+                uint32_t *filter,
+                int filter_len,
+                int num_items,
+                sycl::nd_item<1> item_ct1
+        )
+        {
+          if ((work_groups * group_size) == num_items) {
+                build_direct_bloom<K, work_groups, group_size>(
+                        item_ct1.get_local_id(0), keys, selection_flags, filter, filter_len);
+          } else {
+                build_direct_bloom<K, work_groups, group_size>(
+                        item_ct1.get_local_id(0), keys, selection_flags, filter, filter_len,
+                        num_items);
+          }
+        }
+
+        template <typename K, int work_groups, int group_size>
+        inline void probe_direct_bloom (
+                int tid,
+                K (&items)[group_size],
+                int (&selection_flags)[group_size],
+                uint32_t *filter,
+                int filter_len
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+            if (selection_flags[i]) {
+                uint32_t mask = bloom_mask(items[i]);
+                selection_flags[i] = (filter[hash_mult(items[i], filter_len)] & mask) == mask;
+            }
+          }
+        }
+
+        template <typename K, int work_groups, int group_size>
+        inline void probe_direct_bloom (
+                int tid,
+                K (&items)[group_size],
+                int (&selection_flags)[group_size],
+                uint32_t *filter,
+                int filter_len,
+                int num_items
+        )
+        {
+          #pragma unroll
+          for (int i = 0; i < group_size; i++) {
+            if (tid + (i * work_groups) < num_items) {
+                if (selection_flags[i]) {
+                  uint32_t mask = bloom_mask(items[i]);
+                  selection_flags[i] = (filter[hash_mult(items[i], filter_len)] & mask) == mask;
+                }
+            }
+          }
+        }
+
+        template <typename K, int work_groups, int group_size>
+        inline void probe_bloom (
+                K (&items)[group_size],
+                int (&selection_flags)[group_size],
+                uint32_t *filter,
+                int filter_len,
+                int num_items,
+                sycl::nd_item<1> item_ct1
+        )
+        {
+                if ((work_groups * group_size) == num_items) {
+                        probe_direct_bloom<K, work_groups, group_size>(
+                                item_ct1.get_local_id(0), items, selection_flags, filter,
+                                filter_len);
+                } else {
+                        probe_direct_bloom<K, work_groups, group_size>(
+                                item_ct1.get_local_id(0), items, selection_flags, filter,
+                                filter_len, num_items);
+                }
+        }
 } // namespace crystal 
 
 #endif //ONEAPI_CRYSTAL_JOIN_DPP_HPP
\ No newline at end of file
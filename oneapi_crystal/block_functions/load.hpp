@@ -6,6 +6,28 @@
 
 namespace crystal {
 
+    /**
+     * How a tile moves between global memory and the work-items.
+     * direct issues one strided access per item and leaves the
+     * vectorization to the compiler, leaving item i of thread tid at
+     * row tid + i * block_threads. subgroup has each sub-group read
+     * (write) its own block of sg_size * items_per_thread consecutive
+     * rows with a single sub-group block access of vector type, so
+     * lane l of sub-group s holds the rows
+     * s * sg_size * items_per_thread + i * sg_size + l (striped within
+     * the sub-group). Partial tiles fall back on direct. Within a
+     * kernel, all the loads and stores of a tile must use the same
+     * io; block functions working item by item (predicates, sums,
+     * probes) then work unchanged, but row ids derived from
+     * tid + i * block_threads (compaction, sorting) require direct
+     */
+    enum class BlockIo { direct, subgroup };
+
+    // sub-group block accesses of vector type exist for 1, 2, 4 and 8 items
+    template <int items_per_thread>
+    constexpr bool is_block_io_vector = items_per_thread == 1 || items_per_thread == 2 ||
+                                        items_per_thread == 4 || items_per_thread == 8;
+
     template <typename T, int block_threads, int items_per_thread>
     inline void load_direct (
             const unsigned int tid,
@@ -40,6 +62,58 @@ namespace crystal {
     }
 
     template <typename T, int block_threads, int items_per_thread>
+    inline void load_subgroup_direct (
+            sycl::sub_group sg,
+            T *block_itr,
+            T (&items)[items_per_thread]
+    )
+    {
+        int sg_size = sg.get_local_range()[0];
+        T* sg_itr = block_itr + sg.get_group_id()[0] * sg_size * items_per_thread;
+        sycl::multi_ptr<T, sycl::access::address_space::global_space> ptr(sg_itr);
+
+        if constexpr (is_block_io_vector<items_per_thread>) {
+            sycl::vec<T, items_per_thread> v = sg.load<items_per_thread>(ptr);
+
+            #pragma unroll
+            for (int i = 0; i < items_per_thread; i++) {
+                items[i] = v[i];
+            }
+        } else {
+            #pragma unroll
+            for (int i = 0; i < items_per_thread; i++) {
+                items[i] = sg.load<T>(sycl::multi_ptr<T, sycl::access::address_space::global_space>(
+                        sg_itr + i * sg_size));
+            }
+        }
+    }
+
+    /**
+     * @brief Same as load, with sub-group block reads (see BlockIo).
+     *        inp must point to global memory and block_threads must
+     *        be a multiple of the sub-group size. Every work-item of
+     *        a sub-group must call it
+     */
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load_subgroup(
+            T *inp,
+            T (&items)[items_per_thread],
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        T* block_itr = inp;
+
+        if ((block_threads * items_per_thread) == num_items) {
+            load_subgroup_direct<T, block_threads, items_per_thread>(
+                    item_ct1.get_sub_group(), block_itr, items);
+        } else {
+            load_direct<T, block_threads, items_per_thread>(
+                    item_ct1.get_local_id(0), block_itr, items, num_items);
+        }
+    }
+
+    template <typename T, int block_threads, int items_per_thread, BlockIo io = BlockIo::direct>
     inline void load(
             T *inp,
             T (&items)[items_per_thread],
@@ -49,7 +123,9 @@ namespace crystal {
     {
         T* block_itr = inp;
 
-        if ((block_threads * items_per_thread) == num_items) {
+        if constexpr (io == BlockIo::subgroup) {
+            load_subgroup<T, block_threads, items_per_thread>(block_itr, items, num_items, item_ct1);
+        } else if ((block_threads * items_per_thread) == num_items) {
             load_direct<T, block_threads, items_per_thread>(
                     item_ct1.get_local_id(0), block_itr, items);
         } else {
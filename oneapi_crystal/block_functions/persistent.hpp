@@ -0,0 +1,79 @@
+#ifndef ONEAPI_CRYSTAL_PERSISTENT_HPP
+#define ONEAPI_CRYSTAL_PERSISTENT_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <algorithm>
+#include "oneapi_crystal/utils/atomic.hpp"
+
+namespace crystal {
+
+    /**
+     * Persistent kernels: rather than one work-group per tile, a
+     * fixed number of work-groups (get_persistent_groups) loops over
+     * the tiles, so the per work-group setup (clearing a local table,
+     * the final reduction and atomics) is paid once for many tiles.
+     * The loop of for_each_tile also runs kernels launched with one
+     * work-group per tile, which then do a single iteration: the same
+     * kernel serves both launch modes.
+     */
+
+    /**
+     * @brief Number of work-groups of a persistent launch over
+     *        num_tiles tiles: groups_per_unit per compute unit,
+     *        never more than the tiles
+     */
+    inline int get_persistent_groups(const sycl::queue &q, int num_tiles, int groups_per_unit = 4)
+    {
+        int units = q.get_device().get_info<sycl::info::device::max_compute_units>();
+        return std::max(1, std::min(num_tiles, std::max(1, units) * groups_per_unit));
+    }
+
+    /**
+     * @brief Next tile of the work-group: the leader takes it from
+     *        the shared counter, which hands out the tiles past the
+     *        first get_group_range(0) ones
+     */
+    inline int claim_tile(int *tile_counter, sycl::nd_item<1> item_ct1)
+    {
+        int tile = 0;
+        if (item_ct1.get_local_id(0) == 0) {
+            tile = static_cast<int>(item_ct1.get_group_range(0)) + atomicAdd(*tile_counter, 1);
+        }
+        return sycl::group_broadcast(item_ct1.get_group(), tile, 0);
+    }
+
+    /**
+     * @brief Calls tile_op(tile) for the tiles of the work-group.
+     *        Without a counter the tiles are strided by the number of
+     *        work-groups (grid-stride loop); with one (zeroed before
+     *        the launch) each work-group starts on its own tile and
+     *        then claims the next free one, which balances tiles of
+     *        uneven cost (e.g. skipped through zone maps).
+     *        Every thread of the work-group must call it
+     * @param tile_counter  counter in global memory, or nullptr
+     */
+    template <typename TileOp>
+    inline void for_each_tile(
+            int num_tiles,
+            int *tile_counter,
+            sycl::nd_item<1> item_ct1,
+            TileOp tile_op
+    )
+    {
+        int tile = static_cast<int>(item_ct1.get_group(0));
+
+        while (tile < num_tiles) {
+            tile_op(tile);
+
+            if (tile_counter != nullptr) {
+                tile = claim_tile(tile_counter, item_ct1);
+            } else {
+                tile += static_cast<int>(item_ct1.get_group_range(0));
+            }
+        }
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_PERSISTENT_HPP
@@ -0,0 +1,186 @@
+#ifndef ONEAPI_CRYSTAL_RADIX_SORT_HPP
+#define ONEAPI_CRYSTAL_RADIX_SORT_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <type_traits>
+#include "scan.hpp"
+
+namespace crystal {
+
+    // bits of the digit each pass of block_radix_sort sorts on
+    constexpr int radix_sort_digit_bits = 4;
+    constexpr int radix_sort_bins = 1 << radix_sort_digit_bits;
+
+    /**
+     * @brief Entries of the local_counts of block_radix_sort
+     */
+    constexpr int get_radix_sort_counts_len(int block_threads)
+    {
+        return radix_sort_bins * block_threads;
+    }
+
+    template <typename K, typename V, bool has_values, int block_threads, int items_per_thread>
+    inline void block_radix_sort_direct(
+            K (&keys)[items_per_thread],
+            V (&vals)[items_per_thread],
+            K *local_keys,
+            V *local_vals,
+            int *local_counts,
+            int num_items,
+            int begin_bit,
+            int end_bit,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        using U = typename std::make_unsigned<K>::type;
+        // flipping the sign bit of signed keys puts the negative ones first
+        constexpr U sign_flip = std::is_signed<K>::value ? static_cast<U>(U(1) << (sizeof(K) * 8 - 1)) : U(0);
+        int tid = item_ct1.get_local_id(0);
+
+        if (begin_bit >= end_bit) {
+            return;
+        }
+
+        // the passes work on the blocked arrangement: thread tid holds
+        // the consecutive positions tid * items_per_thread + i
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            local_keys[tid + (i * block_threads)] = keys[i];
+            if (has_values) local_vals[tid + (i * block_threads)] = vals[i];
+        }
+        item_ct1.barrier(sycl::access::fence_space::local_space);
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            keys[i] = local_keys[(tid * items_per_thread) + i];
+            if (has_values) vals[i] = local_vals[(tid * items_per_thread) + i];
+        }
+
+        // one stable counting sort per digit, least significant first
+        for (int bit = begin_bit; bit < end_bit; bit += radix_sort_digit_bits) {
+            int bits = sycl::min(radix_sort_digit_bits, end_bit - bit);
+            int max_digit = (1 << bits) - 1;
+            int digits[items_per_thread];
+
+            #pragma unroll
+            for (int i = 0; i < items_per_thread; i++) {
+                // items past num_items take the last digit: being last in
+                // the tile too, they stay behind every valid item
+                digits[i] = (tid * items_per_thread) + i < num_items
+                    ? static_cast<int>(((static_cast<U>(keys[i]) ^ sign_flip) >> bit) & max_digit)
+                    : max_digit;
+            }
+
+            // local histogram, digit-major: counter d * block_threads + tid
+            // counts the items of thread tid with digit d
+            #pragma unroll
+            for (int d = 0; d < radix_sort_bins; d++) {
+                local_counts[(d * block_threads) + tid] = 0;
+            }
+
+            #pragma unroll
+            for (int i = 0; i < items_per_thread; i++) {
+                local_counts[(digits[i] * block_threads) + tid]++;
+            }
+            item_ct1.barrier(sycl::access::fence_space::local_space);
+
+            // exclusive scan of the histogram: every thread scans a run of
+            // radix_sort_bins counters, then the runs are offset by a single
+            // scan across the work-group
+            int counts[radix_sort_bins];
+            int run_total = 0;
+
+            #pragma unroll
+            for (int c = 0; c < radix_sort_bins; c++) {
+                counts[c] = local_counts[(tid * radix_sort_bins) + c];
+                run_total += counts[c];
+            }
+
+            int total;
+            int offset = group_exclusive_sum(run_total, total, item_ct1);
+
+            #pragma unroll
+            for (int c = 0; c < radix_sort_bins; c++) {
+                local_counts[(tid * radix_sort_bins) + c] = offset;
+                offset += counts[c];
+            }
+            item_ct1.barrier(sycl::access::fence_space::local_space);
+
+            // counter (d, tid) is now the rank of the first item of thread
+            // tid with digit d, and only thread tid touches it
+            #pragma unroll
+            for (int i = 0; i < items_per_thread; i++) {
+                int rank = local_counts[(digits[i] * block_threads) + tid]++;
+                local_keys[rank] = keys[i];
+                if (has_values) local_vals[rank] = vals[i];
+            }
+            item_ct1.barrier(sycl::access::fence_space::local_space);
+
+            // back to the striped arrangement after the last pass
+            bool last = bit + radix_sort_digit_bits >= end_bit;
+
+            #pragma unroll
+            for (int i = 0; i < items_per_thread; i++) {
+                int position = last ? tid + (i * block_threads) : (tid * items_per_thread) + i;
+                keys[i] = local_keys[position];
+                if (has_values) vals[i] = local_vals[position];
+            }
+            item_ct1.barrier(sycl::access::fence_space::local_space);
+        }
+    }
+
+    /**
+     * @brief Sorts a tile of keys in ascending order, leaving it in
+     *        the striped arrangement of load (position
+     *        tid + i * block_threads holds the i-th key of thread tid).
+     *        LSD radix sort of [begin_bit, end_bit) in digits of
+     *        radix_sort_digit_bits bits: per digit, a local histogram
+     *        of the digits of every thread, one scan of it across the
+     *        work-group and a stable scatter through local memory.
+     *        Items past num_items end up last.
+     *        Every thread of the work-group must call it
+     * @param local_keys    local memory of block_threads * items_per_thread keys
+     * @param local_counts  local memory of get_radix_sort_counts_len(block_threads)
+     *                      counters
+     */
+    template <typename K, int block_threads, int items_per_thread>
+    inline void block_radix_sort(
+            K (&keys)[items_per_thread],
+            K *local_keys,
+            int *local_counts,
+            int num_items,
+            sycl::nd_item<1> item_ct1,
+            int begin_bit = 0,
+            int end_bit = sizeof(K) * 8
+    )
+    {
+        K *no_vals = nullptr;
+        block_radix_sort_direct<K, K, false, block_threads, items_per_thread>(
+                keys, keys, local_keys, no_vals, local_counts, num_items, begin_bit, end_bit, item_ct1);
+    }
+
+    /**
+     * @brief Same as above, moving vals along with their keys
+     * @param local_vals    local memory of block_threads * items_per_thread values
+     */
+    template <typename K, typename V, int block_threads, int items_per_thread>
+    inline void block_radix_sort(
+            K (&keys)[items_per_thread],
+            V (&vals)[items_per_thread],
+            K *local_keys,
+            V *local_vals,
+            int *local_counts,
+            int num_items,
+            sycl::nd_item<1> item_ct1,
+            int begin_bit = 0,
+            int end_bit = sizeof(K) * 8
+    )
+    {
+        block_radix_sort_direct<K, V, true, block_threads, items_per_thread>(
+                keys, vals, local_keys, local_vals, local_counts, num_items, begin_bit, end_bit, item_ct1);
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_RADIX_SORT_HPP
@@ -0,0 +1,125 @@
+#ifndef ONEAPI_CRYSTAL_REDUCE_HPP
+#define ONEAPI_CRYSTAL_REDUCE_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+
+namespace crystal {
+
+    /**
+     * @brief Reduces one value per work-item across the work-group:
+     *        sub-group reductions (shuffles), then the sub-group
+     *        results are combined through local memory.
+     *        Every work-item gets the result
+     * @param scratch   local memory, one entry per sub-group
+     *                  (block_threads entries always suffice)
+     */
+    template <typename T, typename ReduceOp>
+    inline T group_reduce(
+            T value,
+            ReduceOp reduce_op,
+            T *scratch,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        sycl::sub_group sg = item_ct1.get_sub_group();
+        int num_sg = sg.get_group_range()[0];
+
+        T sg_aggregate = sycl::reduce_over_group(sg, value, reduce_op);
+
+        if (sg.get_local_id()[0] == 0) {
+            scratch[sg.get_group_id()[0]] = sg_aggregate;
+        }
+        item_ct1.barrier(sycl::access::fence_space::local_space);
+
+        T aggregate = scratch[0];
+        for (int s = 1; s < num_sg; s++) {
+            aggregate = reduce_op(aggregate, scratch[s]);
+        }
+        item_ct1.barrier(sycl::access::fence_space::local_space);
+
+        return aggregate;
+    }
+
+    template <typename T, typename ReduceOp, int block_threads, int items_per_thread>
+    inline T thread_reduce(
+            int tid,
+            T (&items)[items_per_thread],
+            ReduceOp reduce_op,
+            T identity,
+            int num_items
+    )
+    {
+        T aggregate = identity;
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_items) {
+                aggregate = reduce_op(aggregate, items[i]);
+            }
+        }
+
+        return aggregate;
+    }
+
+    /**
+     * @brief Reduces the first num_items items of a tile with
+     *        reduce_op (e.g. sycl::plus, sycl::minimum, sycl::maximum),
+     *        first within each thread and then across the work-group.
+     *        Every thread of the work-group must call it and gets
+     *        the result
+     * @param identity  identity of reduce_op
+     * @param scratch   local memory for group_reduce, or nullptr to
+     *                  use the work-group collectives
+     */
+    template <typename T, typename ReduceOp, int block_threads, int items_per_thread>
+    inline T block_reduce(
+            T (&items)[items_per_thread],
+            ReduceOp reduce_op,
+            T identity,
+            T *scratch,
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        T aggregate = thread_reduce<T, ReduceOp, block_threads, items_per_thread>(
+                item_ct1.get_local_id(0), items, reduce_op, identity, num_items);
+
+        if (scratch != nullptr) {
+            return group_reduce(aggregate, reduce_op, scratch, item_ct1);
+        }
+        return sycl::reduce_over_group(item_ct1.get_group(), aggregate, reduce_op);
+    }
+
+    /**
+     * @brief Sum of the first num_items items of a tile, restricted
+     *        to the selected ones
+     */
+    template <typename T, int block_threads, int items_per_thread>
+    inline T block_sum(
+            T (&items)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            T *scratch,
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        int tid = item_ct1.get_local_id(0);
+        T sum = 0;
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_items && selection_flags[i]) {
+                sum += items[i];
+            }
+        }
+
+        if (scratch != nullptr) {
+            return group_reduce(sum, sycl::plus<T>(), scratch, item_ct1);
+        }
+        return sycl::reduce_over_group(item_ct1.get_group(), sum, sycl::plus<T>());
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_REDUCE_HPP
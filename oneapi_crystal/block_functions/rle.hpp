@@ -0,0 +1,248 @@
+#ifndef ONEAPI_CRYSTAL_RLE_HPP
+#define ONEAPI_CRYSTAL_RLE_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include "load.hpp"
+#include "predicate.hpp"
+#include "scan.hpp"
+
+namespace crystal {
+
+    /**
+     * @brief Finds the run holding the i-th value of a
+     *        run-length encoded column among the runs [lo, hi],
+     *        i.e. the last run whose starting position is not
+     *        after i
+     * @param pos       starting position of every run
+     */
+    inline int rle_find_run(
+            const int *pos,
+            int lo,
+            int hi,
+            int i
+    )
+    {
+        while (lo < hi) {
+            int mid = (lo + hi + 1) >> 1;
+            if (pos[mid] <= i) {
+                lo = mid;
+            } else {
+                hi = mid - 1;
+            }
+        }
+
+        return lo;
+    }
+
+    /**
+     * @brief Same as above among all the num_runs runs
+     */
+    inline int rle_find_run(
+            const int *pos,
+            int num_runs,
+            int i
+    )
+    {
+        return rle_find_run(pos, 0, num_runs - 1, i);
+    }
+
+    /**
+     * @brief Whether a tile of num_items rows spread over tile_runs
+     *        runs decodes slower than it loads: at about one run per
+     *        row (e.g. an unsorted column) there is nothing to save
+     */
+    inline bool rle_dense_tile(
+            int tile_runs,
+            int num_items
+    )
+    {
+        return 2 * tile_runs > num_items;
+    }
+
+    // every item binary searches its run among the runs of the tile,
+    // so the cost grows with log(runs of the tile), not with the runs
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load_rle_direct (
+            const unsigned int tid,
+            const T *values,
+            const int *pos,
+            int num_runs,
+            int tile_offset,
+            T (&items)[items_per_thread]
+    )
+    {
+        int first_run = rle_find_run(pos, num_runs, tile_offset);
+        int last_run = rle_find_run(pos, first_run, num_runs - 1,
+                tile_offset + block_threads * items_per_thread - 1);
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            items[i] = values[rle_find_run(pos, first_run, last_run, tile_offset + tid + i * block_threads)];
+        }
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load_rle_direct (
+            const unsigned int tid,
+            const T *values,
+            const int *pos,
+            int num_runs,
+            int tile_offset,
+            T (&items)[items_per_thread],
+            int num_items
+    )
+    {
+        if (tid >= num_items) return;
+
+        int first_run = rle_find_run(pos, num_runs, tile_offset);
+        int last_run = rle_find_run(pos, first_run, num_runs - 1, tile_offset + num_items - 1);
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_items) {
+                items[i] = values[rle_find_run(pos, first_run, last_run, tile_offset + tid + i * block_threads)];
+            }
+        }
+    }
+
+    /**
+     * @brief Expands the runs of a run-length encoded column
+     *        covering the tile starting at tile_offset into the
+     *        same blocked arrangement used by load
+     * @param values    value of every run
+     * @param pos       starting position of every run
+     */
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load_rle(
+            const T *values,
+            const int *pos,
+            int num_runs,
+            int tile_offset,
+            T (&items)[items_per_thread],
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        if ((block_threads * items_per_thread) == num_items) {
+            load_rle_direct<T, block_threads, items_per_thread>(
+                    item_ct1.get_local_id(0), values, pos, num_runs, tile_offset, items);
+        } else {
+            load_rle_direct<T, block_threads, items_per_thread>(
+                    item_ct1.get_local_id(0), values, pos, num_runs, tile_offset, items, num_items);
+        }
+    }
+
+    /**
+     * @brief Evaluates select_op once per run overlapping the tile
+     *        starting at tile_offset, rather than once per value.
+     *        The runs of the tile are split across the work-group and
+     *        the per-thread counts of selected runs are summed with a
+     *        block-wide scan. When every run agrees the flags are set
+     *        without looking at single values; otherwise each value
+     *        binary searches its run among the runs of the tile.
+     *        Tiles with about one run per row read the uncompressed
+     *        column plain instead, when given.
+     *        All the threads of the work-group compute the same
+     *        result, so the kernel can return early on it
+     * @param plain     the column uncompressed, or nullptr
+     * @return int      whether any value of the tile was selected
+     */
+    template <
+        typename T,
+        typename SelectOp,
+        int block_threads,
+        int items_per_thread
+        >
+    inline int predicate_rle(
+            const T *values,
+            const int *pos,
+            int num_runs,
+            T *plain,
+            int tile_offset,
+            SelectOp select_op,
+            int (&selection_flags)[items_per_thread],
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        int tid = item_ct1.get_local_id(0);
+        int first_run = rle_find_run(pos, num_runs, tile_offset);
+        int last_run = rle_find_run(pos, first_run, num_runs - 1, tile_offset + num_items - 1);
+        int tile_runs = last_run - first_run + 1;
+
+        if (plain != nullptr && rle_dense_tile(tile_runs, num_items)) {
+            T items[items_per_thread];
+            load<T, block_threads, items_per_thread>(plain + tile_offset, items, num_items, item_ct1);
+            predicate<T, SelectOp, block_threads, items_per_thread>(items, select_op,
+                    selection_flags, num_items, item_ct1);
+
+            int any_selected = 0;
+            #pragma unroll
+            for (int i = 0; i < items_per_thread; i++) {
+                if (tid + (i * block_threads) < num_items && selection_flags[i]) {
+                    any_selected = 1;
+                }
+            }
+
+            return sycl::reduce_over_group(item_ct1.get_group(), any_selected, sycl::plus<>()) > 0;
+        }
+
+        int run_counts[1] = {0};
+        int run_prefix[1];
+        for (int run = first_run + tid; run <= last_run; run += block_threads) {
+            run_counts[0] += select_op(values[run]) ? 1 : 0;
+        }
+
+        int num_selected = block_exclusive_sum<int, block_threads, 1>(run_counts, run_prefix,
+                nullptr, block_threads, item_ct1);
+        int all_selected = (num_selected == tile_runs);
+
+        if (num_selected == 0 || all_selected) {
+            #pragma unroll
+            for (int i = 0; i < items_per_thread; i++) {
+                selection_flags[i] = all_selected;
+            }
+
+            return all_selected;
+        }
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) < num_items) {
+                int run = rle_find_run(pos, first_run, last_run, tile_offset + tid + i * block_threads);
+                selection_flags[i] = select_op(values[run]);
+            }
+        }
+
+        return 1;
+    }
+
+    /**
+     * @brief Same as above without an uncompressed column to fall
+     *        back on
+     */
+    template <
+        typename T,
+        typename SelectOp,
+        int block_threads,
+        int items_per_thread
+        >
+    inline int predicate_rle(
+            const T *values,
+            const int *pos,
+            int num_runs,
+            int tile_offset,
+            SelectOp select_op,
+            int (&selection_flags)[items_per_thread],
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        return predicate_rle<T, SelectOp, block_threads, items_per_thread>(values, pos, num_runs,
+                static_cast<T *>(nullptr), tile_offset, select_op, selection_flags, num_items, item_ct1);
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_RLE_HPP
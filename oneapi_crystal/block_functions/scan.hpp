@@ -0,0 +1,142 @@
+#ifndef ONEAPI_CRYSTAL_SCAN_HPP
+#define ONEAPI_CRYSTAL_SCAN_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+
+namespace crystal {
+
+    /**
+     * @brief Exclusive prefix sum of one value per work-item across
+     *        the work-group: sub-group scans (shuffles), then the
+     *        sub-group totals are combined through local memory
+     * @param total     sum of the values of the whole work-group
+     * @param scratch   local memory, one entry per sub-group
+     *                  (block_threads entries always suffice)
+     */
+    template <typename T>
+    inline T group_exclusive_sum(
+            T value,
+            T &total,
+            T *scratch,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        sycl::sub_group sg = item_ct1.get_sub_group();
+        int sg_id = sg.get_group_id()[0];
+        int num_sg = sg.get_group_range()[0];
+
+        T sg_prefix = sycl::exclusive_scan_over_group(sg, value, sycl::plus<T>());
+
+        if (sg.get_local_id()[0] == sg.get_local_range()[0] - 1) {
+            scratch[sg_id] = sg_prefix + value;
+        }
+        item_ct1.barrier(sycl::access::fence_space::local_space);
+
+        T sg_offset = 0;
+        total = 0;
+        for (int s = 0; s < num_sg; s++) {
+            T sg_total = scratch[s];
+            sg_offset += (s < sg_id) ? sg_total : T(0);
+            total += sg_total;
+        }
+        // scratch is free again once everyone has read it
+        item_ct1.barrier(sycl::access::fence_space::local_space);
+
+        return sg_offset + sg_prefix;
+    }
+
+    /**
+     * @brief Same as above, relying on the work-group collective
+     *        of the SYCL implementation instead of local memory
+     */
+    template <typename T>
+    inline T group_exclusive_sum(
+            T value,
+            T &total,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        total = sycl::reduce_over_group(item_ct1.get_group(), value, sycl::plus<T>());
+        return sycl::exclusive_scan_over_group(item_ct1.get_group(), value, sycl::plus<T>());
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline T block_exclusive_sum_direct(
+            T (&items)[items_per_thread],
+            T (&prefix)[items_per_thread],
+            T *scratch,
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        int tid = item_ct1.get_local_id(0);
+        T running = 0;
+
+        // one row of block_threads consecutive items at a time
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            T value = (tid + (i * block_threads) < num_items) ? items[i] : T(0);
+            T row_total;
+            T row_prefix = (scratch != nullptr)
+                ? group_exclusive_sum(value, row_total, scratch, item_ct1)
+                : group_exclusive_sum(value, row_total, item_ct1);
+
+            prefix[i] = running + row_prefix;
+            running += row_total;
+        }
+
+        return running;
+    }
+
+    /**
+     * @brief Exclusive prefix sum of a tile in tile order, i.e. in
+     *        the striped arrangement of load: prefix[i] of thread tid
+     *        sums the items before position tid + i * block_threads.
+     *        Items past num_items count as 0.
+     *        Every thread of the work-group must call it
+     * @param scratch   local memory for group_exclusive_sum, or
+     *                  nullptr to use the work-group collectives
+     * @return T        sum of the whole tile
+     */
+    template <typename T, int block_threads, int items_per_thread>
+    inline T block_exclusive_sum(
+            T (&items)[items_per_thread],
+            T (&prefix)[items_per_thread],
+            T *scratch,
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        return block_exclusive_sum_direct<T, block_threads, items_per_thread>(
+                items, prefix, scratch, num_items, item_ct1);
+    }
+
+    /**
+     * @brief Inclusive counterpart of block_exclusive_sum
+     */
+    template <typename T, int block_threads, int items_per_thread>
+    inline T block_inclusive_sum(
+            T (&items)[items_per_thread],
+            T (&prefix)[items_per_thread],
+            T *scratch,
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        T total = block_exclusive_sum_direct<T, block_threads, items_per_thread>(
+                items, prefix, scratch, num_items, item_ct1);
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (item_ct1.get_local_id(0) + (i * block_threads) < num_items) {
+                prefix[i] += items[i];
+            }
+        }
+
+        return total;
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_SCAN_HPP
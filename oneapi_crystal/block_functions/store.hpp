@@ -3,6 +3,7 @@
 #pragma once
 
 #include <CL/sycl.hpp>
+#include "load.hpp"
 
 namespace crystal {
   
@@ -43,6 +44,59 @@ namespace crystal {
 
 
     template <typename T, int block_threads, int items_per_thread>
+    inline void store_subgroup_direct (
+            sycl::sub_group sg,
+            T *block_itr,
+            T (&items)[items_per_thread]
+    )
+    {
+        int sg_size = sg.get_local_range()[0];
+        T* sg_itr = block_itr + sg.get_group_id()[0] * sg_size * items_per_thread;
+        sycl::multi_ptr<T, sycl::access::address_space::global_space> ptr(sg_itr);
+
+        if constexpr (is_block_io_vector<items_per_thread>) {
+            sycl::vec<T, items_per_thread> v;
+
+            #pragma unroll
+            for (int i = 0; i < items_per_thread; i++) {
+                v[i] = items[i];
+            }
+            sg.store<items_per_thread>(ptr, v);
+        } else {
+            #pragma unroll
+            for (int i = 0; i < items_per_thread; i++) {
+                sg.store(sycl::multi_ptr<T, sycl::access::address_space::global_space>(
+                        sg_itr + i * sg_size), items[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief Same as store, with sub-group block writes (see BlockIo).
+     *        out must point to global memory and block_threads must
+     *        be a multiple of the sub-group size. Every work-item of
+     *        a sub-group must call it
+     */
+    template <typename T, int block_threads, int items_per_thread>
+    inline void store_subgroup (
+            T *out,
+            T (&items)[items_per_thread],
+            int num_items,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        T* block_itr = out;
+
+        if ((block_threads * items_per_thread) == num_items) {
+            store_subgroup_direct<T, block_threads, items_per_thread>(
+                    item_ct1.get_sub_group(), block_itr, items);
+        } else {
+            store_direct<T, block_threads, items_per_thread>(
+                    item_ct1.get_local_id(0), block_itr, items, num_items);
+        }
+    }
+
+    template <typename T, int block_threads, int items_per_thread, BlockIo io = BlockIo::direct>
     inline void store (
             T *out,
             T (&items)[items_per_thread],
@@ -52,7 +106,9 @@ namespace crystal {
     {
         T* block_itr = out;
 
-        if ((block_threads * items_per_thread) == num_items) {
+        if constexpr (io == BlockIo::subgroup) {
+            store_subgroup<T, block_threads, items_per_thread>(block_itr, items, num_items, item_ct1);
+        } else if ((block_threads * items_per_thread) == num_items) {
             store_direct<T, block_threads, items_per_thread>(
                     item_ct1.get_local_id(0), block_itr, items);
         } else {
@@ -0,0 +1,45 @@
+#ifndef ONEAPI_CRYSTAL_ZONE_MAP_HPP
+#define ONEAPI_CRYSTAL_ZONE_MAP_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+
+namespace crystal {
+
+    /**
+     * @brief Checks whether the tile starting at tile_offset may hold
+     *        values in [lo, hi], according to the minimum and maximum
+     *        of the zones it covers.
+     *        It only reads the zone map, and all the threads of the
+     *        work-group get the same answer: when it is false the
+     *        kernel can return before loading any column
+     * @param zone_min   minimum of every zone
+     * @param zone_max   maximum of every zone
+     * @param zone_size  number of values in each zone
+     */
+    template <typename T>
+    inline bool zone_map_may_match(
+            const T *zone_min,
+            const T *zone_max,
+            int zone_size,
+            int tile_offset,
+            int num_items,
+            T lo,
+            T hi
+    )
+    {
+        int first_zone = tile_offset / zone_size;
+        int last_zone = (tile_offset + num_items - 1) / zone_size;
+
+        for (int zone = first_zone; zone <= last_zone; zone++) {
+            if (zone_min[zone] <= hi && zone_max[zone] >= lo) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_ZONE_MAP_HPP
@@ -0,0 +1,433 @@
+#ifndef ONEAPI_CRYSTAL_CPU_BLOCK_FUNCTIONS_HPP
+#define ONEAPI_CRYSTAL_CPU_BLOCK_FUNCTIONS_HPP
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "../block_functions/join.hpp"
+#include "../block_functions/predicate.hpp"
+#include "simd.hpp"
+
+namespace crystal {
+namespace cpu {
+
+    /**
+     * Native CPU backend of the block functions. A host thread runs a
+     * whole tile, so kernels are instantiated with block_threads = 1 and
+     * items_per_thread = tile size, and the tile is contiguous in the
+     * thread's arrays. tile_item stands in for sycl::nd_item<1>: the
+     * functions below have the same names and template parameters as the
+     * device ones and are picked by argument dependent lookup, so a kernel
+     * body written against the device API runs unchanged on a tile_item
+     * as long as it sticks to block functions (no sycl group algorithms).
+     * Predicates and probes on int columns use explicit SIMD (see
+     * simd.hpp), everything else falls back to the device code paths.
+     */
+    struct tile_item {
+        int group;
+        int num_groups;
+
+        inline int get_group(int) const { return group; }
+        inline int get_group_range(int) const { return num_groups; }
+        inline int get_local_id(int) const { return 0; }
+        inline int get_local_range(int) const { return 1; }
+    };
+
+    /**
+     * @brief Runs kernel(tile_item) for every tile of
+     *        block_threads * items_per_thread items, on num_threads
+     *        host threads (all the hardware threads by default) that
+     *        claim tiles in small batches
+     */
+    template <int block_threads, int items_per_thread, typename Kernel>
+    inline void for_each_tile(int num_items, Kernel kernel, int num_threads = 0)
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+
+        constexpr int tile_size = block_threads * items_per_thread;
+        constexpr int batch = 16;
+        int num_tiles = (num_items + tile_size - 1) / tile_size;
+
+        if (num_threads <= 0) {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        num_threads = std::min(num_threads, std::max(1, (num_tiles + batch - 1) / batch));
+
+        std::atomic<int> next_tile(0);
+        auto worker = [&]() {
+            for (int first = next_tile.fetch_add(batch); first < num_tiles; first = next_tile.fetch_add(batch)) {
+                int last = std::min(first + batch, num_tiles);
+                for (int tile = first; tile < last; tile++) {
+                    kernel(tile_item{tile, num_tiles});
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int t = 1; t < num_threads; t++) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load(
+            T *inp,
+            T (&items)[items_per_thread],
+            int num_items,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+        std::memcpy(items, inp, num_items * sizeof(T));
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void store(
+            T *out,
+            T (&items)[items_per_thread],
+            int num_items,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+        std::memcpy(out, items, num_items * sizeof(T));
+    }
+
+    template <typename T, typename SelectOp, int block_threads, int items_per_thread>
+    inline void predicate(
+            T (&items)[items_per_thread],
+            SelectOp select_op,
+            int (&selection_flags)[items_per_thread],
+            int num_items,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+        crystal::predicate_direct<T, SelectOp, block_threads, items_per_thread>(
+                0, items, select_op, selection_flags, num_items);
+    }
+
+    template <typename T, typename SelectOp, int block_threads, int items_per_thread>
+    inline void predicate_and(
+            T (&items)[items_per_thread],
+            SelectOp select_op,
+            int (&selection_flags)[items_per_thread],
+            int num_items,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+        crystal::predicate_and_direct<T, SelectOp, block_threads, items_per_thread>(
+                0, items, select_op, selection_flags, num_items);
+    }
+
+    template <typename T, typename SelectOp, int block_threads, int items_per_thread>
+    inline void predicate_or(
+            T (&items)[items_per_thread],
+            SelectOp select_op,
+            int (&selection_flags)[items_per_thread],
+            int num_items,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+        crystal::predicate_or_direct<T, SelectOp, block_threads, items_per_thread>(
+                0, items, select_op, selection_flags, num_items);
+    }
+
+    // SIMD comparison on int tiles, the functor otherwise
+    template <simd::Cmp cmp, simd::Combine combine, typename SelectOp,
+              typename T, int block_threads, int items_per_thread>
+    inline void predicate_cmp(
+            T (&items)[items_per_thread],
+            T compare,
+            int (&selection_flags)[items_per_thread],
+            int num_items,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+
+        if constexpr (std::is_same<T, int>::value) {
+            simd::compare<cmp, combine>(items, compare, selection_flags, num_items);
+        } else if constexpr (combine == simd::Combine::set) {
+            predicate<T, SelectOp, block_threads, items_per_thread>(
+                    items, SelectOp(compare), selection_flags, num_items, item);
+        } else if constexpr (combine == simd::Combine::and_) {
+            predicate_and<T, SelectOp, block_threads, items_per_thread>(
+                    items, SelectOp(compare), selection_flags, num_items, item);
+        } else {
+            predicate_or<T, SelectOp, block_threads, items_per_thread>(
+                    items, SelectOp(compare), selection_flags, num_items, item);
+        }
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void predicate_lt(T (&items)[items_per_thread], T compare,
+            int (&selection_flags)[items_per_thread], int num_items, tile_item item) {
+        predicate_cmp<simd::Cmp::lt, simd::Combine::set, LessThan<T>, T, block_threads, items_per_thread>(
+                items, compare, selection_flags, num_items, item);
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void predicate_and_lt(T (&items)[items_per_thread], T compare,
+            int (&selection_flags)[items_per_thread], int num_items, tile_item item) {
+        predicate_cmp<simd::Cmp::lt, simd::Combine::and_, LessThan<T>, T, block_threads, items_per_thread>(
+                items, compare, selection_flags, num_items, item);
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void predicate_gt(T (&items)[items_per_thread], T compare,
+            int (&selection_flags)[items_per_thread], int num_items, tile_item item) {
+        predicate_cmp<simd::Cmp::gt, simd::Combine::set, GreaterThan<T>, T, block_threads, items_per_thread>(
+                items, compare, selection_flags, num_items, item);
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void predicate_and_gt(T (&items)[items_per_thread], T compare,
+            int (&selection_flags)[items_per_thread], int num_items, tile_item item) {
+        predicate_cmp<simd::Cmp::gt, simd::Combine::and_, GreaterThan<T>, T, block_threads, items_per_thread>(
+                items, compare, selection_flags, num_items, item);
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void predicate_lte(T (&items)[items_per_thread], T compare,
+            int (&selection_flags)[items_per_thread], int num_items, tile_item item) {
+        predicate_cmp<simd::Cmp::lte, simd::Combine::set, LessThanEq<T>, T, block_threads, items_per_thread>(
+                items, compare, selection_flags, num_items, item);
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void predicate_and_lte(T (&items)[items_per_thread], T compare,
+            int (&selection_flags)[items_per_thread], int num_items, tile_item item) {
+        predicate_cmp<simd::Cmp::lte, simd::Combine::and_, LessThanEq<T>, T, block_threads, items_per_thread>(
+                items, compare, selection_flags, num_items, item);
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void predicate_gte(T (&items)[items_per_thread], T compare,
+            int (&selection_flags)[items_per_thread], int num_items, tile_item item) {
+        predicate_cmp<simd::Cmp::gte, simd::Combine::set, GreaterThanEq<T>, T, block_threads, items_per_thread>(
+                items, compare, selection_flags, num_items, item);
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void predicate_and_gte(T (&items)[items_per_thread], T compare,
+            int (&selection_flags)[items_per_thread], int num_items, tile_item item) {
+        predicate_cmp<simd::Cmp::gte, simd::Combine::and_, GreaterThanEq<T>, T, block_threads, items_per_thread>(
+                items, compare, selection_flags, num_items, item);
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void predicate_eq(T (&items)[items_per_thread], T compare,
+            int (&selection_flags)[items_per_thread], int num_items, tile_item item) {
+        predicate_cmp<simd::Cmp::eq, simd::Combine::set, Eq<T>, T, block_threads, items_per_thread>(
+                items, compare, selection_flags, num_items, item);
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void predicate_and_eq(T (&items)[items_per_thread], T compare,
+            int (&selection_flags)[items_per_thread], int num_items, tile_item item) {
+        predicate_cmp<simd::Cmp::eq, simd::Combine::and_, Eq<T>, T, block_threads, items_per_thread>(
+                items, compare, selection_flags, num_items, item);
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void predicate_or_eq(T (&items)[items_per_thread], T compare,
+            int (&selection_flags)[items_per_thread], int num_items, tile_item item) {
+        predicate_cmp<simd::Cmp::eq, simd::Combine::or_, Eq<T>, T, block_threads, items_per_thread>(
+                items, compare, selection_flags, num_items, item);
+    }
+
+    /**
+     * @brief Same as crystal::probe_linear_1, with gathers on int keys
+     */
+    template <typename K, int block_threads, int items_per_thread>
+    inline void probe_linear_1(
+            K (&items)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            K *ht,
+            int ht_len,
+            int num_items,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+
+        if constexpr (std::is_same<K, int>::value) {
+            simd::probe_linear(items, selection_flags, nullptr, ht, ht_len, num_items);
+        } else {
+            crystal::probe_direct_linear_1<K, block_threads, items_per_thread>(
+                    0, items, selection_flags, ht, ht_len, num_items);
+        }
+    }
+
+    /**
+     * @brief Same as crystal::probe_linear_2, with gathers on int keys
+     *        and values
+     */
+    template <typename K, typename V, int block_threads, int items_per_thread>
+    inline void probe_linear_2(
+            K (&keys)[items_per_thread],
+            V (&res)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            K *ht,
+            int ht_len,
+            int num_items,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+
+        if constexpr (std::is_same<K, int>::value && std::is_same<V, int>::value) {
+            simd::probe_linear(keys, selection_flags, res, ht, ht_len, num_items);
+        } else {
+            crystal::probe_direct_linear_2<K, V, block_threads, items_per_thread>(
+                    0, keys, res, selection_flags, ht, ht_len, num_items);
+        }
+    }
+
+    /**
+     * @brief Same as crystal::build_selective_linear_1; the inserts
+     *        are atomic, so tiles can be built by concurrent threads
+     */
+    template <typename K, int block_threads, int items_per_thread>
+    inline void build_selective_linear_1(
+            K (&keys)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            K *ht,
+            int ht_len,
+            int num_items,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+        crystal::build_direct_selective_linear_1<K, block_threads, items_per_thread>(
+                0, keys, selection_flags, ht, ht_len, num_items);
+    }
+
+    template <typename K, typename V, int block_threads, int items_per_thread>
+    inline void build_selective_linear_2(
+            K (&keys)[items_per_thread],
+            V (&res)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            K *ht,
+            int ht_len,
+            int num_items,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+        crystal::build_direct_selective_linear_2<K, V, block_threads, items_per_thread>(
+                0, keys, res, selection_flags, ht, ht_len, num_items);
+    }
+
+    /**
+     * @brief Same as crystal::block_compact: compress of the
+     *        positions of the selected items into selection
+     * @return int      number of selected items
+     */
+    template <int block_threads, int items_per_thread>
+    inline int block_compact(
+            int (&selection_flags)[items_per_thread],
+            int *selection,
+            int num_items,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+
+        int num_selected = simd::compress(selection_flags, 0, selection, num_items);
+        std::fill(selection_flags, selection_flags + items_per_thread, 1);
+        return num_selected;
+    }
+
+    /**
+     * @brief Same as the value form of crystal::block_compact. The
+     *        selection is increasing, so the values move down in
+     *        place and local_values is not needed
+     */
+    template <typename T, int block_threads, int items_per_thread>
+    inline int block_compact(
+            T (&values)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            int *selection,
+            T *local_values,
+            int num_items,
+            tile_item item
+    )
+    {
+        int num_selected = block_compact<block_threads, items_per_thread>(
+                selection_flags, selection, num_items, item);
+
+        for (int i = 0; i < num_selected; i++) {
+            values[i] = values[selection[i]];
+        }
+        return num_selected;
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline void load_selected(
+            const T *block_itr,
+            const int *selection,
+            T (&items)[items_per_thread],
+            int num_selected,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+
+        for (int i = 0; i < num_selected; i++) {
+            items[i] = block_itr[selection[i]];
+        }
+    }
+
+    template <typename T, int block_threads, int items_per_thread>
+    inline T block_sum(
+            T (&items)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            T *scratch,
+            int num_items,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+
+        T sum = 0;
+        for (int i = 0; i < num_items; i++) {
+            if (selection_flags[i]) sum += items[i];
+        }
+        return sum;
+    }
+
+    /**
+     * @brief Sum of a[i] * b[i] over the selected items, in 64 bits:
+     *        the aggregate of most SSB queries. CPU only, on device
+     *        it is a loop followed by a group reduction
+     */
+    template <int block_threads, int items_per_thread>
+    inline long long block_sum_product(
+            int (&a)[items_per_thread],
+            int (&b)[items_per_thread],
+            int (&selection_flags)[items_per_thread],
+            int num_items,
+            tile_item item
+    )
+    {
+        static_assert(block_threads == 1, "the CPU block functions run a tile per thread: use block_threads = 1");
+        return simd::sum(a, b, selection_flags, num_items);
+    }
+
+} // namespace cpu
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_CPU_BLOCK_FUNCTIONS_HPP
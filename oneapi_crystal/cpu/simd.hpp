@@ -0,0 +1,392 @@
+#ifndef ONEAPI_CRYSTAL_CPU_SIMD_HPP
+#define ONEAPI_CRYSTAL_CPU_SIMD_HPP
+#pragma once
+
+#include <cstdint>
+
+// the intrinsics are for the host pass only
+#if !defined(__SYCL_DEVICE_ONLY__) && defined(__AVX512F__)
+#define CRYSTAL_CPU_AVX512 1
+#include <immintrin.h>
+#elif !defined(__SYCL_DEVICE_ONLY__) && defined(__AVX2__)
+#define CRYSTAL_CPU_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace crystal {
+namespace cpu {
+namespace simd {
+
+    /**
+     * Explicitly vectorized kernels on contiguous runs of int columns,
+     * used by the CPU block functions. The instruction set is picked at
+     * compile time (-mavx512f, -mavx2 or -march=native); without either
+     * every kernel is a plain scalar loop. Flags follow the convention
+     * of the device block functions: one int per item, 0 or 1, and the
+     * flags past n are never written.
+     */
+#if defined(CRYSTAL_CPU_AVX512)
+    constexpr int width = 16;
+    constexpr const char *isa = "avx512";
+#elif defined(CRYSTAL_CPU_AVX2)
+    constexpr int width = 8;
+    constexpr const char *isa = "avx2";
+#else
+    constexpr int width = 1;
+    constexpr const char *isa = "scalar";
+#endif
+
+    enum class Cmp { lt, gt, lte, gte, eq };
+
+    // how a new predicate is combined with the flags already set
+    enum class Combine { set, and_, or_ };
+
+    template <Cmp cmp>
+    inline bool compare_scalar(int a, int b)
+    {
+        switch (cmp) {
+            case Cmp::lt:  return a < b;
+            case Cmp::gt:  return a > b;
+            case Cmp::lte: return a <= b;
+            case Cmp::gte: return a >= b;
+            default:       return a == b;
+        }
+    }
+
+    inline uint32_t hash_mult_scalar(int key, int ht_len)
+    {
+        // same hash as crystal::hash_mult
+        uint32_t h = static_cast<uint32_t>(key) * 0x9E3779B1u;
+        return static_cast<uint32_t>((static_cast<uint64_t>(h) * ht_len) >> 32);
+    }
+
+#if defined(CRYSTAL_CPU_AVX512)
+
+    inline __mmask16 tail_mask(int remaining)
+    {
+        return remaining >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << remaining) - 1);
+    }
+
+    template <Cmp cmp>
+    inline __mmask16 compare_mask(__mmask16 k, __m512i a, __m512i b)
+    {
+        switch (cmp) {
+            case Cmp::lt:  return _mm512_mask_cmp_epi32_mask(k, a, b, _MM_CMPINT_LT);
+            case Cmp::gt:  return _mm512_mask_cmp_epi32_mask(k, a, b, _MM_CMPINT_NLE);
+            case Cmp::lte: return _mm512_mask_cmp_epi32_mask(k, a, b, _MM_CMPINT_LE);
+            case Cmp::gte: return _mm512_mask_cmp_epi32_mask(k, a, b, _MM_CMPINT_NLT);
+            default:       return _mm512_mask_cmp_epi32_mask(k, a, b, _MM_CMPINT_EQ);
+        }
+    }
+
+    inline __m512i hash_mult(__m512i keys, __m512i len)
+    {
+        __m512i h = _mm512_mullo_epi32(keys, _mm512_set1_epi32(static_cast<int>(0x9E3779B1u)));
+        // high halves of the 32 x 32 bit products of the even and odd lanes
+        __m512i even = _mm512_srli_epi64(_mm512_mul_epu32(h, len), 32);
+        __m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(h, 32), len);
+        return _mm512_mask_blend_epi32(__mmask16(0xAAAA), even, odd);
+    }
+
+#elif defined(CRYSTAL_CPU_AVX2)
+
+    inline __m256i tail_mask(int remaining)
+    {
+        __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        return _mm256_cmpgt_epi32(_mm256_set1_epi32(remaining), lanes);
+    }
+
+    inline int movemask(__m256i m)
+    {
+        return _mm256_movemask_ps(_mm256_castsi256_ps(m));
+    }
+
+    template <Cmp cmp>
+    inline __m256i compare_mask(__m256i a, __m256i b)
+    {
+        __m256i ones = _mm256_set1_epi32(-1);
+        switch (cmp) {
+            case Cmp::lt:  return _mm256_cmpgt_epi32(b, a);
+            case Cmp::gt:  return _mm256_cmpgt_epi32(a, b);
+            case Cmp::lte: return _mm256_xor_si256(_mm256_cmpgt_epi32(a, b), ones);
+            case Cmp::gte: return _mm256_xor_si256(_mm256_cmpgt_epi32(b, a), ones);
+            default:       return _mm256_cmpeq_epi32(a, b);
+        }
+    }
+
+    inline __m256i hash_mult(__m256i keys, __m256i len)
+    {
+        __m256i h = _mm256_mullo_epi32(keys, _mm256_set1_epi32(static_cast<int>(0x9E3779B1u)));
+        __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(h, len), 32);
+        __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(h, 32), len);
+        return _mm256_blend_epi32(even, odd, 0xAA);
+    }
+
+#endif
+
+    /**
+     * @brief Evaluates items[i] <cmp> value for i < n and combines
+     *        the result into flags
+     */
+    template <Cmp cmp, Combine combine>
+    inline void compare(const int *items, int value, int *flags, int n)
+    {
+        int i = 0;
+
+#if defined(CRYSTAL_CPU_AVX512)
+        __m512i v = _mm512_set1_epi32(value);
+        __m512i one = _mm512_set1_epi32(1);
+
+        for (; i < n; i += 16) {
+            __mmask16 k = tail_mask(n - i);
+            __mmask16 m = compare_mask<cmp>(k, _mm512_maskz_loadu_epi32(k, items + i), v);
+
+            if (combine != Combine::set) {
+                __m512i f = _mm512_maskz_loadu_epi32(k, flags + i);
+                __mmask16 set = _mm512_mask_test_epi32_mask(k, f, f);
+                m = (combine == Combine::and_) ? (m & set) : (m | set);
+            }
+            _mm512_mask_storeu_epi32(flags + i, k, _mm512_maskz_mov_epi32(m, one));
+        }
+#elif defined(CRYSTAL_CPU_AVX2)
+        __m256i v = _mm256_set1_epi32(value);
+        __m256i zero = _mm256_setzero_si256();
+
+        for (; i < n; i += 8) {
+            __m256i k = tail_mask(n - i);
+            __m256i m = compare_mask<cmp>(_mm256_maskload_epi32(items + i, k), v);
+
+            if (combine != Combine::set) {
+                __m256i f = _mm256_maskload_epi32(flags + i, k);
+                __m256i set = _mm256_xor_si256(_mm256_cmpeq_epi32(f, zero), _mm256_set1_epi32(-1));
+                m = (combine == Combine::and_) ? _mm256_and_si256(m, set) : _mm256_or_si256(m, set);
+            }
+            _mm256_maskstore_epi32(flags + i, k, _mm256_srli_epi32(m, 31));
+        }
+#else
+        for (; i < n; i++) {
+            bool m = compare_scalar<cmp>(items[i], value);
+            if (combine == Combine::and_) m = m && flags[i];
+            if (combine == Combine::or_) m = m || flags[i];
+            flags[i] = m;
+        }
+#endif
+    }
+
+    /**
+     * @brief Probes the keys of the selected items in an open
+     *        addressing table (see insert_linear_1 / insert_linear_2),
+     *        with one gather per probe step for all lanes. With vals
+     *        non null, ht holds [key, value] pairs and the values of
+     *        the matches are written to vals
+     */
+    inline void probe_linear(const int *keys, int *flags, int *vals, const int *ht, int ht_len, int n)
+    {
+        int i = 0;
+
+#if defined(CRYSTAL_CPU_AVX512)
+        __m512i len = _mm512_set1_epi32(ht_len);
+        __m512i zero = _mm512_setzero_si512();
+        __m512i one = _mm512_set1_epi32(1);
+        // the pairs are 8 bytes apart
+        const int stride = vals != nullptr ? 2 : 1;
+
+        for (; i < n; i += 16) {
+            __mmask16 k = tail_mask(n - i);
+            __m512i f = _mm512_maskz_loadu_epi32(k, flags + i);
+            __mmask16 active = _mm512_mask_test_epi32_mask(k, f, f);
+            __mmask16 probed = active;
+            __mmask16 found = 0;
+
+            __m512i key = _mm512_maskz_loadu_epi32(k, keys + i);
+            __m512i slot = hash_mult(key, len);
+            __m512i val = zero;
+
+            for (int step = 0; active && step < ht_len; step++) {
+                __m512i index = _mm512_mullo_epi32(slot, _mm512_set1_epi32(stride));
+                __m512i slot_key = _mm512_mask_i32gather_epi32(zero, active, index, ht, 4);
+
+                __mmask16 match = _mm512_mask_cmpeq_epi32_mask(active, slot_key, key);
+                __mmask16 empty = _mm512_mask_cmpeq_epi32_mask(active, slot_key, zero);
+
+                if (vals != nullptr && match) {
+                    val = _mm512_mask_i32gather_epi32(val, match, index, ht + 1, 4);
+                }
+                found |= match;
+                active &= ~(match | empty);
+
+                slot = _mm512_add_epi32(slot, one);
+                slot = _mm512_mask_mov_epi32(slot, _mm512_cmpeq_epi32_mask(slot, len), zero);
+            }
+
+            _mm512_mask_storeu_epi32(flags + i, probed, _mm512_maskz_mov_epi32(found, one));
+            if (vals != nullptr) {
+                _mm512_mask_storeu_epi32(vals + i, found, val);
+            }
+        }
+#elif defined(CRYSTAL_CPU_AVX2)
+        __m256i len = _mm256_set1_epi32(ht_len);
+        __m256i zero = _mm256_setzero_si256();
+        __m256i one = _mm256_set1_epi32(1);
+        const int stride = vals != nullptr ? 2 : 1;
+
+        for (; i < n; i += 8) {
+            __m256i k = tail_mask(n - i);
+            __m256i f = _mm256_maskload_epi32(flags + i, k);
+            __m256i active = _mm256_andnot_si256(_mm256_cmpeq_epi32(f, zero), k);
+            __m256i probed = active;
+            __m256i found = zero;
+
+            __m256i key = _mm256_maskload_epi32(keys + i, k);
+            __m256i slot = hash_mult(key, len);
+            __m256i val = zero;
+
+            for (int step = 0; movemask(active) && step < ht_len; step++) {
+                __m256i index = _mm256_mullo_epi32(slot, _mm256_set1_epi32(stride));
+                __m256i slot_key = _mm256_mask_i32gather_epi32(zero, ht, index, active, 4);
+
+                __m256i match = _mm256_and_si256(_mm256_cmpeq_epi32(slot_key, key), active);
+                __m256i empty = _mm256_and_si256(_mm256_cmpeq_epi32(slot_key, zero), active);
+
+                if (vals != nullptr && movemask(match)) {
+                    val = _mm256_mask_i32gather_epi32(val, ht + 1, index, match, 4);
+                }
+                found = _mm256_or_si256(found, match);
+                active = _mm256_andnot_si256(_mm256_or_si256(match, empty), active);
+
+                slot = _mm256_add_epi32(slot, one);
+                slot = _mm256_andnot_si256(_mm256_cmpeq_epi32(slot, len), slot);
+            }
+
+            _mm256_maskstore_epi32(flags + i, probed, _mm256_srli_epi32(found, 31));
+            if (vals != nullptr) {
+                _mm256_maskstore_epi32(vals + i, found, val);
+            }
+        }
+#else
+        const int stride = vals != nullptr ? 2 : 1;
+
+        for (; i < n; i++) {
+            if (!flags[i]) continue;
+
+            uint32_t slot = hash_mult_scalar(keys[i], ht_len);
+            int found = 0;
+
+            for (int step = 0; step < ht_len; step++) {
+                int slot_key = ht[slot * stride];
+                if (slot_key == keys[i]) {
+                    if (vals != nullptr) vals[i] = ht[slot * stride + 1];
+                    found = 1;
+                    break;
+                }
+                if (slot_key == 0) break;
+                slot = (slot + 1 == static_cast<uint32_t>(ht_len)) ? 0 : slot + 1;
+            }
+            flags[i] = found;
+        }
+#endif
+    }
+
+    /**
+     * @brief Writes first + i for every selected i < n to selection,
+     *        in order, and returns how many they are
+     */
+    inline int compress(const int *flags, int first, int *selection, int n)
+    {
+        int num_selected = 0;
+        int i = 0;
+
+#if defined(CRYSTAL_CPU_AVX512)
+        __m512i index = _mm512_add_epi32(_mm512_set1_epi32(first),
+                _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        __m512i step = _mm512_set1_epi32(16);
+
+        for (; i < n; i += 16) {
+            __mmask16 k = tail_mask(n - i);
+            __m512i f = _mm512_maskz_loadu_epi32(k, flags + i);
+            __mmask16 m = _mm512_mask_test_epi32_mask(k, f, f);
+
+            _mm512_mask_compressstoreu_epi32(selection + num_selected, m, index);
+            num_selected += __builtin_popcount(m);
+            index = _mm512_add_epi32(index, step);
+        }
+#else
+        // AVX2 has no compress: branch free scalar loop
+        for (; i < n; i++) {
+            selection[num_selected] = first + i;
+            num_selected += flags[i] != 0;
+        }
+#endif
+
+        return num_selected;
+    }
+
+    /**
+     * @brief Sum over the selected i < n of a[i] * b[i] (or of a[i]
+     *        when b is null), accumulated in 64 bits
+     */
+    inline long long sum(const int *a, const int *b, const int *flags, int n)
+    {
+        long long total = 0;
+        int i = 0;
+
+#if defined(CRYSTAL_CPU_AVX512)
+        __m512i acc = _mm512_setzero_si512();
+        __m512i one = _mm512_set1_epi32(1);
+
+        for (; i < n; i += 16) {
+            __mmask16 k = tail_mask(n - i);
+            __m512i f = _mm512_maskz_loadu_epi32(k, flags + i);
+            __mmask16 m = _mm512_mask_test_epi32_mask(k, f, f);
+
+            __m512i x = _mm512_maskz_loadu_epi32(m, a + i);
+            __m512i y = b != nullptr ? _mm512_maskz_loadu_epi32(m, b + i) : _mm512_maskz_mov_epi32(m, one);
+
+            // sign extended 32 x 32 -> 64 bit products, 8 lanes at a time
+            acc = _mm512_add_epi64(acc, _mm512_mul_epi32(
+                    _mm512_cvtepi32_epi64(_mm512_castsi512_si256(x)),
+                    _mm512_cvtepi32_epi64(_mm512_castsi512_si256(y))));
+            acc = _mm512_add_epi64(acc, _mm512_mul_epi32(
+                    _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(x, 1)),
+                    _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(y, 1))));
+        }
+        total = _mm512_reduce_add_epi64(acc);
+#elif defined(CRYSTAL_CPU_AVX2)
+        __m256i acc = _mm256_setzero_si256();
+        __m256i zero = _mm256_setzero_si256();
+
+        for (; i < n; i += 8) {
+            __m256i k = tail_mask(n - i);
+            __m256i f = _mm256_maskload_epi32(flags + i, k);
+            __m256i m = _mm256_andnot_si256(_mm256_cmpeq_epi32(f, zero), k);
+
+            __m256i x = _mm256_maskload_epi32(a + i, m);
+            __m256i y = b != nullptr ? _mm256_maskload_epi32(b + i, m) : _mm256_srli_epi32(m, 31);
+
+            acc = _mm256_add_epi64(acc, _mm256_mul_epi32(
+                    _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)),
+                    _mm256_cvtepi32_epi64(_mm256_castsi256_si128(y))));
+            acc = _mm256_add_epi64(acc, _mm256_mul_epi32(
+                    _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)),
+                    _mm256_cvtepi32_epi64(_mm256_extracti128_si256(y, 1))));
+        }
+
+        long long lanes[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), acc);
+        total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+        for (; i < n; i++) {
+            if (flags[i]) {
+                total += static_cast<long long>(a[i]) * (b != nullptr ? b[i] : 1);
+            }
+        }
+#endif
+
+        return total;
+    }
+
+} // namespace simd
+} // namespace cpu
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_CPU_SIMD_HPP
@@ -2,9 +2,23 @@
 #define ONEAPI_CRYSTAL_CRYSTAL_HPP
 
 // all includes for outside import
+#include "block_functions/bitpacked.hpp"
+#include "block_functions/compact.hpp"
+#include "block_functions/dict.hpp"
+#include "block_functions/group_by.hpp"
+#include "block_functions/histogram.hpp"
 #include "block_functions/join.hpp"
 #include "block_functions/load.hpp"
+#include "block_functions/persistent.hpp"
 #include "block_functions/predicate.hpp"
+#include "block_functions/radix_sort.hpp"
+#include "block_functions/reduce.hpp"
+#include "block_functions/rle.hpp"
+#include "block_functions/scan.hpp"
 #include "block_functions/store.hpp"
+#include "block_functions/zone_map.hpp"
+#include "device_functions/select_if.hpp"
+#include "engine/co_execution.hpp"
+#include "engine/star_query.hpp"
 
 #endif //ONEAPI_CRYSTAL_CRYSTAL_HPP
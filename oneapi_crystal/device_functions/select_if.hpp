@@ -0,0 +1,265 @@
+#ifndef ONEAPI_CRYSTAL_SELECT_IF_HPP
+#define ONEAPI_CRYSTAL_SELECT_IF_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <iostream>
+
+#include "../block_functions/load.hpp"
+#include "../block_functions/predicate.hpp"
+#include "../block_functions/scan.hpp"
+#include "../block_functions/store.hpp"
+
+namespace crystal {
+
+    /**
+     * Device-wide select: writes the items of a column satisfying
+     * select_op (and / or their row ids) contiguously, in input
+     * order. Two passes over the input: the first counts the
+     * selected items of every tile, a single work-group scans the
+     * counts into output offsets, and the second evaluates the
+     * predicate again and scatters every tile at its offset.
+     */
+
+    template <typename T, typename SelectOp, int block_threads, int items_per_thread>
+    void select_count_tiles(
+            T *in,
+            int num_items,
+            SelectOp select_op,
+            int *tile_counts,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        constexpr int tile_size = block_threads * items_per_thread;
+        T items[items_per_thread];
+        int selection_flags[items_per_thread];
+
+        int tile_offset = item_ct1.get_group(0) * tile_size;
+        int num_tiles = (num_items + tile_size - 1) / tile_size;
+        int num_tile_items = tile_size;
+
+        if (item_ct1.get_group(0) == num_tiles - 1) {
+            num_tile_items = num_items - tile_offset;
+        }
+
+        load<T, block_threads, items_per_thread>(in + tile_offset, items, num_tile_items, item_ct1);
+        predicate<T, SelectOp, block_threads, items_per_thread>(items, select_op, selection_flags,
+                num_tile_items, item_ct1);
+
+        int count = 0;
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (item_ct1.get_local_id(0) + (i * block_threads) < num_tile_items && selection_flags[i]) {
+                count++;
+            }
+        }
+
+        count = sycl::reduce_over_group(item_ct1.get_group(), count, sycl::plus<>());
+
+        if (item_ct1.get_local_id(0) == 0) {
+            tile_counts[item_ct1.get_group(0)] = count;
+        }
+    }
+
+    /**
+     * @brief Exclusive scan of the tile counts in place, run by a
+     *        single work-group; tile_counts[num_tiles] gets the total
+     */
+    template <int block_threads, int items_per_thread>
+    void select_scan_tiles(
+            int *tile_counts,
+            int num_tiles,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        constexpr int tile_size = block_threads * items_per_thread;
+        int counts[items_per_thread];
+        int offsets[items_per_thread];
+        int running = 0;
+
+        for (int chunk = 0; chunk < num_tiles; chunk += tile_size) {
+            int num_chunk_items = sycl::min(tile_size, num_tiles - chunk);
+
+            load<int, block_threads, items_per_thread>(tile_counts + chunk, counts, num_chunk_items, item_ct1);
+            int total = block_exclusive_sum<int, block_threads, items_per_thread>(counts, offsets,
+                    nullptr, num_chunk_items, item_ct1);
+
+            #pragma unroll
+            for (int i = 0; i < items_per_thread; i++) {
+                offsets[i] += running;
+            }
+
+            store<int, block_threads, items_per_thread>(tile_counts + chunk, offsets, num_chunk_items, item_ct1);
+            running += total;
+        }
+
+        if (item_ct1.get_local_id(0) == 0) {
+            tile_counts[num_tiles] = running;
+        }
+    }
+
+    template <typename T, typename SelectOp, int block_threads, int items_per_thread>
+    void select_scatter_tiles(
+            T *in,
+            int num_items,
+            SelectOp select_op,
+            const int *tile_offsets,
+            T *out,
+            int *out_rows,
+            sycl::nd_item<1> item_ct1
+    )
+    {
+        constexpr int tile_size = block_threads * items_per_thread;
+        T items[items_per_thread];
+        int selection_flags[items_per_thread];
+        int positions[items_per_thread];
+
+        int tid = item_ct1.get_local_id(0);
+        int tile_offset = item_ct1.get_group(0) * tile_size;
+        int num_tiles = (num_items + tile_size - 1) / tile_size;
+        int num_tile_items = tile_size;
+
+        if (item_ct1.get_group(0) == num_tiles - 1) {
+            num_tile_items = num_items - tile_offset;
+        }
+
+        load<T, block_threads, items_per_thread>(in + tile_offset, items, num_tile_items, item_ct1);
+        predicate<T, SelectOp, block_threads, items_per_thread>(items, select_op, selection_flags,
+                num_tile_items, item_ct1);
+
+        // the flags of the items past num_tile_items are not set
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (tid + (i * block_threads) >= num_tile_items) {
+                selection_flags[i] = 0;
+            }
+        }
+
+        block_exclusive_sum<int, block_threads, items_per_thread>(selection_flags, positions,
+                nullptr, num_tile_items, item_ct1);
+
+        int out_offset = tile_offsets[item_ct1.get_group(0)];
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            if (selection_flags[i]) {
+                if (out != nullptr) out[out_offset + positions[i]] = items[i];
+                if (out_rows != nullptr) out_rows[out_offset + positions[i]] = tile_offset + tid + (i * block_threads);
+            }
+        }
+    }
+
+    template <typename T, typename SelectOp> class select_count_kernel;
+    template <typename T, typename SelectOp> class select_scan_kernel;
+    template <typename T, typename SelectOp> class select_scatter_kernel;
+
+    /**
+     * @brief Entries of the tile_counts buffer of select_if
+     */
+    inline int get_select_if_counts_len(int num_items)
+    {
+        constexpr int tile_items = 128 * 4;
+        return (num_items + tile_items - 1) / tile_items + 1;
+    }
+
+    /**
+     * @brief Selects the items of in (device memory) satisfying
+     *        select_op, e.g. a functor of predicate.hpp
+     * @param out           selected items, or nullptr
+     * @param out_rows      row ids of the selected items, or nullptr
+     * @param tile_counts   device scratch of get_select_if_counts_len
+     *                      entries, so that repeated selects need not
+     *                      allocate it
+     * @return int          number of selected items
+     */
+    template <typename T, typename SelectOp>
+    int select_if(
+            sycl::queue &q,
+            T *in,
+            int num_items,
+            SelectOp select_op,
+            T *out,
+            int *out_rows,
+            int *tile_counts
+    )
+    {
+        constexpr int block_threads = 128;
+        constexpr int items_per_thread = 4;
+        constexpr int tile_items = block_threads * items_per_thread;
+
+        int num_tiles = (num_items + tile_items - 1) / tile_items;
+        int num_selected = 0;
+
+        if (num_tiles == 0) {
+            return 0;
+        }
+
+        try {
+            sycl::nd_range<1> tiles({static_cast<size_t>(num_tiles * block_threads)}, {block_threads});
+
+            sycl::event counted = q.submit([&](sycl::handler &h) {
+                h.parallel_for<select_count_kernel<T, SelectOp>>(tiles, [=](sycl::nd_item<1> it) {
+                    select_count_tiles<T, SelectOp, block_threads, items_per_thread>(
+                        in, num_items, select_op, tile_counts, it);
+                });
+            });
+
+            sycl::event scanned = q.submit([&](sycl::handler &h) {
+                h.depends_on(counted);
+                h.parallel_for<select_scan_kernel<T, SelectOp>>(
+                    sycl::nd_range<1>({block_threads}, {block_threads}), [=](sycl::nd_item<1> it) {
+                        select_scan_tiles<block_threads, items_per_thread>(tile_counts, num_tiles, it);
+                    });
+            });
+
+            sycl::event scattered = q.submit([&](sycl::handler &h) {
+                h.depends_on(scanned);
+                h.parallel_for<select_scatter_kernel<T, SelectOp>>(tiles, [=](sycl::nd_item<1> it) {
+                    select_scatter_tiles<T, SelectOp, block_threads, items_per_thread>(
+                        in, num_items, select_op, tile_counts, out, out_rows, it);
+                });
+            });
+
+            q.memcpy(&num_selected, tile_counts + num_tiles, sizeof(int), scattered).wait();
+        }
+        catch (sycl::exception const &exc) {
+            std::cerr << exc.what() << "Exception caught at file:" << __FILE__
+                      << ", line:" << __LINE__ << std::endl;
+            std::exit(1);
+        }
+
+        return num_selected;
+    }
+
+    /**
+     * @brief Same as above, allocating the tile counts on every call
+     */
+    template <typename T, typename SelectOp>
+    int select_if(
+            sycl::queue &q,
+            T *in,
+            int num_items,
+            SelectOp select_op,
+            T *out,
+            int *out_rows
+    )
+    {
+        int *tile_counts = nullptr;
+        try {
+            tile_counts = (int *)malloc_device(get_select_if_counts_len(num_items) * sizeof(int), q);
+        }
+        catch (sycl::exception const &exc) {
+            std::cerr << exc.what() << "Exception caught at file:" << __FILE__
+                      << ", line:" << __LINE__ << std::endl;
+            std::exit(1);
+        }
+
+        int num_selected = select_if(q, in, num_items, select_op, out, out_rows, tile_counts);
+        sycl::free(tile_counts, q);
+        return num_selected;
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_SELECT_IF_HPP
@@ -0,0 +1,133 @@
+#ifndef ONEAPI_CRYSTAL_CO_EXECUTION_HPP
+#define ONEAPI_CRYSTAL_CO_EXECUTION_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "star_query.hpp"
+
+namespace crystal {
+
+    /**
+     * Co-execution of a star query on several queues, e.g. the CPU
+     * and the integrated GPU of a node: no split is decided up front,
+     * every queue pulls the next batch of fact tiles from a shared
+     * counter as soon as it is done with its previous one, so the
+     * faster device takes more batches and all of them finish within
+     * a batch of each other. Each queue builds its own copy of the
+     * dimension hash tables.
+     */
+
+    /**
+     * @brief Fact rows cut into batches of batch_items rows, claimed
+     *        through an atomic counter by any number of threads
+     */
+    class tile_batches {
+    public:
+        tile_batches(int num_items, int batch_items)
+            : num_items_(num_items), batch_items_(std::max(1, batch_items)), next_(0) {}
+
+        int num_batches() const { return (num_items_ + batch_items_ - 1) / batch_items_; }
+
+        /**
+         * @brief Claims the next batch, false once all are taken
+         */
+        bool next(int &begin, int &end)
+        {
+            int batch = next_.fetch_add(1, std::memory_order_relaxed);
+            if (batch >= num_batches()) {
+                return false;
+            }
+
+            begin = batch * batch_items_;
+            end = std::min(num_items_, begin + batch_items_);
+            return true;
+        }
+
+    private:
+        int num_items_;
+        int batch_items_;
+        std::atomic<int> next_;
+    };
+
+    // what a queue did during a co-execution
+    struct co_execution_stats {
+        int batches = 0;
+        double ms = 0;
+    };
+
+    /**
+     * @brief Runs query on all the queues at once, queue d reading
+     *        its columns through resolvers[d], and sums their groups.
+     *        Returns an empty result when run_star_query fails
+     *        on any of the queues
+     * @param batch_items  rows per batch, a multiple of the tile size
+     * @param stats        per queue batches and elapsed time, if given
+     */
+    inline std::vector<unsigned long long> run_star_query_coexec(
+        std::vector<sycl::queue> &queues,
+        const StarQuery &query,
+        const std::vector<ColumnResolver> &resolvers,
+        int batch_items,
+        std::vector<co_execution_stats> *stats = nullptr
+    )
+    {
+        int num_queues = static_cast<int>(queues.size());
+        int fact_len = 0;
+        if (num_queues == 0 || resolvers[0](query.measure_a, fact_len) == nullptr) {
+            return {};
+        }
+
+        tile_batches batches(fact_len, batch_items);
+        std::vector<std::vector<unsigned long long>> partials(num_queues);
+        std::vector<co_execution_stats> queue_stats(num_queues);
+        std::vector<std::thread> threads;
+
+        for (int d = 0; d < num_queues; d++) {
+            threads.emplace_back([&, d]() {
+                auto st = std::chrono::high_resolution_clock::now();
+
+                partials[d] = run_star_query(queues[d], query, resolvers[d], [&, d](int &begin, int &end) {
+                    if (!batches.next(begin, end)) {
+                        return false;
+                    }
+                    queue_stats[d].batches++;
+                    return true;
+                });
+
+                auto finish = std::chrono::high_resolution_clock::now();
+                queue_stats[d].ms = std::chrono::duration<double>(finish - st).count() * 1000.;
+            });
+        }
+
+        for (std::thread &t : threads) {
+            t.join();
+        }
+
+        if (stats != nullptr) {
+            *stats = queue_stats;
+        }
+
+        std::vector<unsigned long long> groups;
+        for (const std::vector<unsigned long long> &partial : partials) {
+            if (partial.empty()) {
+                return {};
+            }
+            groups.resize(partial.size(), 0);
+            for (size_t g = 0; g < partial.size(); g++) {
+                groups[g] += partial[g];
+            }
+        }
+
+        return groups;
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_CO_EXECUTION_HPP
@@ -0,0 +1,605 @@
+#ifndef ONEAPI_CRYSTAL_STAR_QUERY_HPP
+#define ONEAPI_CRYSTAL_STAR_QUERY_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <array>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../block_functions/compact.hpp"
+#include "../block_functions/group_by.hpp"
+#include "../block_functions/join.hpp"
+#include "../block_functions/load.hpp"
+#include "../block_functions/predicate.hpp"
+#include "../utils/atomic.hpp"
+
+namespace crystal {
+
+    /**
+     * Star-schema queries described as data:
+     *
+     *   select sum(measure) from fact, dim_1, ..., dim_n
+     *   where <filters on fact> and <filter on each dim_i>
+     *   group by <one column of some dim_i>
+     *
+     * A StarQuery names the columns, run_star_query resolves
+     * them and runs one build kernel per dimension and a single
+     * probe kernel fusing scan, filters, probes and aggregation.
+     * The number of filters and dimensions are template
+     * parameters of the probe kernel, so its loops are unrolled
+     * as in the hand-written queries
+     */
+
+    // largest plan run_star_query instantiates a kernel for
+    constexpr int max_star_filters = 3;
+    constexpr int max_star_dims = 4;
+
+    enum class FilterKind { none, eq, eq_or, between };
+
+    /**
+     * @brief Selection functor for predicate / predicate_and:
+     *        none keeps every row, eq keeps a == lo, eq_or
+     *        keeps a == lo || a == hi, between keeps lo <= a <= hi
+     */
+    struct Filter {
+        FilterKind kind = FilterKind::none;
+        int lo = 0;
+        int hi = 0;
+
+        static Filter eq(int value) { return {FilterKind::eq, value, value}; }
+        static Filter eq_or(int a, int b) { return {FilterKind::eq_or, a, b}; }
+        static Filter between(int lo, int hi) { return {FilterKind::between, lo, hi}; }
+
+        inline bool operator()(const int &a) const {
+            switch (kind) {
+                case FilterKind::eq: return a == lo;
+                case FilterKind::eq_or: return a == lo || a == hi;
+                case FilterKind::between: return a >= lo && a <= hi;
+                default: return true;
+            }
+        }
+    };
+
+    // value aggregated for every selected fact row
+    enum class MeasureKind { sum, sum_product, sum_difference };
+
+    struct FilterSpec {
+        std::string column;
+        Filter filter;
+    };
+
+    /**
+     * @brief Join of the fact table with a dimension on
+     *        fact_fkey = key, keeping the rows passing filter.
+     *        When group_column is set the dimension also takes
+     *        part to the grouping, with values in
+     *        [group_min, group_min + group_cardinality)
+     */
+    struct DimensionSpec {
+        std::string fact_fkey;
+        std::string key;
+        FilterSpec filter;
+        std::string group_column;
+        int group_min = 0;
+        int group_cardinality = 1;
+    };
+
+    struct StarQuery {
+        std::string name;
+        std::vector<FilterSpec> filters;
+        std::vector<DimensionSpec> dims;
+        MeasureKind measure = MeasureKind::sum;
+        std::string measure_a;
+        std::string measure_b;
+        // compact the tile once the fact filters (or, without any,
+        // a first dimension that does not group) have run, worth it
+        // when they leave few rows
+        bool compact = false;
+    };
+
+    /**
+     * @brief Returns the device pointer of a column, and its
+     *        number of rows in len; nullptr when it is missing
+     */
+    using ColumnResolver = std::function<int *(const std::string &column, int &len)>;
+
+    /**
+     * @brief Hands out the next range [begin, end) of fact rows to
+     *        probe, false once there is none left; lets several
+     *        queues share the probe of a fact table
+     */
+    using FactRangeSource = std::function<bool(int &begin, int &end)>;
+
+    // device side of the plan, every column resolved
+    struct FactFilter {
+        int *column;
+        Filter filter;
+    };
+
+    struct Dimension {
+        int *fact_fkey;
+        int *key;
+        int *filter_column;
+        Filter filter;
+        int *group_column;
+        int group_min;
+        int group_cardinality;
+        int len;
+        int *ht;
+        int ht_len;
+    };
+
+    template <int num_filters, int num_dims>
+    struct StarPlan {
+        std::array<FactFilter, num_filters> filters;
+        std::array<Dimension, num_dims> dims;
+        MeasureKind measure;
+        int *measure_a;
+        int *measure_b;
+        int fact_len;
+        int num_groups;
+        int res_len;
+        bool compact;
+    };
+
+    template <int block_threads, int items_per_thread>
+    void star_build(Dimension dim, sycl::nd_item<1> item_ct1)
+    {
+        constexpr int tile_size = block_threads * items_per_thread;
+        int items[items_per_thread];
+        int values[items_per_thread];
+        int selection_flags[items_per_thread];
+
+        int tile_offset = item_ct1.get_group(0) * tile_size;
+        int num_tiles = (dim.len + tile_size - 1) / tile_size;
+        int num_tile_items = tile_size;
+
+        if (item_ct1.get_group(0) == num_tiles - 1) {
+            num_tile_items = dim.len - tile_offset;
+        }
+
+        init_flags<block_threads, items_per_thread>(selection_flags);
+
+        if (dim.filter_column != nullptr) {
+            load<int, block_threads, items_per_thread>(dim.filter_column + tile_offset, items, num_tile_items, item_ct1);
+            predicate_and<int, Filter, block_threads, items_per_thread>(items, dim.filter,
+                selection_flags, num_tile_items, item_ct1);
+        }
+
+        load<int, block_threads, items_per_thread>(dim.key + tile_offset, items, num_tile_items, item_ct1);
+
+        if (dim.group_column != nullptr) {
+            load<int, block_threads, items_per_thread>(dim.group_column + tile_offset, values, num_tile_items, item_ct1);
+            build_selective_linear_2<int, int, block_threads, items_per_thread>(items, values, selection_flags,
+                dim.ht, dim.ht_len, num_tile_items, item_ct1);
+        } else {
+            build_selective_linear_1<int, block_threads, items_per_thread>(items, selection_flags,
+                dim.ht, dim.ht_len, num_tile_items, item_ct1);
+        }
+    }
+
+    /**
+     * @brief Probe kernel of a star query: filters the fact tile,
+     *        probes every dimension building a mixed-radix group id
+     *        out of the grouping values, and sums the measure of the
+     *        selected rows per group id into the aggregate table
+     *        res_keys / res_aggs, pre-aggregating every tile in the
+     *        local tables. Without grouping the sum goes to res_aggs[0].
+     *        A selected row whose grouping value falls outside the
+     *        declared range of its dimension would index past the
+     *        dense result: it is counted in *out_of_range instead.
+     *        With plan.compact the stages after the first one only
+     *        gather the rows it selected, through the selection vector
+     */
+    template <int block_threads, int items_per_thread, int num_filters, int num_dims>
+    void star_probe(
+        StarPlan<num_filters, num_dims> plan,
+        int *res_keys,
+        long long *res_aggs,
+        int *res_overflow,
+        int *out_of_range,
+        int *local_keys,
+        long long *local_aggs,
+        int *selection,
+        sycl::nd_item<1> item_ct1
+    )
+    {
+        constexpr int tile_size = block_threads * items_per_thread;
+        int items[items_per_thread];
+        int values[items_per_thread];
+        int selection_flags[items_per_thread];
+        int groups[items_per_thread];
+
+        int tid = item_ct1.get_local_id(0);
+        int tile_offset = item_ct1.get_group(0) * tile_size;
+        int num_tiles = (plan.fact_len + tile_size - 1) / tile_size;
+        int num_tile_items = tile_size;
+
+        if (item_ct1.get_group(0) == num_tiles - 1) {
+            num_tile_items = plan.fact_len - tile_offset;
+        }
+
+        init_flags<block_threads, items_per_thread>(selection_flags);
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            groups[i] = 0;
+        }
+
+        // rows of the tile still processed, all of them until compacted
+        int num_items = num_tile_items;
+        bool compacted = false;
+
+        auto load_rows = [&](int *column, int (&rows)[items_per_thread]) {
+            if (compacted) {
+                load_selected<int, block_threads, items_per_thread>(column + tile_offset, selection, rows,
+                    num_items, item_ct1);
+            } else {
+                load<int, block_threads, items_per_thread>(column + tile_offset, rows, num_items, item_ct1);
+            }
+        };
+
+        #pragma unroll
+        for (int f = 0; f < num_filters; f++) {
+            load_rows(plan.filters[f].column, items);
+            predicate_and<int, Filter, block_threads, items_per_thread>(items, plan.filters[f].filter,
+                selection_flags, num_items, item_ct1);
+        }
+
+        if (plan.compact && num_filters > 0) {
+            num_items = block_compact<block_threads, items_per_thread>(selection_flags, selection,
+                num_items, item_ct1);
+            compacted = true;
+            if (num_items == 0) return;
+        }
+
+        #pragma unroll
+        for (int d = 0; d < num_dims; d++) {
+            const Dimension &dim = plan.dims[d];
+            load_rows(dim.fact_fkey, items);
+
+            if (dim.group_column != nullptr) {
+                probe_linear_2<int, int, block_threads, items_per_thread>(items, values, selection_flags,
+                    dim.ht, dim.ht_len, num_items, item_ct1);
+
+                #pragma unroll
+                for (int i = 0; i < items_per_thread; i++) {
+                    int value = values[i] - dim.group_min;
+                    if (tid + (block_threads * i) < num_items && selection_flags[i] &&
+                        (value < 0 || value >= dim.group_cardinality)) {
+                        atomicAdd(*out_of_range, 1);
+                        selection_flags[i] = 0;
+                    }
+                    groups[i] = groups[i] * dim.group_cardinality + value;
+                }
+            } else {
+                probe_linear_1<int, block_threads, items_per_thread>(items, selection_flags,
+                    dim.ht, dim.ht_len, num_items, item_ct1);
+
+                if (plan.compact && !compacted) {
+                    num_items = block_compact<block_threads, items_per_thread>(selection_flags, selection,
+                        num_items, item_ct1);
+                    compacted = true;
+                    if (num_items == 0) return;
+                }
+            }
+        }
+
+        load_rows(plan.measure_a, items);
+        if (plan.measure != MeasureKind::sum) {
+            load_rows(plan.measure_b, values);
+        }
+
+        long long measures[items_per_thread];
+        long long sum = 0;
+
+        #pragma unroll
+        for (int i = 0; i < items_per_thread; i++) {
+            switch (plan.measure) {
+                case MeasureKind::sum_product:
+                    measures[i] = (long long)items[i] * values[i];
+                    break;
+                case MeasureKind::sum_difference:
+                    measures[i] = (long long)items[i] - values[i];
+                    break;
+                default:
+                    measures[i] = items[i];
+            }
+
+            if (tid + (block_threads * i) < num_items && selection_flags[i]) {
+                sum += measures[i];
+            }
+        }
+
+        if (plan.num_groups == 1) {
+            long long aggregate = sycl::reduce_over_group(item_ct1.get_group(), sum, sycl::plus<>());
+
+            if (tid == 0) {
+                atomicAdd(res_aggs[0], aggregate);
+            }
+        } else {
+            group_by_local<int, long long, Sum, block_threads, items_per_thread>(groups, measures,
+                selection_flags, Sum(), local_keys, local_aggs, get_linear_ht_len(tile_size),
+                res_keys, res_aggs, plan.res_len, res_overflow, num_items, item_ct1);
+        }
+    }
+
+    /**
+     * @brief The plan restricted to the fact rows [begin, end)
+     */
+    template <int num_filters, int num_dims>
+    StarPlan<num_filters, num_dims> star_plan_range(
+        StarPlan<num_filters, num_dims> plan,
+        int begin,
+        int end
+    )
+    {
+        for (int f = 0; f < num_filters; f++) {
+            plan.filters[f].column += begin;
+        }
+        for (int d = 0; d < num_dims; d++) {
+            plan.dims[d].fact_fkey += begin;
+        }
+        plan.measure_a += begin;
+        if (plan.measure_b != nullptr) {
+            plan.measure_b += begin;
+        }
+        plan.fact_len = end - begin;
+        return plan;
+    }
+
+    template <int num_filters, int num_dims> class star_build_kernel;
+    template <int num_filters, int num_dims> class star_probe_kernel;
+
+    template <int num_filters, int num_dims>
+    std::vector<unsigned long long> run_star_plan(
+        sycl::queue &q,
+        const StarQuery &query,
+        const ColumnResolver &resolve,
+        const FactRangeSource &next_range
+    )
+    {
+        constexpr int block_threads = 128;
+        constexpr int items_per_thread = 4;
+        constexpr int tile_items = block_threads * items_per_thread;
+
+        StarPlan<num_filters, num_dims> plan;
+        int len = 0;
+        bool resolved = true;
+
+        auto column = [&](const std::string &name, int &rows) -> int * {
+            if (name.empty()) return nullptr;
+            int *col = resolve(name, rows);
+            if (col == nullptr) {
+                std::cerr << "[Error] " << query.name << ": column " << name << " not found" << std::endl;
+                resolved = false;
+            }
+            return col;
+        };
+
+        plan.measure = query.measure;
+        plan.measure_a = column(query.measure_a, plan.fact_len);
+        plan.measure_b = query.measure == MeasureKind::sum ? nullptr : column(query.measure_b, len);
+        plan.num_groups = 1;
+        plan.res_len = 1;
+        // a first dimension that groups has to run before compacting
+        plan.compact = query.compact &&
+            (num_filters > 0 || (num_dims > 0 && query.dims[0].group_column.empty()));
+
+        for (int f = 0; f < num_filters; f++) {
+            plan.filters[f] = {column(query.filters[f].column, len), query.filters[f].filter};
+        }
+
+        for (int d = 0; d < num_dims; d++) {
+            const DimensionSpec &spec = query.dims[d];
+            Dimension &dim = plan.dims[d];
+
+            dim.fact_fkey = column(spec.fact_fkey, len);
+            dim.key = column(spec.key, dim.len);
+            dim.filter_column = column(spec.filter.column, len);
+            dim.filter = spec.filter.filter;
+            dim.group_column = column(spec.group_column, len);
+            dim.group_min = spec.group_min;
+            dim.group_cardinality = dim.group_column != nullptr ? spec.group_cardinality : 1;
+            dim.ht_len = get_linear_ht_len(dim.len);
+            dim.ht = nullptr;
+
+            plan.num_groups *= dim.group_cardinality;
+        }
+
+        if (!resolved || plan.measure_a == nullptr) {
+            return {};
+        }
+
+        if (plan.num_groups > 1) {
+            plan.res_len = get_linear_ht_len(plan.num_groups);
+        }
+
+        std::vector<unsigned long long> groups(plan.num_groups, 0);
+
+        try {
+            std::vector<sycl::event> builds;
+
+            for (int d = 0; d < num_dims; d++) {
+                Dimension &dim = plan.dims[d];
+                dim.ht = (int *)malloc_device(2 * dim.ht_len * sizeof(int), q);
+                sycl::event zeroed = q.memset(dim.ht, 0, 2 * dim.ht_len * sizeof(int));
+
+                Dimension build = dim;
+                int num_blocks = (dim.len + tile_items - 1) / tile_items;
+
+                builds.push_back(q.submit([&](sycl::handler &h) {
+                    h.depends_on(zeroed);
+                    h.parallel_for<star_build_kernel<num_filters, num_dims>>(
+                        sycl::nd_range<1>({static_cast<size_t>(num_blocks * block_threads)}, {block_threads}),
+                        [=](sycl::nd_item<1> it) {
+                            star_build<block_threads, items_per_thread>(build, it);
+                        });
+                }));
+            }
+
+            int *res_keys = (int *)malloc_device(plan.res_len * sizeof(int), q);
+            long long *res_aggs = (long long *)malloc_device(plan.res_len * sizeof(long long), q);
+            int *res_overflow = (int *)malloc_device(sizeof(int), q);
+            int *out_of_range = (int *)malloc_device(sizeof(int), q);
+            // zeroed while the dimensions are built
+            std::vector<sycl::event> probe_deps = init_group_by_async(q, res_keys, res_aggs, plan.res_len,
+                res_overflow, Sum());
+            probe_deps.push_back(q.memset(out_of_range, 0, sizeof(int)));
+            probe_deps.insert(probe_deps.end(), builds.begin(), builds.end());
+
+            int local_len = get_linear_ht_len(tile_items);
+
+            // probes the fact rows [begin, end)
+            auto probe = [&](int begin, int end) {
+                StarPlan<num_filters, num_dims> range = star_plan_range(plan, begin, end);
+                int num_blocks = (range.fact_len + tile_items - 1) / tile_items;
+
+                return q.submit([&](sycl::handler &h) {
+                    sycl::local_accessor<int, 1> local_keys(sycl::range<1>(local_len), h);
+                    sycl::local_accessor<long long, 1> local_aggs(sycl::range<1>(local_len), h);
+                    sycl::local_accessor<int, 1> selection(sycl::range<1>(tile_items), h);
+
+                    h.depends_on(probe_deps);
+                    h.parallel_for<star_probe_kernel<num_filters, num_dims>>(
+                        sycl::nd_range<1>({static_cast<size_t>(num_blocks * block_threads)}, {block_threads}),
+                        [=](sycl::nd_item<1> it) {
+                            star_probe<block_threads, items_per_thread, num_filters, num_dims>(range,
+                                res_keys, res_aggs, res_overflow, out_of_range,
+                                local_keys.get_pointer(), local_aggs.get_pointer(),
+                                selection.get_pointer(), it);
+                        });
+                });
+            };
+
+            if (next_range) {
+                // the next range is claimed while the current one runs
+                sycl::event running;
+                int begin, end;
+                while (next_range(begin, end)) {
+                    sycl::event submitted = probe(begin, end);
+                    running.wait();
+                    running = submitted;
+                }
+                running.wait();
+            } else if (plan.fact_len > 0) {
+                probe(0, plan.fact_len).wait();
+            }
+
+            std::vector<int> h_keys(plan.res_len);
+            std::vector<long long> h_aggs(plan.res_len);
+            q.memcpy(h_keys.data(), res_keys, plan.res_len * sizeof(int)).wait();
+            q.memcpy(h_aggs.data(), res_aggs, plan.res_len * sizeof(long long)).wait();
+            bool complete = check_group_by_overflow(q, res_overflow, plan.res_len);
+
+            int h_out_of_range = 0;
+            q.memcpy(&h_out_of_range, out_of_range, sizeof(int)).wait();
+            if (h_out_of_range != 0) {
+                std::cerr << "[Error] " << query.name << ": " << h_out_of_range
+                          << " rows have a grouping value outside the declared range of its dimension"
+                          << std::endl;
+                complete = false;
+            }
+
+            if (plan.num_groups == 1) {
+                groups[0] = h_aggs[0];
+            } else {
+                for (int slot = 0; slot < plan.res_len; slot++) {
+                    if (h_keys[slot] != group_empty_key<int>()) {
+                        groups[h_keys[slot]] = h_aggs[slot];
+                    }
+                }
+            }
+
+            sycl::free(res_keys, q);
+            sycl::free(res_aggs, q);
+            sycl::free(res_overflow, q);
+            sycl::free(out_of_range, q);
+            for (int d = 0; d < num_dims; d++) {
+                sycl::free(plan.dims[d].ht, q);
+            }
+
+            // an incomplete result is no result
+            if (!complete) {
+                return {};
+            }
+        }
+        catch (sycl::exception const &exc) {
+            std::cerr << exc.what() << "Exception caught at file:" << __FILE__
+                      << ", line:" << __LINE__ << std::endl;
+            std::exit(1);
+        }
+
+        return groups;
+    }
+
+    template <int num_filters>
+    std::vector<unsigned long long> run_star_plan(
+        sycl::queue &q,
+        const StarQuery &query,
+        const ColumnResolver &resolve,
+        const FactRangeSource &next_range
+    )
+    {
+        switch (query.dims.size()) {
+            case 0: return run_star_plan<num_filters, 0>(q, query, resolve, next_range);
+            case 1: return run_star_plan<num_filters, 1>(q, query, resolve, next_range);
+            case 2: return run_star_plan<num_filters, 2>(q, query, resolve, next_range);
+            case 3: return run_star_plan<num_filters, 3>(q, query, resolve, next_range);
+            default: return run_star_plan<num_filters, max_star_dims>(q, query, resolve, next_range);
+        }
+    }
+
+    /**
+     * @brief Runs a star query and returns its aggregate for
+     *        every group, indexed as decoded by star_group_values;
+     *        empty when the plan cannot run, its aggregate table
+     *        overflowed or a grouping value fell outside the range
+     *        of its dimension. With next_range only the fact rows it
+     *        hands out are probed
+     */
+    inline std::vector<unsigned long long> run_star_query(
+        sycl::queue &q,
+        const StarQuery &query,
+        const ColumnResolver &resolve,
+        const FactRangeSource &next_range = nullptr
+    )
+    {
+        if (query.filters.size() > max_star_filters || query.dims.size() > max_star_dims) {
+            std::cerr << "[Error] " << query.name << ": at most " << max_star_filters
+                      << " fact filters and " << max_star_dims << " dimensions are supported" << std::endl;
+            return {};
+        }
+
+        switch (query.filters.size()) {
+            case 0: return run_star_plan<0>(q, query, resolve, next_range);
+            case 1: return run_star_plan<1>(q, query, resolve, next_range);
+            case 2: return run_star_plan<2>(q, query, resolve, next_range);
+            default: return run_star_plan<max_star_filters>(q, query, resolve, next_range);
+        }
+    }
+
+    /**
+     * @brief Grouping values of a group id, one per grouping
+     *        dimension in the order they appear in the query
+     */
+    inline std::vector<int> star_group_values(const StarQuery &query, int group)
+    {
+        std::vector<int> values;
+
+        for (auto dim = query.dims.rbegin(); dim != query.dims.rend(); ++dim) {
+            if (!dim->group_column.empty()) {
+                values.insert(values.begin(), dim->group_min + group % dim->group_cardinality);
+                group /= dim->group_cardinality;
+            }
+        }
+
+        return values;
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_STAR_QUERY_HPP
@@ -0,0 +1,279 @@
+#ifndef ONEAPI_CRYSTAL_AUTOTUNE_HPP
+#define ONEAPI_CRYSTAL_AUTOTUNE_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace crystal {
+
+    /**
+     * Auto-tuning of the tile shape of a query. The shape is a pair of
+     * template parameters, so every candidate of tile_shapes below is
+     * instantiated at compile time; a query passes a launcher, i.e. a
+     * generic lambda taking a tile_shape and running the query with it:
+     *
+     *     auto launch = [&](auto shape) {
+     *         using S = decltype(shape);
+     *         return run_query<S::block_threads, S::items_per_thread>(...);
+     *     };
+     *
+     * returning the elapsed time in ms. autotune_tile_config times every
+     * shape the device supports and stores the fastest in the tuning
+     * cache, per device and query; load_tile_config reads it back at
+     * startup and dispatch_tile_config runs the chosen instantiation.
+     * get_kernel_sizes (kernel_config.hpp) also bounds its work-groups
+     * by the tuned block_threads of a query.
+     */
+    struct tile_config {
+        int block_threads;
+        int items_per_thread;
+    };
+
+    template <int bt, int ipt>
+    struct tile_shape {
+        static constexpr int block_threads = bt;
+        static constexpr int items_per_thread = ipt;
+    };
+
+    // the candidates; the ones whose local memory (tile-sized group by
+    // or join tables) exceeds the device's are skipped when tuning
+    using tile_shapes = std::tuple<
+        tile_shape<64, 4>,
+        tile_shape<64, 8>,
+        tile_shape<128, 2>,
+        tile_shape<128, 4>,
+        tile_shape<128, 8>,
+        tile_shape<256, 2>,
+        tile_shape<256, 4>,
+        tile_shape<512, 2>
+    >;
+
+    // shape of all the queries so far, used when nothing is cached
+    constexpr tile_config default_tile_config{128, 4};
+
+    /**
+     * @brief Path of the tuning cache: $CRYSTAL_TUNING_CACHE, or
+     *        crystal_tuning.cache in the working directory
+     */
+    inline std::string tuning_cache_path()
+    {
+        const char *path = std::getenv("CRYSTAL_TUNING_CACHE");
+        return path != nullptr ? std::string(path) : std::string("crystal_tuning.cache");
+    }
+
+    inline std::string tuning_device_name(const sycl::queue &q)
+    {
+        return q.get_device().get_info<sycl::info::device::name>();
+    }
+
+    /**
+     * @brief Whether --tune is among the command line arguments
+     */
+    inline bool tuning_requested(int argc, char **argv)
+    {
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--tune") == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Reads the tuned configuration of query on the device of q
+     *        from the cache; the cache holds one tab separated line
+     *        <device> <query> <block_threads> <items_per_thread> <ms>
+     *        per entry
+     * @return tile_config  the cached one, or fallback if none
+     */
+    inline tile_config load_tile_config(
+            const sycl::queue &q,
+            const std::string &query,
+            tile_config fallback = default_tile_config
+    )
+    {
+        std::ifstream cache(tuning_cache_path());
+        std::string device = tuning_device_name(q);
+        std::string line;
+        tile_config config = fallback;
+
+        while (std::getline(cache, line)) {
+            std::istringstream fields(line);
+            std::string entry_device, entry_query, bt, ipt;
+
+            if (std::getline(fields, entry_device, '\t') && std::getline(fields, entry_query, '\t') &&
+                std::getline(fields, bt, '\t') && std::getline(fields, ipt, '\t') &&
+                entry_device == device && entry_query == query) {
+                config = {std::atoi(bt.c_str()), std::atoi(ipt.c_str())};
+            }
+        }
+
+        return config;
+    }
+
+    /**
+     * @brief Stores config as the tuned configuration of query on the
+     *        device of q, replacing any previous entry
+     */
+    inline void save_tile_config(
+            const sycl::queue &q,
+            const std::string &query,
+            tile_config config,
+            double ms
+    )
+    {
+        std::string path = tuning_cache_path();
+        std::string prefix = tuning_device_name(q) + '\t' + query + '\t';
+        std::vector<std::string> lines;
+        std::string line;
+
+        std::ifstream in(path);
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.rfind(prefix, 0) != 0) {
+                lines.push_back(line);
+            }
+        }
+        in.close();
+
+        std::ostringstream entry;
+        entry << prefix << config.block_threads << '\t' << config.items_per_thread << '\t' << ms;
+        lines.push_back(entry.str());
+
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "[Error] Cannot write the tuning cache " << path << std::endl;
+            return;
+        }
+        for (const std::string &l : lines) {
+            out << l << '\n';
+        }
+    }
+
+    template <typename Launch, typename Shape>
+    inline bool dispatch_tile_shape(tile_config config, Launch &launch)
+    {
+        if (config.block_threads == Shape::block_threads &&
+            config.items_per_thread == Shape::items_per_thread) {
+            launch(Shape{});
+            return true;
+        }
+        return false;
+    }
+
+    template <typename Launch, typename... Shapes>
+    inline bool dispatch_tile_shapes(tile_config config, Launch &launch, std::tuple<Shapes...> *)
+    {
+        return (dispatch_tile_shape<Launch, Shapes>(config, launch) || ...);
+    }
+
+    /**
+     * @brief Runs launch with the tile_shape matching config. Unknown
+     *        configurations (e.g. from an older cache) run the default
+     */
+    template <typename Launch>
+    inline void dispatch_tile_config(tile_config config, Launch &&launch)
+    {
+        if (!dispatch_tile_shapes(config, launch, static_cast<tile_shapes *>(nullptr))) {
+            std::cerr << "[Error] No instantiation for tile <" << config.block_threads << ","
+                      << config.items_per_thread << ">, using the default" << std::endl;
+            dispatch_tile_shapes(default_tile_config, launch, static_cast<tile_shapes *>(nullptr));
+        }
+    }
+
+    // local memory of a launch that needs none
+    struct no_local_memory {
+        size_t operator()(tile_config) const { return 0; }
+    };
+
+    template <typename Launch, typename LocalBytes, typename... Shapes>
+    inline void time_tile_shapes(
+            const sycl::queue &q,
+            Launch &launch,
+            LocalBytes &local_bytes,
+            int trials,
+            tile_config &best,
+            double &best_ms,
+            std::tuple<Shapes...> *
+    )
+    {
+        size_t max_wg_size = q.get_device().get_info<sycl::info::device::max_work_group_size>();
+        size_t local_mem_size = q.get_device().get_info<sycl::info::device::local_mem_size>();
+
+        auto time_shape = [&](auto shape) {
+            using S = decltype(shape);
+            if (static_cast<size_t>(S::block_threads) > max_wg_size) {
+                return;
+            }
+            size_t bytes = local_bytes(tile_config{S::block_threads, S::items_per_thread});
+            if (bytes > local_mem_size) {
+                std::cout << "[tune] <" << S::block_threads << "," << S::items_per_thread << "> needs "
+                          << bytes << " bytes of local memory, the device has " << local_mem_size << std::endl;
+                return;
+            }
+
+            // the first run warms up (JIT compilation, page faults)
+            launch(shape);
+            double ms = std::numeric_limits<double>::max();
+            for (int t = 0; t < trials; t++) {
+                ms = std::min(ms, static_cast<double>(launch(shape)));
+            }
+
+            std::cout << "[tune] <" << S::block_threads << "," << S::items_per_thread << "> "
+                      << ms << " ms" << std::endl;
+            if (ms < best_ms) {
+                best = {S::block_threads, S::items_per_thread};
+                best_ms = ms;
+            }
+        };
+
+        (time_shape(Shapes{}), ...);
+    }
+
+    /**
+     * @brief Times launch on every tile shape the device supports
+     *        (best of trials runs after a warm-up run), stores the
+     *        fastest in the tuning cache and returns it
+     * @param local_bytes  bytes of local memory a work-group of the
+     *                     given shape allocates; shapes exceeding the
+     *                     local memory of the device are skipped
+     */
+    template <typename Launch, typename LocalBytes = no_local_memory>
+    inline tile_config autotune_tile_config(
+            const sycl::queue &q,
+            const std::string &query,
+            Launch &&launch,
+            LocalBytes local_bytes = LocalBytes(),
+            int trials = 3
+    )
+    {
+        tile_config best = default_tile_config;
+        double best_ms = std::numeric_limits<double>::max();
+
+        time_tile_shapes(q, launch, local_bytes, trials, best, best_ms, static_cast<tile_shapes *>(nullptr));
+
+        if (best_ms == std::numeric_limits<double>::max()) {
+            std::cerr << "[Error] No tile shape fits " << tuning_device_name(q) << std::endl;
+            return best;
+        }
+
+        std::cout << "[tune] " << query << " on " << tuning_device_name(q) << ": <"
+                  << best.block_threads << "," << best.items_per_thread << ">" << std::endl;
+        save_tile_config(q, query, best, best_ms);
+
+        return best;
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_AUTOTUNE_HPP
@@ -0,0 +1,121 @@
+#ifndef ONEAPI_CRYSTAL_CHUNK_STREAM_HPP
+#define ONEAPI_CRYSTAL_CHUNK_STREAM_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "mapped_column.hpp"
+
+namespace crystal {
+
+    /**
+     * @brief Streams num_items rows of host columns (typically mapped
+     *        with map_column) through the device in chunks of
+     *        chunk_items rows, so the columns never have to fit in
+     *        device memory. Two chunk buffers alternate: while the
+     *        device copies and processes chunk c, the host reads chunk
+     *        c + 1 from the mapped files (the page faults are the disk
+     *        reads) into a pinned staging buffer.
+     *
+     *        launch(chunk_columns, offset, num_chunk_items, deps) submits
+     *        the work of a chunk, depending on deps, and returns its
+     *        event; chunk_columns holds the device copies of the rows
+     *        [offset, offset + num_chunk_items) of columns.
+     *
+     *        Devices sharing the host address space process the columns
+     *        in place as a single chunk. Returns when every chunk is
+     *        processed
+     * @param deps  events the first launch must wait for (e.g. builds)
+     */
+    template <typename T, typename ChunkLaunch>
+    void stream_chunks(
+            sycl::queue &q,
+            const std::vector<T *> &columns,
+            int num_items,
+            int chunk_items,
+            const std::vector<sycl::event> &deps,
+            ChunkLaunch &&launch
+    )
+    {
+        if (num_items <= 0) {
+            return;
+        }
+
+        if (is_zero_copy(q)) {
+            launch(columns, size_t(0), num_items, deps).wait();
+            return;
+        }
+
+        int num_columns = static_cast<int>(columns.size());
+        chunk_items = std::max(1, std::min(chunk_items, num_items));
+        int num_chunks = (num_items + chunk_items - 1) / chunk_items;
+
+        try {
+            T *staging[2];
+            std::vector<T *> chunk[2];
+            std::vector<sycl::event> copied[2];
+            sycl::event computed[2];
+
+            for (int b = 0; b < 2; b++) {
+                staging[b] = malloc_host<T>(static_cast<size_t>(num_columns) * chunk_items, q);
+                for (int col = 0; col < num_columns; col++) {
+                    chunk[b].push_back(malloc_device<T>(chunk_items, q));
+                }
+            }
+
+            for (int c = 0; c < num_chunks; c++) {
+                int b = c & 1;
+                size_t offset = static_cast<size_t>(c) * chunk_items;
+                int len = static_cast<int>(std::min<size_t>(chunk_items, num_items - offset));
+
+                // the staging buffer is free once chunk c - 2 is copied
+                for (sycl::event &e : copied[b]) {
+                    e.wait();
+                }
+                copied[b].clear();
+
+                for (int col = 0; col < num_columns; col++) {
+                    std::memcpy(staging[b] + static_cast<size_t>(col) * chunk_items,
+                                columns[col] + offset, len * sizeof(T));
+                }
+
+                // the device buffers are free once chunk c - 2 is processed
+                std::vector<sycl::event> copy_deps = deps;
+                copy_deps.push_back(computed[b]);
+
+                for (int col = 0; col < num_columns; col++) {
+                    T *src = staging[b] + static_cast<size_t>(col) * chunk_items;
+                    T *dest = chunk[b][col];
+                    copied[b].push_back(q.submit([&](sycl::handler &h) {
+                        h.depends_on(copy_deps);
+                        h.memcpy(dest, src, len * sizeof(T));
+                    }));
+                }
+
+                computed[b] = launch(chunk[b], offset, len, copied[b]);
+            }
+
+            computed[0].wait();
+            computed[1].wait();
+
+            for (int b = 0; b < 2; b++) {
+                sycl::free(staging[b], q);
+                for (T *col : chunk[b]) {
+                    sycl::free(col, q);
+                }
+            }
+        }
+        catch (sycl::exception const &exc) {
+            std::cerr << exc.what() << "Exception caught at file:" << __FILE__
+                      << ", line:" << __LINE__ << std::endl;
+            std::exit(1);
+        }
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_CHUNK_STREAM_HPP
@@ -61,15 +61,22 @@ private:
 
 
 
-static void event_profiling(sycl::event &e, const std::string &msg) {
+/**
+ * @brief Device time of the command of e in ms, from start to end;
+ *        the queue of e needs the enable_profiling property
+ */
+static double event_elapsed(const sycl::event &e) {
     auto start = 
         e.get_profiling_info<sycl::info::event_profiling::command_start>();
     
     auto end = 
         e.get_profiling_info<sycl::info::event_profiling::command_end>();
     
-    double elapsed = (end - start) / 1E6;
-    std::cout << msg << elapsed << " ms\n";
+    return (end - start) / 1E6;
+}
+
+static void event_profiling(sycl::event &e, const std::string &msg) {
+    std::cout << msg << event_elapsed(e) << " ms\n";
 }
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef ONEAPI_CRYSTAL_EVENT_DAG_HPP
+#define ONEAPI_CRYSTAL_EVENT_DAG_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <utility>
+#include <vector>
+
+namespace crystal {
+
+    /**
+     * Asynchronous execution of a query as a DAG of SYCL events. Every
+     * command (memset, fill, copy or kernel) is submitted right away
+     * and returns its event; the edges are the events it depends on.
+     * Commands without a path between them, e.g. the memsets and builds
+     * of independent dimension tables, may run concurrently on an
+     * out-of-order queue, and the host synchronizes once with wait():
+     *
+     *     event_dag dag(q);
+     *     sycl::event zeroed = dag.memset(ht, 0, bytes);
+     *     sycl::event built = dag.submit({zeroed}, [&](sycl::handler &h) {
+     *         h.parallel_for<build>(...);
+     *     });
+     *     dag.memcpy(h_res, res, res_bytes, {built, ...});
+     *     dag.wait();
+     */
+    class event_dag {
+    public:
+        explicit event_dag(sycl::queue &q) : q_(q) {}
+
+        sycl::queue &queue() { return q_; }
+
+        /**
+         * @brief Submits the command group cgf once all of deps are done
+         * @return sycl::event  event of the command
+         */
+        template <typename CGF>
+        sycl::event submit(const std::vector<sycl::event> &deps, CGF &&cgf)
+        {
+            sycl::event e = q_.submit([&](sycl::handler &h) {
+                h.depends_on(deps);
+                cgf(h);
+            });
+            events_.push_back(e);
+            return e;
+        }
+
+        sycl::event memset(void *ptr, int value, size_t num_bytes, const std::vector<sycl::event> &deps = {})
+        {
+            return submit(deps, [&](sycl::handler &h) {
+                h.memset(ptr, value, num_bytes);
+            });
+        }
+
+        template <typename T>
+        sycl::event fill(T *ptr, const T &value, size_t count, const std::vector<sycl::event> &deps = {})
+        {
+            return submit(deps, [&](sycl::handler &h) {
+                h.fill(ptr, value, count);
+            });
+        }
+
+        sycl::event memcpy(void *dest, const void *src, size_t num_bytes, const std::vector<sycl::event> &deps = {})
+        {
+            return submit(deps, [&](sycl::handler &h) {
+                h.memcpy(dest, src, num_bytes);
+            });
+        }
+
+        /**
+         * @brief Waits for every command submitted through the DAG;
+         *        the DAG can be reused afterwards
+         */
+        void wait()
+        {
+            for (sycl::event &e : events_) {
+                e.wait();
+            }
+            events_.clear();
+        }
+
+    private:
+        sycl::queue &q_;
+        std::vector<sycl::event> events_;
+    };
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_EVENT_DAG_HPP
@@ -4,8 +4,11 @@
 
 #include <CL/sycl.hpp>
 #include <cstddef>
+#include <string>
 #include <utility>
 
+#include "autotune.hpp"
+
 
 namespace crystal {
 
@@ -20,9 +23,11 @@ namespace crystal {
      * 
      * @param q sycl::queue
      * @param job_size the size of the job in terms of blocks
+     * @param query the query whose tuned work-group size (see autotune.hpp)
+     *        bounds the work groups on a GPU, 64 if it has not been tuned
      * @return a kernel_config "object"
      */
-    inline kernel_config get_kernel_sizes(const sycl::queue &q, size_t job_size) {
+    inline kernel_config get_kernel_sizes(const sycl::queue &q, size_t job_size, const std::string &query = "") {
         kernel_config config{.wg_size= 1, .block= job_size};
         if (q.get_device().is_gpu()) {
             /**
@@ -30,7 +35,8 @@ namespace crystal {
              * We need to bound the value of `max_work_group_size` as it can be ANY 64-bit integer
              */
             config.wg_size = std::min(std::max(1ul, 2 * q.get_device().get_info<sycl::info::device::max_work_group_size>()), job_size);
-            config.wg_size = std::min(config.wg_size, 64ul); //TODO Find a better alternative than a hardcoded 64 ?
+            tile_config tuned = load_tile_config(q, query, {64, 1});
+            config.wg_size = std::min(config.wg_size, static_cast<size_t>(std::max(1, tuned.block_threads)));
             config.block = (job_size / config.wg_size) + (job_size % config.wg_size != 0);
         } else {
             /**
@@ -0,0 +1,139 @@
+#ifndef ONEAPI_CRYSTAL_MAPPED_COLUMN_HPP
+#define ONEAPI_CRYSTAL_MAPPED_COLUMN_HPP
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <CL/sycl.hpp>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "queue_helpers.hpp"
+
+namespace crystal {
+
+    /**
+     * @brief Maps a binary column file read-only into the address
+     *        space, pre-faulting the pages so the first kernel
+     *        touching the column does not pay for the page faults
+     * @tparam T            column type
+     * @param filename      path of the column file
+     * @param num_entries   number of entries of type T to map
+     * @return T*           mapped column or nullptr on failure
+     */
+    template <
+        typename T
+        >
+    T *map_column(
+        const std::string &filename,
+        size_t num_entries
+    )
+    {
+        size_t len = sizeof(T) * num_entries;
+#if defined(_WIN32)
+        // no mmap: fall back on a plain read
+        T* col = new T[num_entries];
+        std::ifstream colData (filename.c_str(), std::ios::in | std::ios::binary);
+        if (!colData) {
+            delete[] col;
+            return nullptr;
+        }
+
+        colData.read((char*)col, len);
+        return col;
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return nullptr;
+        }
+
+        // mapping past the end of the file would
+        // SIGBUS on the first access of the tail
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < len) {
+            close(fd);
+            return nullptr;
+        }
+
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        flags |= MAP_POPULATE;
+#endif
+        void *addr = mmap(nullptr, len, PROT_READ, flags, fd, 0);
+        // the mapping keeps its own reference to the file
+        close(fd);
+
+        if (addr == MAP_FAILED) {
+            return nullptr;
+        }
+
+        // columns are scanned front to back
+        madvise(addr, len, MADV_SEQUENTIAL);
+        madvise(addr, len, MADV_WILLNEED);
+        return (T*)addr;
+#endif
+    }
+
+    /**
+     * @brief Releases a column obtained from map_column
+     */
+    template <
+        typename T
+        >
+    void unmap_column(
+        T *col,
+        size_t num_entries
+    )
+    {
+        if (col == nullptr) return;
+#if defined(_WIN32)
+        delete[] col;
+#else
+        munmap((void*)col, sizeof(T) * num_entries);
+#endif
+    }
+
+    /**
+     * @brief Whether kernels submitted to q can dereference plain
+     *        host pointers, mapped files included (e.g. CPU devices)
+     */
+    inline bool is_zero_copy(const sycl::queue &q) {
+        sycl::device dev = q.get_device();
+        return dev.is_host() || dev.has(sycl::aspect::usm_system_allocations);
+    }
+
+    /**
+     * @brief Makes a mapped column visible to kernels submitted to q.
+     *        Devices sharing the host address space get the mapped
+     *        pages as they are, the others a device copy of them
+     * @tparam T            column type
+     * @param src           column returned by map_column
+     * @param size          number of entries
+     * @param q             queue the column is used from
+     * @return T*           pointer to be used inside kernels
+     */
+    template <
+        typename T
+        >
+    T *map_to_device (
+        T *src,
+        unsigned int size,
+        sycl::queue &q
+    )
+    {
+        if (is_zero_copy(q)) {
+            return src;
+        }
+
+        return load_to_device<T>(src, size, q);
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_MAPPED_COLUMN_HPP
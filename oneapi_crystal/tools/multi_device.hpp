@@ -0,0 +1,183 @@
+#ifndef ONEAPI_CRYSTAL_MULTI_DEVICE_HPP
+#define ONEAPI_CRYSTAL_MULTI_DEVICE_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "queue_helpers.hpp"
+
+namespace crystal {
+
+    /**
+     * @brief Working queues on every device of every platform, the
+     *        host device aside; falls back on the default device
+     *        when none is found. A physical device exposed by several
+     *        backends (e.g. an Intel GPU by Level Zero and OpenCL) must
+     *        only get one queue: per device type, only the devices of
+     *        one backend are kept, Level Zero if it has any
+     */
+    inline std::vector<sycl::queue> get_all_queues()
+    {
+        std::vector<sycl::queue> queues;
+        std::vector<sycl::device> devices = sycl::device::get_devices();
+
+        auto device_type = [](const sycl::device &dev) {
+            return dev.is_gpu() ? 0 : dev.is_cpu() ? 1 : dev.is_accelerator() ? 2 : -1;
+        };
+
+        for (int type = 0; type < 3; type++) {
+            bool found = false;
+            sycl::backend backend = sycl::backend::opencl;
+
+            for (const sycl::device &dev : devices) {
+                if (dev.is_host() || device_type(dev) != type) {
+                    continue;
+                }
+                if (!found || dev.get_backend() == sycl::backend::ext_oneapi_level_zero) {
+                    backend = dev.get_backend();
+                    found = true;
+                }
+            }
+
+            for (const sycl::device &dev : devices) {
+                if (!dev.is_host() && device_type(dev) == type && dev.get_backend() == backend) {
+                    queues.push_back(try_get_queue_with_dev(dev));
+                }
+            }
+        }
+
+        if (queues.empty()) {
+            queues.push_back(try_get_queue(sycl::default_selector{}));
+        }
+        return queues;
+    }
+
+    /**
+     * Runs a fact table scan split across several devices. Every
+     * device gets a contiguous range of whole tiles, sized after the
+     * throughput (rows per ms) it reached on its previous range, so
+     * the devices finish together from the second run on; the first
+     * run splits evenly. The ranges run concurrently, each driven by
+     * its own host thread:
+     *
+     *     multi_device_executor exec(get_all_queues());
+     *     exec.run(lo_len, tile_items, [&](int d, sycl::queue &q, int begin, int end) {
+     *         ... // build the tables on q, probe rows [begin, end)
+     *         return probe_ms;
+     *     });
+     *
+     * The throughput only accounts for the time run reports, i.e. the
+     * work that scales with the rows (the probe), not the fixed costs
+     * of the builds and copies.
+     *
+     * Anything the devices share (e.g. the dimension hash tables) is
+     * replicated by the caller, once per queue.
+     */
+    class multi_device_executor {
+    public:
+        explicit multi_device_executor(std::vector<sycl::queue> queues)
+            : queues_(std::move(queues)), throughput_(queues_.size(), 1.0) {}
+
+        int size() const { return static_cast<int>(queues_.size()); }
+
+        sycl::queue &queue(int d) { return queues_[d]; }
+
+        double throughput(int d) const { return throughput_[d]; }
+
+        /**
+         * @brief Ranges [begin, end) of num_items rows per device, cut
+         *        at multiples of tile_items and proportional to the
+         *        measured throughputs
+         */
+        std::vector<std::pair<int, int>> split(int num_items, int tile_items) const
+        {
+            int num_tiles = (num_items + tile_items - 1) / tile_items;
+            double total = 0;
+            for (double t : throughput_) {
+                total += t;
+            }
+
+            std::vector<std::pair<int, int>> ranges;
+            double share = 0;
+            int begin_tile = 0;
+
+            for (int d = 0; d < size(); d++) {
+                share += throughput_[d];
+                int end_tile = d == size() - 1
+                    ? num_tiles
+                    : std::min(num_tiles, static_cast<int>(std::llround(num_tiles * share / total)));
+
+                ranges.emplace_back(std::min(num_items, begin_tile * tile_items),
+                                    std::min(num_items, end_tile * tile_items));
+                begin_tile = end_tile;
+            }
+            return ranges;
+        }
+
+        /**
+         * @brief Calls run(d, queue(d), begin, end) for the range of
+         *        every device, concurrently, and updates the
+         *        throughputs from the times in ms it returns. run must
+         *        have finished its device work when it returns
+         */
+        template <typename Run>
+        void run(int num_items, int tile_items, Run &&run)
+        {
+            std::vector<std::pair<int, int>> ranges = split(num_items, tile_items);
+            std::vector<double> ms(size(), 0);
+            std::vector<std::thread> threads;
+
+            for (int d = 0; d < size(); d++) {
+                threads.emplace_back([&, d]() {
+                    int begin = ranges[d].first, end = ranges[d].second;
+                    if (begin == end) {
+                        return;
+                    }
+
+                    ms[d] = run(d, queues_[d], begin, end);
+                });
+            }
+
+            for (std::thread &t : threads) {
+                t.join();
+            }
+
+            // devices left without rows keep their last throughput
+            for (int d = 0; d < size(); d++) {
+                int rows = ranges[d].second - ranges[d].first;
+                if (rows > 0 && ms[d] > 0) {
+                    throughput_[d] = rows / ms[d];
+                }
+            }
+        }
+
+    private:
+        std::vector<sycl::queue> queues_;
+        std::vector<double> throughput_;
+    };
+
+    /**
+     * @brief Adds the groups of a partial result of one device to
+     *        groups, summing the aggregates of the keys found on
+     *        several devices
+     */
+    template <typename K>
+    inline void merge_groups(
+            std::map<K, long long> &groups,
+            const std::vector<std::pair<K, long long>> &partial
+    )
+    {
+        for (const std::pair<K, long long> &group : partial) {
+            groups[group.first] += group.second;
+        }
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_MULTI_DEVICE_HPP
@@ -21,9 +21,11 @@ namespace crystal {
      *        or retrieves the host device
      * @tparam T            selector type
      * @param selector      selector attempted to use
+     * @param props         queue properties, e.g. enable_profiling
      * @return sycl::queue  retrieved queue
      */
-    inline sycl::queue try_get_queue_with_dev(const sycl::device &in_dev){
+    inline sycl::queue try_get_queue_with_dev(const sycl::device &in_dev,
+                                              const sycl::property_list &props = {}){
             // exception handler to be used inside 
         auto exception_handler = [](const sycl::exception_list &exceptions){
             for (std::exception_ptr const &e : exceptions) {
@@ -44,7 +46,7 @@ namespace crystal {
 
         try {
             dev = in_dev;
-            q = sycl::queue(dev, exception_handler);
+            q = sycl::queue(dev, exception_handler, props);
 
             try {
                 // test queue is indeed working
@@ -54,7 +56,7 @@ namespace crystal {
 
             } catch(...){
                 dev = sycl::device(sycl::host_selector());
-                q = sycl::queue(dev, exception_handler);
+                q = sycl::queue(dev, exception_handler, props);
                 std::cerr << "[Warning] " << dev.get_info<sycl::info::device::name>()
                         << " found but not working! Fall back on "
                         << dev.get_info<sycl::info::device::name>() << '\n';
@@ -62,7 +64,7 @@ namespace crystal {
             
         } catch (...) {
         dev = sycl::device(sycl::host_selector());
-        q = sycl::queue(dev, exception_handler);
+        q = sycl::queue(dev, exception_handler, props);
 
         std::cerr << "[Warning] Expected device not found! Fall back on: " 
                     << dev.get_info<sycl::info::device::name>() << '\n';
@@ -77,12 +79,13 @@ namespace crystal {
      *        or retrieves the host device
      * @tparam T            selector type
      * @param selector      selector attempted to use
+     * @param props         queue properties, e.g. enable_profiling
      * @return sycl::queue  retrieved queue
      */
     template<
         typename T
         >
-    inline sycl::queue try_get_queue(const T & selector) {
+    inline sycl::queue try_get_queue(const T & selector, const sycl::property_list &props = {}) {
         // TODO: consider replacing this with a C++20 concept
         static_assert(
             std::is_base_of<sycl::device_selector, T>::value,
@@ -100,7 +103,7 @@ namespace crystal {
                     << dev.get_info<sycl::info::device::name>() << '\n';
         }
 
-        return try_get_queue_with_dev(dev);
+        return try_get_queue_with_dev(dev, props);
     }
 
 
@@ -0,0 +1,207 @@
+#ifndef ONEAPI_CRYSTAL_USM_POOL_HPP
+#define ONEAPI_CRYSTAL_USM_POOL_HPP
+#pragma once
+
+#include <CL/sycl.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace crystal {
+
+    struct usm_pool_stats {
+        size_t hits = 0;            // allocations served from a free list
+        size_t misses = 0;          // allocations that went to the device
+        size_t bytes_in_use = 0;    // handed out and not yet returned
+        size_t peak_bytes_in_use = 0;
+        size_t bytes_reserved = 0;  // device memory held, cached blocks included
+        size_t peak_bytes_reserved = 0;
+    };
+
+    /**
+     * Pool of device USM blocks for the scratch structures queries
+     * allocate on every run (hash tables, result tables, counters).
+     * Requests are rounded up to a size class, from 256 bytes, with
+     * four classes per power of two (256, 320, 384, 448, 512, 640...)
+     * so that a block wastes less than a quarter of its size; a
+     * returned block goes to the free list of its class and serves
+     * the next request of that class, so repeated runs stop calling
+     * malloc_device / sycl::free. Blocks are aligned to a 64 byte
+     * cache line, as the bucketed hash tables expect, and not zeroed.
+     * A block must only be returned once the device is done with it.
+     */
+    class usm_pool {
+    public:
+        explicit usm_pool(const sycl::queue &q) : q_(q) {}
+
+        usm_pool(const usm_pool &) = delete;
+        usm_pool &operator=(const usm_pool &) = delete;
+
+        ~usm_pool() { release(); }
+
+        const sycl::queue &queue() const { return q_; }
+
+        /**
+         * @brief A device block of at least num_bytes bytes. Throws a
+         *        sycl::exception (errc::memory_allocation) if the device
+         *        is out of memory even once the cached blocks are
+         *        released, to be handled as the other SYCL errors
+         */
+        void *allocate(size_t num_bytes)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            int size_class = get_size_class(num_bytes);
+            size_t block_bytes = get_class_bytes(size_class);
+            void *ptr = nullptr;
+
+            if (size_class < static_cast<int>(free_lists_.size()) && !free_lists_[size_class].empty()) {
+                ptr = free_lists_[size_class].back();
+                free_lists_[size_class].pop_back();
+                stats_.hits++;
+            } else {
+                ptr = sycl::aligned_alloc_device(block_alignment, block_bytes, q_);
+                if (ptr == nullptr) {
+                    // the cached blocks of the other classes may make room
+                    release_cached();
+                    ptr = sycl::aligned_alloc_device(block_alignment, block_bytes, q_);
+                }
+                if (ptr == nullptr) {
+                    throw sycl::exception(sycl::make_error_code(sycl::errc::memory_allocation),
+                                          "usm_pool: cannot allocate " + std::to_string(block_bytes) + " bytes");
+                }
+
+                stats_.misses++;
+                stats_.bytes_reserved += block_bytes;
+                stats_.peak_bytes_reserved = std::max(stats_.peak_bytes_reserved, stats_.bytes_reserved);
+            }
+
+            live_[ptr] = size_class;
+            stats_.bytes_in_use += block_bytes;
+            stats_.peak_bytes_in_use = std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+            return ptr;
+        }
+
+        template <typename T>
+        T *allocate(size_t count)
+        {
+            return static_cast<T *>(allocate(count * sizeof(T)));
+        }
+
+        /**
+         * @brief Returns a block obtained from allocate to its free list
+         */
+        void deallocate(void *ptr)
+        {
+            if (ptr == nullptr) return;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = live_.find(ptr);
+            if (it == live_.end()) {
+                std::cerr << "[Error] " << ptr << " was not allocated from this pool" << std::endl;
+                return;
+            }
+
+            int size_class = it->second;
+            live_.erase(it);
+
+            if (size_class >= static_cast<int>(free_lists_.size())) {
+                free_lists_.resize(size_class + 1);
+            }
+            free_lists_[size_class].push_back(ptr);
+            stats_.bytes_in_use -= get_class_bytes(size_class);
+        }
+
+        /**
+         * @brief Frees the cached blocks; blocks in use stay valid
+         */
+        void release()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            release_cached();
+        }
+
+        usm_pool_stats stats() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return stats_;
+        }
+
+        void print_stats(std::ostream &os) const
+        {
+            usm_pool_stats s = stats();
+            os << "{"
+               << "\"pool_hits\":" << s.hits
+               << ",\"pool_misses\":" << s.misses
+               << ",\"pool_peak_in_use\":" << s.peak_bytes_in_use
+               << ",\"pool_peak_reserved\":" << s.peak_bytes_reserved
+               << ",\"pool_reserved\":" << s.bytes_reserved
+               << "}" << std::endl;
+        }
+
+    private:
+        static constexpr size_t min_block_bytes = 256;
+        static constexpr size_t block_alignment = 64;
+        static constexpr int classes_per_octave = 4;
+
+        static int get_size_class(size_t num_bytes)
+        {
+            int size_class = 0;
+            while (get_class_bytes(size_class) < num_bytes) {
+                size_class++;
+            }
+            return size_class;
+        }
+
+        static size_t get_class_bytes(int size_class)
+        {
+            size_t octave_bytes = min_block_bytes << (size_class / classes_per_octave);
+            return octave_bytes + octave_bytes / classes_per_octave * (size_class % classes_per_octave);
+        }
+
+        void release_cached()
+        {
+            for (size_t size_class = 0; size_class < free_lists_.size(); size_class++) {
+                for (void *ptr : free_lists_[size_class]) {
+                    sycl::free(ptr, q_);
+                    stats_.bytes_reserved -= get_class_bytes(static_cast<int>(size_class));
+                }
+                free_lists_[size_class].clear();
+            }
+        }
+
+        sycl::queue q_;
+        mutable std::mutex mutex_;
+        std::vector<std::vector<void *>> free_lists_;
+        std::unordered_map<void *, int> live_;
+        usm_pool_stats stats_;
+    };
+
+    /**
+     * @brief The pool (arena) of queue q, created on first use. The
+     *        pools live until the end of the program, their cached
+     *        blocks are then reclaimed with the device context
+     */
+    inline usm_pool &get_usm_pool(const sycl::queue &q)
+    {
+        static std::mutex pools_mutex;
+        static auto *pools = new std::vector<std::unique_ptr<usm_pool>>();
+
+        std::lock_guard<std::mutex> lock(pools_mutex);
+        for (const std::unique_ptr<usm_pool> &pool : *pools) {
+            if (pool->queue() == q) {
+                return *pool;
+            }
+        }
+
+        pools->push_back(std::make_unique<usm_pool>(q));
+        return *pools->back();
+    }
+
+} // namespace crystal
+
+#endif //ONEAPI_CRYSTAL_USM_POOL_HPP
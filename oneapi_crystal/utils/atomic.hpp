@@ -56,5 +56,76 @@ static inline T atomicAddLocal(T& val, const T delta)
   return ref.fetch_add(delta);
 }
 
+/**
+ * @brief Sycl version of the atomicOr function 
+ *        natively existing in cuda
+ *        Performs an atomic bitwise or.
+
+ * @returns the old value
+ */
+template<typename T, sycl::memory_scope MemoryScope = sycl::memory_scope::device>
+static inline T atomicOr(T& val, const T bits)
+{
+  sycl::atomic_ref<T, sycl::memory_order::relaxed, 
+     MemoryScope, sycl::access::address_space::global_space> ref(val);
+  return ref.fetch_or(bits);
+}
+
+/**
+ * @brief Sycl version of the atomicMin function 
+ *        natively existing in cuda
+ *        Performs an atomic minimum.
+
+ * @returns the old value
+ */
+template<typename T, sycl::memory_scope MemoryScope = sycl::memory_scope::device>
+static inline T atomicMin(T& val, const T operand)
+{
+  sycl::atomic_ref<T, sycl::memory_order::relaxed, 
+     MemoryScope, sycl::access::address_space::global_space> ref(val);
+  return ref.fetch_min(operand);
+}
+
+/**
+ * @brief Sycl version of the atomicMax function 
+ *        natively existing in cuda
+ *        Performs an atomic maximum.
+
+ * @returns the old value
+ */
+template<typename T, sycl::memory_scope MemoryScope = sycl::memory_scope::device>
+static inline T atomicMax(T& val, const T operand)
+{
+  sycl::atomic_ref<T, sycl::memory_order::relaxed, 
+     MemoryScope, sycl::access::address_space::global_space> ref(val);
+  return ref.fetch_max(operand);
+}
+
+/**
+ * @brief atomicMin in the local space.
+
+ * @returns the old value
+ */
+template<typename T, sycl::memory_scope MemoryScope = sycl::memory_scope::work_group>
+static inline T atomicMinLocal(T& val, const T operand)
+{
+  sycl::atomic_ref<T, sycl::memory_order::relaxed, 
+     MemoryScope, sycl::access::address_space::local_space> ref(val);
+  return ref.fetch_min(operand);
+}
+
+/**
+ * @brief atomicMax in the local space.
+
+ * @returns the old value
+ */
+template<typename T, sycl::memory_scope MemoryScope = sycl::memory_scope::work_group>
+static inline T atomicMaxLocal(T& val, const T operand)
+{
+  sycl::atomic_ref<T, sycl::memory_order::relaxed, 
+     MemoryScope, sycl::access::address_space::local_space> ref(val);
+  return ref.fetch_max(operand);
+}
+
 
 #endif // ONEAPI_CRYSTAL_SYCL_UTILS
\ No newline at end of file
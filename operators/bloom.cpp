@@ -0,0 +1,290 @@
+#include <CL/sycl.hpp>
+#include <iostream>
+#include <stdio.h>
+
+#include <oneapi/mkl.hpp>
+#include <oneapi_crystal/crystal.hpp>
+
+#include "generator.h"
+#include "../oneapi_crystal/utils/atomic.hpp"
+#include "../oneapi_crystal/tools/queue_helpers.hpp"
+
+#include <chrono>
+
+
+#define TILE_SIZE (block_threads * items_per_thread)
+
+#define NUM_BLOCK_THREAD 128
+#define NUM_ITEM_PER_THREAD 4
+
+using namespace crystal;
+using namespace std;
+
+// struct to trace time elapsed
+// during operator execution
+struct TimeKeeper {
+  float time_build;
+  float time_probe_direct;
+  float time_probe_bloom;
+};
+
+template <int block_threads, int items_per_thread>
+void build_kernel(
+    int *dim_filter,
+    int *dim_key,
+    int num_tuples,
+    int selectivity,
+    int *hash_table,
+    int num_slots,
+    uint32_t *filter,
+    int filter_len,
+    sycl::nd_item<1> item_ct1
+)
+{
+  int items[items_per_thread];
+  int selection_flags[items_per_thread];
+
+  int tile_offset = item_ct1.get_group(0) * TILE_SIZE;
+  int num_tiles = (num_tuples + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item_ct1.get_group(0) == num_tiles - 1) {
+    num_tile_items = num_tuples - tile_offset;
+  }
+
+  load<int, block_threads, items_per_thread>(dim_filter + tile_offset, items, num_tile_items, item_ct1);
+  predicate_lt<int, block_threads, items_per_thread>(items, selectivity, selection_flags, num_tile_items, item_ct1);
+
+  load<int, block_threads, items_per_thread>(dim_key + tile_offset, items, num_tile_items, item_ct1);
+  build_selective_1<int, block_threads, items_per_thread>(items, selection_flags,
+      hash_table, num_slots, num_tile_items, item_ct1);
+  build_bloom<int, block_threads, items_per_thread>(items, selection_flags,
+      filter, filter_len, num_tile_items, item_ct1);
+}
+
+template <int block_threads, int items_per_thread, bool use_bloom>
+void probe_kernel(
+    int *fact_fkey,
+    int num_tuples,
+    int *hash_table,
+    int num_slots,
+    uint32_t *filter,
+    int filter_len,
+    unsigned long long *res,
+    sycl::nd_item<1> item_ct1
+)
+{
+  int items[items_per_thread];
+  int selection_flags[items_per_thread];
+
+  unsigned long long count = 0;
+
+  int tile_offset = item_ct1.get_group(0) * TILE_SIZE;
+  int num_tiles = (num_tuples + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item_ct1.get_group(0) == num_tiles - 1) {
+    num_tile_items = num_tuples - tile_offset;
+  }
+
+  init_flags<block_threads, items_per_thread>(selection_flags);
+  load<int, block_threads, items_per_thread>(fact_fkey + tile_offset, items, num_tile_items, item_ct1);
+
+  if (use_bloom) {
+    probe_bloom<int, block_threads, items_per_thread>(items, selection_flags,
+        filter, filter_len, num_tile_items, item_ct1);
+  }
+  probe_1<int, block_threads, items_per_thread>(items, selection_flags,
+      hash_table, num_slots, num_tile_items, item_ct1);
+
+  #pragma unroll
+  for (int i = 0; i < items_per_thread; ++i)
+  {
+    if ((item_ct1.get_local_id(0) + (block_threads * i) < num_tile_items))
+      if (selection_flags[i])
+        count++;
+  }
+
+  unsigned long long aggregate =
+        sycl::reduce_over_group(item_ct1.get_group(), count, sycl::plus<>());
+
+  if (item_ct1.get_local_id(0) == 0) {
+      atomicAdd(*res, aggregate);
+  }
+}
+
+template <bool use_bloom>
+float semi_join_probe(
+    sycl::queue &q,
+    int *d_fact_fkey,
+    int num_fact,
+    int *hash_table,
+    int num_slots,
+    uint32_t *filter,
+    int filter_len,
+    unsigned long long *res
+)
+{
+  int tile_items = NUM_BLOCK_THREAD * NUM_ITEM_PER_THREAD;
+
+  q.memset(res, 0, sizeof(long long)).wait();
+
+  chrono::high_resolution_clock::time_point st, finish;
+  // begin time measurement
+  st = chrono::high_resolution_clock::now();
+
+  q.submit([&](sycl::handler &cgh) {
+    size_t local_range_size = NUM_BLOCK_THREAD;
+    size_t num_groups = static_cast<size_t>(num_fact + tile_items - 1) / tile_items;
+    size_t global_range_size = local_range_size * num_groups;
+
+    cgh.parallel_for(
+      sycl::nd_range<1>(global_range_size, local_range_size),
+        [=](sycl::nd_item<1> item_ct1)  {
+            probe_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD, use_bloom>(
+              d_fact_fkey, num_fact, hash_table, num_slots, filter, filter_len, res, item_ct1);
+    });
+  }).wait();
+
+  finish = chrono::high_resolution_clock::now();
+  unsigned long long h_res;
+
+  q.memcpy(&h_res, res, sizeof(long long)).wait();
+
+  std::cout << (use_bloom ? "BLOOM" : "DIRECT") << " MATCHES: " << h_res << std::endl;
+
+  return std::chrono::duration<double>(finish - st).count() * 1000.;
+}
+
+TimeKeeper semi_join(
+    sycl::queue &q,
+    int *d_dim_filter,
+    int *d_dim_key,
+    int *d_fact_fkey,
+    int num_dim,
+    int num_fact,
+    int selectivity
+)
+{
+  unsigned long long* res;
+  int* hash_table = nullptr;
+  uint32_t* filter = nullptr;
+  int num_slots = num_dim;
+  int filter_len = get_bloom_len(num_dim * selectivity / 100);
+  int tile_items = NUM_BLOCK_THREAD * NUM_ITEM_PER_THREAD;
+
+  hash_table = (int*)malloc_device(sizeof(int) * num_slots, q);
+  filter = (uint32_t*)malloc_device(sizeof(uint32_t) * filter_len, q);
+  res = (unsigned long long*)malloc_device(sizeof(long long), q);
+
+  q.memset(hash_table, 0, sizeof(int) * num_slots).wait();
+  q.memset(filter, 0, sizeof(uint32_t) * filter_len).wait();
+
+  chrono::high_resolution_clock::time_point st, finish;
+  st = chrono::high_resolution_clock::now();
+
+  q.submit([&](sycl::handler &cgh) {
+    size_t local_range_size = NUM_BLOCK_THREAD;
+    size_t num_groups = static_cast<size_t>(num_dim + tile_items - 1) / tile_items;
+    size_t global_range_size= local_range_size * num_groups;
+
+    cgh.parallel_for<class build>(
+        sycl::nd_range<1>(global_range_size, local_range_size),
+          [=](sycl::nd_item<1> item_ct1) {
+            build_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(
+              d_dim_filter, d_dim_key, num_dim, selectivity, hash_table, num_slots,
+              filter, filter_len, item_ct1);
+    });
+  }).wait();
+
+  finish = chrono::high_resolution_clock::now();
+
+  TimeKeeper t;
+  t.time_build = std::chrono::duration<double>(finish - st).count() * 1000.;
+  t.time_probe_direct = semi_join_probe<false>(q, d_fact_fkey, num_fact,
+      hash_table, num_slots, filter, filter_len, res);
+  t.time_probe_bloom = semi_join_probe<true>(q, d_fact_fkey, num_fact,
+      hash_table, num_slots, filter, filter_len, res);
+
+  sycl::free(hash_table, q);
+  sycl::free(filter, q);
+  sycl::free(res, q);
+
+  return t;
+}
+
+
+
+//---------------------------------------------------------------------
+// Main
+//---------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+  auto q = try_get_queue(sycl::default_selector{});
+
+  std::cout<<"Running on "
+          << q.get_device().get_info<sycl::info::device::name>()
+          <<std::endl;
+
+
+  int num_fact           = 256 * 1<<20;
+  int num_dim            = 16 * 1<<20;
+  int selectivity        = 10;
+  int num_trials         = 3;
+
+  // Initialize command line
+  if(argc > 1) {
+      num_dim = atoi(argv[1]);
+  }
+
+  // percentage of dimension rows passing the filter
+  if(argc > 2) {
+      selectivity = atoi(argv[2]);
+  }
+
+  int *d_dim_filter = (int*) malloc_device(sizeof(int) * num_dim, q);
+  int *d_dim_key = (int*) malloc_device(sizeof(int) * num_dim, q);
+  int *d_fact_fkey = (int*) malloc_device(sizeof(int) * num_fact, q);
+
+  int *h_dim_key = nullptr;
+  int *h_dim_val = nullptr;
+  int *h_fact_fkey = nullptr;
+  int *h_fact_val = nullptr;
+
+  create_relation_pk(h_dim_key, h_dim_val, num_dim);
+  create_relation_fk(h_fact_fkey, h_fact_val, num_fact, num_dim);
+
+  // filter column, uniform in [0, 100)
+  int *h_dim_filter = (int*)_mm_malloc(num_dim * sizeof(int), 256);
+  for (int i = 0; i < num_dim; i++) {
+    h_dim_filter[i] = RAND_RANGE(100);
+  }
+
+  q.memcpy(d_dim_filter, h_dim_filter, sizeof(int) * num_dim).wait();
+  q.memcpy(d_dim_key, h_dim_key, sizeof(int) * num_dim).wait();
+  q.memcpy(d_fact_fkey, h_fact_fkey, sizeof(int) * num_fact).wait();
+
+  for (int j = 0; j < num_trials; j++) {
+    TimeKeeper t = semi_join(q, d_dim_filter, d_dim_key, d_fact_fkey, num_dim, num_fact, selectivity);
+    cout<< "{"
+        << "\"num_dim\":" << num_dim
+        << ",\"num_fact\":" << num_fact
+        << ",\"selectivity\":" << selectivity
+        << ",\"time_build\":" << t.time_build << " ms"
+        << ",\"time_probe_direct\":" << t.time_probe_direct << " ms"
+        << ",\"time_probe_bloom\":" << t.time_probe_bloom << " ms"
+        << "}" << endl;
+  }
+
+  sycl::free(d_dim_filter, q);
+  sycl::free(d_dim_key, q);
+  sycl::free(d_fact_fkey, q);
+
+  _mm_free(h_dim_filter);
+  _mm_free(h_dim_key);
+  _mm_free(h_dim_val);
+  _mm_free(h_fact_fkey);
+  _mm_free(h_fact_val);
+
+  return 0;
+}
@@ -8,6 +8,9 @@
 #include "generator.h"
 #include "../oneapi_crystal/utils/atomic.hpp"
 #include "../oneapi_crystal/tools/queue_helpers.hpp"
+#include "../oneapi_crystal/tools/event_dag.hpp"
+#include "../oneapi_crystal/tools/usm_pool.hpp"
+#include "../oneapi_crystal/tools/duration_logger.hpp"
 
 #include <chrono>
 
@@ -17,6 +20,11 @@
 #define NUM_BLOCK_THREAD 128
 #define NUM_ITEM_PER_THREAD 4
 
+// radix bits handled by a single partitioning pass (its fanout
+// bounds the local histograms) and in total
+#define NUM_RADIX_BITS_PER_PASS 6
+#define MAX_RADIX_BITS 12
+
 using namespace crystal;
 using namespace std;
 
@@ -27,9 +35,31 @@ struct TimeKeeper {
   float time_probe;
   float time_extra;
   float time_total;
+  float time_partition_build;
+  float time_partition_probe;
 };
 
-template <int block_threads, int items_per_thread>
+// hash table of the non partitioned join: Crystal's direct mapped
+// table (one slot per dimension key), linear probing at load factor
+// 0.5, or cache line buckets of bucket_size keys at load factor 0.75
+enum class HashTable { direct, linear, bucketed };
+
+inline const char *hash_table_name(HashTable table) {
+  return table == HashTable::direct ? "direct" : table == HashTable::linear ? "linear" : "bucketed";
+}
+
+// slots of the table for num_dim keys, each slot a (key, value) pair
+inline int get_ht_slots(HashTable table, int num_dim) {
+  if (table == HashTable::linear) {
+    return get_linear_ht_len(num_dim);
+  }
+  if (table == HashTable::bucketed) {
+    return get_bucketed_ht_len(num_dim) * bucket_size;
+  }
+  return num_dim;
+}
+
+template <HashTable table, int block_threads, int items_per_thread>
 void build_kernel(
     int *dim_key, 
     int *dim_val, 
@@ -54,11 +84,19 @@ void build_kernel(
   init_flags<block_threads, items_per_thread>(selection_flags);
   load<int, block_threads, items_per_thread>(dim_key + tile_offset, items, num_tile_items, item_ct1);
   load<int, block_threads, items_per_thread>(dim_val + tile_offset, items2, num_tile_items, item_ct1);
-  build_selective_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags, 
-      hash_table, num_slots, num_tile_items, item_ct1);
+  if constexpr (table == HashTable::linear) {
+    build_selective_linear_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags,
+        hash_table, num_slots, num_tile_items, item_ct1);
+  } else if constexpr (table == HashTable::bucketed) {
+    build_bucketed<int, int, block_threads, items_per_thread>(items, items2, selection_flags,
+        hash_table, num_slots / bucket_size, num_tile_items, item_ct1);
+  } else {
+    build_selective_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags, 
+        hash_table, num_slots, num_tile_items, item_ct1);
+  }
 }
 
-template<int block_threads, int items_per_thread>
+template<HashTable table, int block_threads, int items_per_thread>
 void probe_kernel(
     int *fact_fkey, 
     int *fact_val, 
@@ -89,8 +127,16 @@ void probe_kernel(
   load<int, block_threads, items_per_thread>(fact_fkey + tile_offset, keys, num_tile_items, item_ct1);
   load<int, block_threads, items_per_thread>(fact_val + tile_offset, vals, num_tile_items, item_ct1);
 
-  probe_2<int, int, block_threads, items_per_thread>(keys, join_vals, selection_flags,
-      hash_table, num_slots, num_tile_items, item_ct1);
+  if constexpr (table == HashTable::linear) {
+    probe_linear_2<int, int, block_threads, items_per_thread>(keys, join_vals, selection_flags,
+        hash_table, num_slots, num_tile_items, item_ct1);
+  } else if constexpr (table == HashTable::bucketed) {
+    probe_bucketed<int, int, block_threads, items_per_thread>(keys, join_vals, selection_flags,
+        hash_table, num_slots / bucket_size, num_tile_items, item_ct1);
+  } else {
+    probe_2<int, int, block_threads, items_per_thread>(keys, join_vals, selection_flags,
+        hash_table, num_slots, num_tile_items, item_ct1);
+  }
 
   #pragma unroll
   for (int i = 0; i < items_per_thread; ++i)
@@ -108,7 +154,234 @@ void probe_kernel(
   }
 }
 
+/**
+ * @brief Tile of the work-group in a partitioning pass. Each partition
+ *        of the previous pass (parent) is cut into its own tiles, numbered
+ *        one parent after the other from tile_starts (see plan_tiles_kernel),
+ *        so that a tile never spans two parents.
+ * @return false for the trailing work-groups left without a tile
+ */
+template <int block_threads, int items_per_thread>
+inline bool parent_tile(
+    const int *parent_offsets,
+    const int *tile_starts,
+    int num_parents,
+    int &parent,
+    int &tile_offset,
+    int &num_tile_items,
+    sycl::nd_item<1> item_ct1
+)
+{
+  int tile = item_ct1.get_group(0);
+  if (tile >= tile_starts[num_parents]) {
+    return false;
+  }
+
+  // last parent starting at or before the tile: the empty parents
+  // sharing its start own no tile and come first
+  int lo = 0, hi = num_parents - 1;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (tile_starts[mid] <= tile) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+
+  parent = lo;
+  tile_offset = parent_offsets[parent] + (tile - tile_starts[parent]) * TILE_SIZE;
+  num_tile_items = sycl::min(TILE_SIZE, parent_offsets[parent + 1] - tile_offset);
+  return true;
+}
+
+// number of tiles of every parent, scanned into tile_starts by a single work-group
+template <int block_threads, int items_per_thread>
+void plan_tiles_kernel(
+    const int *parent_offsets,
+    int num_parents,
+    int *tile_starts,
+    sycl::nd_item<1> item_ct1
+)
+{
+  for (int p = item_ct1.get_local_id(0); p < num_parents; p += block_threads) {
+    tile_starts[p] = (parent_offsets[p + 1] - parent_offsets[p] + TILE_SIZE - 1) / TILE_SIZE;
+  }
+  item_ct1.barrier(sycl::access::fence_space::global_space);
+
+  select_scan_tiles<block_threads, items_per_thread>(tile_starts, num_parents, item_ct1);
+}
+
+template <int block_threads, int items_per_thread>
+void histogram_kernel(
+    int *keys,
+    const int *parent_offsets,
+    const int *tile_starts,
+    int num_parents,
+    int shift,
+    int bits,
+    int *hist,
+    int *local_hist,
+    sycl::nd_item<1> item_ct1
+)
+{
+  int items[items_per_thread];
+  int selection_flags[items_per_thread];
+
+  int parent, tile_offset, num_tile_items;
+  if (!parent_tile<block_threads, items_per_thread>(parent_offsets, tile_starts, num_parents,
+        parent, tile_offset, num_tile_items, item_ct1)) {
+    return;
+  }
+
+  init_flags<block_threads, items_per_thread>(selection_flags);
+  load<int, block_threads, items_per_thread>(keys + tile_offset, items, num_tile_items, item_ct1);
+
+  // the children of the parent, one global atomic per child and work-group
+  block_histogram<int, RadixBin<int>, block_threads, items_per_thread>(items, selection_flags,
+      RadixBin<int>(shift, bits), local_hist, hist + (parent << bits), 1 << bits,
+      num_tile_items, item_ct1);
+}
+
+// exclusive scan of the child histogram by a single work-group,
+// giving the child boundaries in offsets and the scatter cursors
+template <int block_threads, int items_per_thread>
+void scan_partitions_kernel(
+    int *hist,
+    int num_parts,
+    int *offsets,
+    int *cursor,
+    sycl::nd_item<1> item_ct1
+)
+{
+  select_scan_tiles<block_threads, items_per_thread>(hist, num_parts, item_ct1);
+  item_ct1.barrier(sycl::access::fence_space::global_space);
+
+  for (int p = item_ct1.get_local_id(0); p <= num_parts; p += block_threads) {
+    offsets[p] = hist[p];
+    cursor[p] = hist[p];
+  }
+}
+
+template <int block_threads, int items_per_thread>
+void scatter_kernel(
+    int *keys,
+    int *vals,
+    const int *parent_offsets,
+    const int *tile_starts,
+    int num_parents,
+    int shift,
+    int bits,
+    int *cursor,
+    int *out_keys,
+    int *out_vals,
+    int *local_hist,
+    sycl::nd_item<1> item_ct1
+)
+{
+  int items[items_per_thread];
+  int items2[items_per_thread];
+  int pos[items_per_thread];
+
+  int tid = item_ct1.get_local_id(0);
+  int fanout = 1 << bits;
+  RadixBin<int> digit(shift, bits);
+
+  int parent, tile_offset, num_tile_items;
+  if (!parent_tile<block_threads, items_per_thread>(parent_offsets, tile_starts, num_parents,
+        parent, tile_offset, num_tile_items, item_ct1)) {
+    return;
+  }
+
+  int *child_cursor = cursor + (parent << bits);
+
+  for (int p = tid; p < fanout; p += block_threads) {
+    local_hist[p] = 0;
+  }
+  item_ct1.barrier(sycl::access::fence_space::local_space);
+
+  load<int, block_threads, items_per_thread>(keys + tile_offset, items, num_tile_items, item_ct1);
+  load<int, block_threads, items_per_thread>(vals + tile_offset, items2, num_tile_items, item_ct1);
+
+  // rank of each item within its child partition in this tile
+  #pragma unroll
+  for (int i = 0; i < items_per_thread; i++) {
+    if (tid + (i * block_threads) < num_tile_items) {
+      pos[i] = atomicAddLocal(local_hist[digit(items[i])], 1);
+    }
+  }
+  item_ct1.barrier(sycl::access::fence_space::local_space);
+
+  // reserve a contiguous range of each child partition for the tile
+  for (int p = tid; p < fanout; p += block_threads) {
+    if (local_hist[p] != 0) {
+      local_hist[p] = atomicAdd(child_cursor[p], local_hist[p]);
+    }
+  }
+  item_ct1.barrier(sycl::access::fence_space::local_space);
+
+  #pragma unroll
+  for (int i = 0; i < items_per_thread; i++) {
+    if (tid + (i * block_threads) < num_tile_items) {
+      int dst = local_hist[digit(items[i])] + pos[i];
+      out_keys[dst] = items[i];
+      out_vals[dst] = items2[i];
+    }
+  }
+}
+
+template <int block_threads>
+void partitioned_join_kernel(
+    int *dim_key,
+    int *dim_val,
+    int *dim_offsets,
+    int *fact_fkey,
+    int *fact_val,
+    int *fact_offsets,
+    int *ht,
+    int ht_len,
+    unsigned long long *res,
+    sycl::nd_item<1> item_ct1
+)
+{
+  int part = item_ct1.get_group(0);
+  int tid = item_ct1.get_local_id(0);
+
+  unsigned long long sum = 0;
+
+  for (int i = tid; i < 2 * ht_len; i += block_threads) {
+    ht[i] = 0;
+  }
+  item_ct1.barrier(sycl::access::fence_space::local_space);
+
+  // build the partition hash table in local memory
+  for (int i = dim_offsets[part] + tid; i < dim_offsets[part + 1]; i += block_threads) {
+    insert_linear_2<int, int, sycl::access::address_space::local_space>(
+        dim_key[i], dim_val[i], ht, ht_len);
+  }
+  item_ct1.barrier(sycl::access::fence_space::local_space);
+
+  // probe it with the matching fact partition
+  for (int i = fact_offsets[part] + tid; i < fact_offsets[part + 1]; i += block_threads) {
+    int join_val;
+    if (lookup_linear_2(fact_fkey[i], join_val, ht, ht_len)) {
+      sum += fact_val[i] * join_val;
+    }
+  }
+
+  unsigned long long aggregate =
+        sycl::reduce_over_group(item_ct1.get_group(), sum, sycl::plus<>());
+
+  if (tid == 0) {
+      atomicAdd(*res, aggregate);
+  }
+}
+
+template <HashTable table> class build_ht;
+template <HashTable table> class probe_ht;
 
+// the join result is returned in join_res
+template <HashTable table>
 TimeKeeper hash_join(
     sycl::queue &q,
     int *d_dim_key, 
@@ -116,80 +389,305 @@ TimeKeeper hash_join(
     int *d_fact_fkey,
     int *d_fact_val, 
     int num_dim, 
-    int num_fact
+    int num_fact,
+    unsigned long long &join_res
 ) 
 { 
   unsigned long long* res;
   int* hash_table = nullptr; 
-  int num_slots = num_dim;
+  int num_slots = get_ht_slots(table, num_dim);
   float time_build, time_probe, time_memset;
 
-  hash_table = (int*)malloc_device(sizeof(int)* 2 * num_dim, q);
-  res = (unsigned long long*)malloc_device(sizeof(long long), q);
+  // scratch structures come from the pool: only the first trial allocates
+  usm_pool &pool = get_usm_pool(q);
+  hash_table = (int*)pool.allocate(sizeof(int)* 2 * num_slots);
+  res = (unsigned long long*)pool.allocate(sizeof(long long));
   
   int tile_items = NUM_BLOCK_THREAD * NUM_ITEM_PER_THREAD;
 
-  chrono::high_resolution_clock::time_point st, mmset, build, finish;
+  chrono::high_resolution_clock::time_point st, finish;
   // begin time measurement
   st = chrono::high_resolution_clock::now();
 
-  q.memset(hash_table, 0, num_slots * sizeof(int) * 2).wait();
-  q.memset(res, 0, sizeof(long long)).wait();
+  // nothing waits before the result: the memset of res overlaps the
+  // build, so each phase is timed on the device from its event
+  event_dag dag(q);
+  sycl::event zeroed_ht = dag.memset(hash_table, 0, num_slots * sizeof(int) * 2);
+  sycl::event zeroed_res = dag.memset(res, 0, sizeof(long long));
   
-  mmset = chrono::high_resolution_clock::now();
-  q.submit([&](sycl::handler &cgh) {
+  sycl::event built = dag.submit({zeroed_ht}, [&](sycl::handler &cgh) {
     size_t local_range_size = NUM_BLOCK_THREAD;
     size_t num_groups = static_cast<size_t>(num_dim + tile_items - 1) / tile_items;
     size_t global_range_size= local_range_size * num_groups;
     
-    cgh.parallel_for<class build>(
+    cgh.parallel_for<build_ht<table>>(
         sycl::nd_range<1>(global_range_size, local_range_size),
           [=](sycl::nd_item<1> item_ct1) {
-            build_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(
+            build_kernel<table, NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(
               d_dim_key, d_dim_val, num_dim, hash_table, num_slots, item_ct1);
     });
   });
-  build = chrono::high_resolution_clock::now();
 
-  q.submit([&](sycl::handler &cgh) {
+  sycl::event probed = dag.submit({built, zeroed_res}, [&](sycl::handler &cgh) {
     size_t local_range_size = NUM_BLOCK_THREAD;
     size_t num_groups = static_cast<size_t>(num_fact + tile_items - 1) / tile_items;
     size_t global_range_size = local_range_size * num_groups;
     
-    cgh.parallel_for<class probe>(
+    cgh.parallel_for<probe_ht<table>>(
       sycl::nd_range<1>(global_range_size, local_range_size),
         [=](sycl::nd_item<1> item_ct1)  {
-            probe_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(
+            probe_kernel<table, NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(
               d_fact_fkey, d_fact_val, num_fact, hash_table, num_slots, res, item_ct1);
     });
-  }).wait();
+  });
 
-  finish = chrono::high_resolution_clock::now();
   unsigned long long h_res;
+  dag.memcpy(&h_res, res, sizeof(long long), {probed});
+  dag.wait();
 
-  q.memcpy(&h_res, res, sizeof(long long)).wait();
+  finish = chrono::high_resolution_clock::now();
 
   std::cout<<"JOIN RESULTS: "<< h_res << std::endl;
+  join_res = h_res;
 
-  sycl::free(hash_table, q);
-  sycl::free(res, q);
+  pool.deallocate(hash_table);
+  pool.deallocate(res);
 
-  time_memset = std::chrono::duration<double>(mmset - st).count() * 1000. ;
-  time_build = std::chrono::duration<double>(build - mmset).count() * 1000. ;
-  time_probe = std::chrono::duration<double>(finish - build).count() * 1000. ;
+  time_memset = event_elapsed(zeroed_ht) + event_elapsed(zeroed_res);
+  time_build = event_elapsed(built);
+  time_probe = event_elapsed(probed);
 
-  TimeKeeper t = {time_build, time_probe, time_memset, time_build + time_probe + time_memset};
+  // the phases overlap, the total is the wall clock time of the join
+  TimeKeeper t = {time_build, time_probe, time_memset,
+                  static_cast<float>(std::chrono::duration<double>(finish - st).count() * 1000.)};
   return t;
 }
 
 
+/**
+ * @brief Radix partitions a relation on the lowest radix_bits bits of
+ *        its keys, in passes of at most NUM_RADIX_BITS_PER_PASS bits.
+ *        Every pass splits each partition of the previous pass into
+ *        (1 << bits) children on the next bits of the key: the digit
+ *        of the first pass is the highest digit of the final partition
+ *        id, the digit of the last pass its lowest.
+ *        The partitioned relation is returned in out_keys / out_vals
+ *        (to be freed by the caller) and the boundaries of the
+ *        (1 << radix_bits) partitions in offsets.
+ */
+void radix_partition_relation(
+    sycl::queue &q,
+    int *keys,
+    int *vals,
+    int num_tuples,
+    int radix_bits,
+    int *&out_keys,
+    int *&out_vals,
+    int *offsets
+)
+{
+  int num_parts = 1 << radix_bits;
+  int tile_items = NUM_BLOCK_THREAD * NUM_ITEM_PER_THREAD;
+
+  usm_pool &pool = get_usm_pool(q);
+  int *hist = (int*)pool.allocate(sizeof(int) * (num_parts + 1));
+  int *cursor = (int*)pool.allocate(sizeof(int) * (num_parts + 1));
+  int *tile_starts = (int*)pool.allocate(sizeof(int) * (num_parts + 1));
+  int *part_offsets[2];
+  int *buf_keys[2], *buf_vals[2];
+
+  for (int b = 0; b < 2; b++) {
+    part_offsets[b] = (int*)pool.allocate(sizeof(int) * (num_parts + 1));
+    buf_keys[b] = (int*)pool.allocate(sizeof(int) * num_tuples);
+    buf_vals[b] = (int*)pool.allocate(sizeof(int) * num_tuples);
+  }
+
+  // the whole relation is the single parent of the first pass
+  int whole[2] = {0, num_tuples};
+
+  int *in_keys = keys, *in_vals = vals;
+  int *parent_offsets = part_offsets[1];
+  int pass = 0;
+
+  // the passes are chained through events, the host waits once at the end
+  event_dag dag(q);
+  sycl::event scattered = dag.memcpy(parent_offsets, whole, sizeof(whole));
+
+  for (int shift = 0; shift < radix_bits; shift += NUM_RADIX_BITS_PER_PASS, pass++) {
+    int bits = std::min(NUM_RADIX_BITS_PER_PASS, radix_bits - shift);
+    int num_parents = 1 << shift;
+    int pass_parts = num_parents << bits;
+    int *dst_keys = buf_keys[pass & 1], *dst_vals = buf_vals[pass & 1];
+    int *child_offsets = shift + bits == radix_bits ? offsets : part_offsets[pass & 1];
+
+    // each parent rounds its last tile up: at most one extra tile per parent
+    size_t num_groups = static_cast<size_t>(num_tuples + tile_items - 1) / tile_items + num_parents;
+    sycl::nd_range<1> range(num_groups * NUM_BLOCK_THREAD, NUM_BLOCK_THREAD);
+    sycl::nd_range<1> single_group(NUM_BLOCK_THREAD, NUM_BLOCK_THREAD);
+
+    // hist, cursor and tile_starts are reused: the previous scatter must be done
+    sycl::event zeroed = dag.memset(hist, 0, sizeof(int) * pass_parts, {scattered});
+
+    sycl::event planned = dag.submit({scattered}, [&](sycl::handler &cgh) {
+      cgh.parallel_for<class plan_tiles>(single_group, [=](sycl::nd_item<1> item_ct1) {
+        plan_tiles_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(
+          parent_offsets, num_parents, tile_starts, item_ct1);
+      });
+    });
+
+    sycl::event counted = dag.submit({zeroed, planned}, [&](sycl::handler &cgh) {
+      sycl::local_accessor<int, 1> local_hist(sycl::range<1>(1 << bits), cgh);
+
+      cgh.parallel_for<class histogram>(range, [=](sycl::nd_item<1> item_ct1) {
+        histogram_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(
+          in_keys, parent_offsets, tile_starts, num_parents, shift, bits,
+          hist, local_hist.get_pointer(), item_ct1);
+      });
+    });
+
+    sycl::event summed = dag.submit({counted}, [&](sycl::handler &cgh) {
+      cgh.parallel_for<class scan_partitions>(single_group, [=](sycl::nd_item<1> item_ct1) {
+        scan_partitions_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(
+          hist, pass_parts, child_offsets, cursor, item_ct1);
+      });
+    });
+
+    scattered = dag.submit({summed}, [&](sycl::handler &cgh) {
+      sycl::local_accessor<int, 1> local_hist(sycl::range<1>(1 << bits), cgh);
+
+      cgh.parallel_for<class scatter>(range, [=](sycl::nd_item<1> item_ct1) {
+        scatter_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(
+          in_keys, in_vals, parent_offsets, tile_starts, num_parents, shift, bits, cursor,
+          dst_keys, dst_vals, local_hist.get_pointer(), item_ct1);
+      });
+    });
+
+    in_keys = dst_keys;
+    in_vals = dst_vals;
+    parent_offsets = child_offsets;
+  }
+
+  out_keys = in_keys;
+  out_vals = in_vals;
+  dag.wait();
+
+  // the buffer written by the second to last pass is not needed anymore
+  pool.deallocate(buf_keys[pass & 1]);
+  pool.deallocate(buf_vals[pass & 1]);
+  for (int b = 0; b < 2; b++) {
+    pool.deallocate(part_offsets[b]);
+  }
+  pool.deallocate(hist);
+  pool.deallocate(cursor);
+  pool.deallocate(tile_starts);
+}
+
+TimeKeeper radix_hash_join(
+    sycl::queue &q,
+    int *d_dim_key,
+    int *d_dim_val,
+    int *d_fact_fkey,
+    int *d_fact_val,
+    int num_dim,
+    int num_fact,
+    int radix_bits
+)
+{
+  unsigned long long* res;
+  int num_parts = 1 << radix_bits;
+  int *dim_offsets, *fact_offsets;
+  int *dim_key, *dim_val, *fact_fkey, *fact_val;
+  float time_partition_build, time_partition_probe, time_probe, time_memset;
+
+  usm_pool &pool = get_usm_pool(q);
+  dim_offsets = (int*)pool.allocate(sizeof(int) * (num_parts + 1));
+  fact_offsets = (int*)pool.allocate(sizeof(int) * (num_parts + 1));
+  res = (unsigned long long*)pool.allocate(sizeof(long long));
+
+  chrono::high_resolution_clock::time_point st, part_build, part_probe, finish;
+  // begin time measurement
+  st = chrono::high_resolution_clock::now();
+
+  // only the join kernel needs res: zero it while partitioning
+  sycl::event zeroed_res = q.memset(res, 0, sizeof(long long));
+
+  radix_partition_relation(q, d_dim_key, d_dim_val, num_dim, radix_bits,
+      dim_key, dim_val, dim_offsets);
+  part_build = chrono::high_resolution_clock::now();
+  radix_partition_relation(q, d_fact_fkey, d_fact_val, num_fact, radix_bits,
+      fact_fkey, fact_val, fact_offsets);
+  part_probe = chrono::high_resolution_clock::now();
+
+  // the local hash table is sized after the largest build partition
+  int *h_dim_offsets = new int[num_parts + 1];
+  q.memcpy(h_dim_offsets, dim_offsets, sizeof(int) * (num_parts + 1)).wait();
+
+  int max_part = 0;
+  for (int p = 0; p < num_parts; p++) {
+    max_part = std::max(max_part, h_dim_offsets[p + 1] - h_dim_offsets[p]);
+  }
+  delete[] h_dim_offsets;
+
+  int ht_len = get_linear_ht_len(max_part);
+  size_t local_mem_size = q.get_device().get_info<sycl::info::device::local_mem_size>();
+
+  if (sizeof(long long) * ht_len > local_mem_size) {
+    std::cerr << "[Error] Partitions of " << max_part << " keys do not fit in local memory,"
+              << " increase the number of radix bits" << std::endl;
+    std::exit(1);
+  }
+
+  q.submit([&](sycl::handler &cgh) {
+    cgh.depends_on(zeroed_res);
+
+    // 64 bit slots: keys and values are read with a single access
+    sycl::local_accessor<unsigned long long, 1> ht(sycl::range<1>(ht_len), cgh);
+
+    cgh.parallel_for<class partitioned_join>(
+      sycl::nd_range<1>(static_cast<size_t>(num_parts) * NUM_BLOCK_THREAD, NUM_BLOCK_THREAD),
+        [=](sycl::nd_item<1> item_ct1) {
+            partitioned_join_kernel<NUM_BLOCK_THREAD>(
+              dim_key, dim_val, dim_offsets, fact_fkey, fact_val, fact_offsets,
+              reinterpret_cast<int*>(ht.get_pointer().get()), ht_len, res, item_ct1);
+    });
+  }).wait();
+
+  finish = chrono::high_resolution_clock::now();
+  unsigned long long h_res;
+
+  q.memcpy(&h_res, res, sizeof(long long)).wait();
+
+  std::cout<<"JOIN RESULTS: "<< h_res << std::endl;
+
+  pool.deallocate(dim_key);
+  pool.deallocate(dim_val);
+  pool.deallocate(fact_fkey);
+  pool.deallocate(fact_val);
+  pool.deallocate(dim_offsets);
+  pool.deallocate(fact_offsets);
+  pool.deallocate(res);
+
+  // the memset overlaps the partitioning, it is timed on the device
+  time_memset = event_elapsed(zeroed_res);
+  time_partition_build = std::chrono::duration<double>(part_build - st).count() * 1000. ;
+  time_partition_probe = std::chrono::duration<double>(part_probe - part_build).count() * 1000. ;
+  // build and probe are fused into a single kernel
+  time_probe = std::chrono::duration<double>(finish - part_probe).count() * 1000. ;
+
+  TimeKeeper t = {0, time_probe, time_memset,
+                  time_partition_build + time_partition_probe + time_probe,
+                  time_partition_build, time_partition_probe};
+  return t;
+}
+
 
 //---------------------------------------------------------------------
 // Main
 //---------------------------------------------------------------------
 int main(int argc, char **argv) 
 {
-  auto q = try_get_queue(sycl::default_selector{});
+  // profiling times the phases of the join on the device
+  auto q = try_get_queue(sycl::default_selector{}, {sycl::property::queue::enable_profiling()});
 
   std::cout<<"Running on "
           << q.get_device().get_info<sycl::info::device::name>()
@@ -199,12 +697,23 @@ int main(int argc, char **argv)
   int num_fact           = 256 * 1<<20;
   int num_dim            = 16 * 1<<20;
   int num_trials         = 3;
+  int radix_bits         = 0;
 
   // Initialize command line
   if(argc > 1) {
       num_dim = atoi(argv[1]);
   }
 
+  // a non-zero number of radix bits selects the partitioned join
+  if(argc > 2) {
+      radix_bits = atoi(argv[2]);
+  }
+
+  if (radix_bits < 0 || radix_bits > MAX_RADIX_BITS) {
+      std::cerr << "[Error] radix bits must be in [0, " << MAX_RADIX_BITS << "]" << std::endl;
+      return 1;
+  }
+
   int log2 = 0;
   int num_dim_dup = num_dim >> 1;
   while (num_dim_dup) {
@@ -238,22 +747,55 @@ int main(int argc, char **argv)
   q.memcpy(d_fact_val, h_fact_val, sizeof(int) * num_fact).wait();
   
   
-  for (int j = 0; j < num_trials; j++) {
-    TimeKeeper t = hash_join(q, d_dim_key, d_dim_val, d_fact_fkey, d_fact_val, num_dim, num_fact);
+  // prints the timings of a trial as a json line
+  auto report = [&](const char *table, const TimeKeeper &t) {
     cout<< "{"
         << "\"num_dim\":" << num_dim 
         << ",\"num_fact\":" << num_fact 
-        << ",\"radix\":" << 0
-        << ",\"time_partition_build\":" << 0
-        << ",\"time_partition_probe\":" << 0
-        << ",\"time_partition_total\":" << 0
+        << ",\"radix\":" << radix_bits
+        << ",\"table\":\"" << table << "\""
+        << ",\"time_partition_build\":" << t.time_partition_build << " ms"
+        << ",\"time_partition_probe\":" << t.time_partition_probe << " ms"
+        << ",\"time_partition_total\":" << t.time_partition_build + t.time_partition_probe << " ms"
         << ",\"time_build\":" << t.time_build << " ms"
         << ",\"time_probe\":" << t.time_probe << " ms"
         << ",\"time_extra\":" << t.time_extra << " ms"
         << ",\"time_join_total\":" << t.time_total << " ms"
         << "}" << endl;
+  };
+
+  // the pool throws once the device is out of memory
+  try {
+    for (int j = 0; j < num_trials; j++) {
+      if (radix_bits != 0) {
+        report("linear", radix_hash_join(q, d_dim_key, d_dim_val, d_fact_fkey, d_fact_val,
+                                         num_dim, num_fact, radix_bits));
+        continue;
+      }
+
+      // the three hash tables on the same relations, checked against each other
+      unsigned long long res_direct, res_linear, res_bucketed;
+      report("direct", hash_join<HashTable::direct>(q, d_dim_key, d_dim_val, d_fact_fkey, d_fact_val,
+                                                   num_dim, num_fact, res_direct));
+      report("linear", hash_join<HashTable::linear>(q, d_dim_key, d_dim_val, d_fact_fkey, d_fact_val,
+                                                   num_dim, num_fact, res_linear));
+      report("bucketed", hash_join<HashTable::bucketed>(q, d_dim_key, d_dim_val, d_fact_fkey, d_fact_val,
+                                                       num_dim, num_fact, res_bucketed));
+
+      if (res_linear != res_direct || res_bucketed != res_direct) {
+        std::cerr << "[Error] hash tables disagree: linear " << res_linear << ", bucketed "
+                  << res_bucketed << ", direct " << res_direct << std::endl;
+      }
+    }
+  }
+  catch (sycl::exception const &exc) {
+    std::cerr << exc.what() << "Exception caught at file:" << __FILE__
+              << ", line:" << __LINE__ << std::endl;
+    std::exit(1);
   }
 
+  get_usm_pool(q).print_stats(cout);
+  get_usm_pool(q).release();
  
   sycl::free(d_dim_key, q);
   sycl::free(d_dim_val, q);
@@ -0,0 +1,294 @@
+#include <CL/sycl.hpp>
+#include <iostream>
+#include <stdio.h>
+
+#include <oneapi/mkl.hpp>
+#include <oneapi_crystal/crystal.hpp>
+
+#include "../oneapi_crystal/utils/atomic.hpp"
+#include "../oneapi_crystal/tools/queue_helpers.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#define TILE_SIZE (block_threads * items_per_thread)
+
+#define NUM_BLOCK_THREAD 128
+#define NUM_ITEM_PER_THREAD 4
+
+// bins of the histogram benchmark
+#define NUM_BINS 64
+
+using namespace crystal;
+using namespace std;
+
+// sum of the column, with the work-group collectives or, given
+// scratch, through sub-group reductions and local memory
+template<int block_threads, int items_per_thread>
+void reduce_kernel(
+    int* col,
+    int num_items,
+    long long* scratch,
+    unsigned long long* sum,
+    sycl::nd_item<1> item_ct1
+)
+{
+  int items[items_per_thread];
+  long long values[items_per_thread];
+
+  int tile_offset = item_ct1.get_group(0) * TILE_SIZE;
+  int num_tiles = (num_items + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item_ct1.get_group(0) == num_tiles - 1) {
+    num_tile_items = num_items - tile_offset;
+  }
+
+  load<int, block_threads, items_per_thread>(col + tile_offset, items, num_tile_items, item_ct1);
+
+  #pragma unroll
+  for (int i = 0; i < items_per_thread; i++) {
+    values[i] = items[i];
+  }
+
+  long long aggregate = block_reduce<long long, sycl::plus<long long>, block_threads, items_per_thread>(
+      values, sycl::plus<long long>(), 0, scratch, num_tile_items, item_ct1);
+
+  if (item_ct1.get_local_id(0) == 0) {
+    atomicAdd(*sum, static_cast<unsigned long long>(aggregate));
+  }
+}
+
+// histogram of the column in NUM_BINS equal-width bins
+template<int block_threads, int items_per_thread>
+void histogram_kernel(
+    int* col,
+    int num_items,
+    int lo,
+    int width,
+    int* hist,
+    int* local_hist,
+    sycl::nd_item<1> item_ct1
+)
+{
+  int items[items_per_thread];
+  int selection_flags[items_per_thread];
+
+  int tile_offset = item_ct1.get_group(0) * TILE_SIZE;
+  int num_tiles = (num_items + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item_ct1.get_group(0) == num_tiles - 1) {
+    num_tile_items = num_items - tile_offset;
+  }
+
+  init_flags<block_threads, items_per_thread>(selection_flags);
+  load<int, block_threads, items_per_thread>(col + tile_offset, items, num_tile_items, item_ct1);
+
+  block_histogram<int, RangeBin<int>, block_threads, items_per_thread>(items, selection_flags,
+      RangeBin<int>(lo, width), local_hist, hist, NUM_BINS, num_tile_items, item_ct1);
+}
+
+// sorts every tile of the column, along with the row ids
+template<int block_threads, int items_per_thread>
+void sort_kernel(
+    int* col,
+    int num_items,
+    int* out_keys,
+    int* out_rows,
+    int* local_keys,
+    int* local_rows,
+    int* local_counts,
+    sycl::nd_item<1> item_ct1
+)
+{
+  int keys[items_per_thread];
+  int rows[items_per_thread];
+
+  int tid = item_ct1.get_local_id(0);
+  int tile_offset = item_ct1.get_group(0) * TILE_SIZE;
+  int num_tiles = (num_items + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item_ct1.get_group(0) == num_tiles - 1) {
+    num_tile_items = num_items - tile_offset;
+  }
+
+  load<int, block_threads, items_per_thread>(col + tile_offset, keys, num_tile_items, item_ct1);
+
+  #pragma unroll
+  for (int i = 0; i < items_per_thread; i++) {
+    rows[i] = tile_offset + tid + (i * block_threads);
+  }
+
+  block_radix_sort<int, int, block_threads, items_per_thread>(keys, rows, local_keys, local_rows,
+      local_counts, num_tile_items, item_ct1);
+
+  store<int, block_threads, items_per_thread>(out_keys + tile_offset, keys, num_tile_items, item_ct1);
+  store<int, block_threads, items_per_thread>(out_rows + tile_offset, rows, num_tile_items, item_ct1);
+}
+
+/**
+ * @brief Runs the kernel submitted by cgf over num_items rows,
+ *        returning the time in ms
+ */
+template <typename CGF>
+float time_kernel(sycl::queue &q, CGF cgf)
+{
+  chrono::high_resolution_clock::time_point st, finish;
+  st = chrono::high_resolution_clock::now();
+  q.submit(cgf).wait();
+  finish = chrono::high_resolution_clock::now();
+
+  // time in ms
+  return std::chrono::duration<float>(finish - st).count() * 1000.;
+}
+
+/**
+ * Main
+ */
+int main(int argc, char **argv)
+{
+  auto q = try_get_queue(sycl::default_selector{});
+  int num_items = 1 << 26;
+  int num_trials = 3;
+
+  if (argc > 1) {
+    num_items = atoi(argv[1]);
+  }
+
+  std::cout<<"Running on: "
+           << q.get_device().get_info<sycl::info::device::name>() << std::endl;
+
+  int tile_items = NUM_BLOCK_THREAD * NUM_ITEM_PER_THREAD;
+  int num_blocks = (num_items + tile_items - 1) / tile_items;
+  sycl::nd_range<1> range({static_cast<size_t>(num_blocks * NUM_BLOCK_THREAD)}, {NUM_BLOCK_THREAD});
+
+  // signed keys in [-2^30, 2^30), so that sorting covers the sign
+  // bit and value - lo does not overflow in RangeBin
+  std::mt19937 rng(0);
+  std::vector<int> col(num_items);
+  for (int i = 0; i < num_items; i++) {
+    col[i] = static_cast<int>(rng() % (1u << 31)) - (1 << 30);
+  }
+
+  // the bins cover [-2^29, 2^29): half of the keys fall outside,
+  // on both sides, and must not be counted
+  int lo = -(1 << 29);
+  int width = (1 << 30) / NUM_BINS;
+
+  // host reference
+  unsigned long long ref_sum = 0;
+  std::vector<int> ref_hist(NUM_BINS, 0);
+  for (int i = 0; i < num_items; i++) {
+    ref_sum += static_cast<unsigned long long>(static_cast<long long>(col[i]));
+    if (col[i] >= lo && (col[i] - lo) / width < NUM_BINS) {
+      ref_hist[(col[i] - lo) / width]++;
+    }
+  }
+
+  int *d_col = (int*) malloc_device(sizeof(int) * num_items, q);
+  int *d_keys = (int*) malloc_device(sizeof(int) * num_items, q);
+  int *d_rows = (int*) malloc_device(sizeof(int) * num_items, q);
+  int *d_hist = (int*) malloc_device(sizeof(int) * NUM_BINS, q);
+  unsigned long long *d_sum = (unsigned long long*) malloc_device(sizeof(unsigned long long), q);
+
+  q.memcpy(d_col, col.data(), sizeof(int) * num_items).wait();
+
+  std::vector<int> keys(num_items), rows(num_items), hist(NUM_BINS);
+
+  for (int t = 0; t < num_trials; t++) {
+    unsigned long long sum_collective, sum_local;
+
+    q.memset(d_sum, 0, sizeof(unsigned long long)).wait();
+    float time_reduce_collective = time_kernel(q, [&](sycl::handler &cgh) {
+      cgh.parallel_for<class reduce_collective>(range, [=](sycl::nd_item<1> item_ct1) {
+        reduce_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(d_col, num_items, nullptr, d_sum, item_ct1);
+      });
+    });
+    q.memcpy(&sum_collective, d_sum, sizeof(unsigned long long)).wait();
+
+    q.memset(d_sum, 0, sizeof(unsigned long long)).wait();
+    float time_reduce_local = time_kernel(q, [&](sycl::handler &cgh) {
+      sycl::local_accessor<long long, 1> scratch(sycl::range<1>(NUM_BLOCK_THREAD), cgh);
+
+      cgh.parallel_for<class reduce_local>(range, [=](sycl::nd_item<1> item_ct1) {
+        reduce_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(d_col, num_items, scratch.get_pointer(),
+            d_sum, item_ct1);
+      });
+    });
+    q.memcpy(&sum_local, d_sum, sizeof(unsigned long long)).wait();
+
+    q.memset(d_hist, 0, sizeof(int) * NUM_BINS).wait();
+    float time_histogram = time_kernel(q, [&](sycl::handler &cgh) {
+      sycl::local_accessor<int, 1> local_hist(sycl::range<1>(NUM_BINS), cgh);
+
+      cgh.parallel_for<class histogram>(range, [=](sycl::nd_item<1> item_ct1) {
+        histogram_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(d_col, num_items, lo, width, d_hist,
+            local_hist.get_pointer(), item_ct1);
+      });
+    });
+    q.memcpy(hist.data(), d_hist, sizeof(int) * NUM_BINS).wait();
+
+    float time_sort = time_kernel(q, [&](sycl::handler &cgh) {
+      sycl::local_accessor<int, 1> local_keys(sycl::range<1>(tile_items), cgh);
+      sycl::local_accessor<int, 1> local_rows(sycl::range<1>(tile_items), cgh);
+      sycl::local_accessor<int, 1> local_counts(
+          sycl::range<1>(get_radix_sort_counts_len(NUM_BLOCK_THREAD)), cgh);
+
+      cgh.parallel_for<class sort_tiles>(range, [=](sycl::nd_item<1> item_ct1) {
+        sort_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(d_col, num_items, d_keys, d_rows,
+            local_keys.get_pointer(), local_rows.get_pointer(), local_counts.get_pointer(), item_ct1);
+      });
+    });
+    q.memcpy(keys.data(), d_keys, sizeof(int) * num_items).wait();
+    q.memcpy(rows.data(), d_rows, sizeof(int) * num_items).wait();
+
+    // every tile must be sorted, stable, and a permutation of its rows
+    int unsorted_tiles = 0;
+    for (int tile = 0; tile < num_blocks; tile++) {
+      int begin = tile * tile_items;
+      int end = std::min(num_items, begin + tile_items);
+      std::vector<bool> seen(end - begin, false);
+      bool ok = true;
+
+      for (int i = begin; i < end && ok; i++) {
+        ok = rows[i] >= begin && rows[i] < end && !seen[rows[i] - begin] && col[rows[i]] == keys[i];
+        if (ok) seen[rows[i] - begin] = true;
+        if (ok && i > begin) {
+          ok = keys[i - 1] < keys[i] || (keys[i - 1] == keys[i] && rows[i - 1] < rows[i]);
+        }
+      }
+      unsorted_tiles += !ok;
+    }
+
+    std::cout<< "{"
+        << "\"num_entries\":" << num_items
+        << ",\"time_reduce_collective\":" << time_reduce_collective
+        << ",\"time_reduce_local\":" << time_reduce_local
+        << ",\"time_histogram\":" << time_histogram
+        << ",\"time_sort\":" << time_sort
+        << "}" << endl;
+
+    if (sum_collective != ref_sum || sum_local != ref_sum) {
+      std::cerr << "[Error] block_reduce: " << sum_collective << ", " << sum_local
+                << " != " << ref_sum << std::endl;
+    }
+    if (hist != ref_hist) {
+      std::cerr << "[Error] block_histogram does not match the host histogram" << std::endl;
+    }
+    if (unsorted_tiles != 0) {
+      std::cerr << "[Error] block_radix_sort: " << unsorted_tiles << " tiles not sorted" << std::endl;
+    }
+  }
+
+  sycl::free(d_col, q);
+  sycl::free(d_keys, q);
+  sycl::free(d_rows, q);
+  sycl::free(d_hist, q);
+  sycl::free(d_sum, q);
+
+  return 0;
+}
@@ -22,7 +22,7 @@ using namespace crystal;
 using namespace std;
 
 
-template<int block_threads, int items_per_thread>
+template<int block_threads, int items_per_thread, BlockIo io = BlockIo::direct>
 void project(
     float* in1, 
     float* in2, 
@@ -43,8 +43,8 @@ void project(
         num_tile_items = num_items - tile_offset; // 100 -
     }
 
-  load<float, block_threads, items_per_thread>(in1 + tile_offset, items, num_tile_items, item_ct1);
-  load<float, block_threads, items_per_thread>(in2 + tile_offset, items2, num_tile_items, item_ct1);
+  load<float, block_threads, items_per_thread, io>(in1 + tile_offset, items, num_tile_items, item_ct1);
+  load<float, block_threads, items_per_thread, io>(in2 + tile_offset, items2, num_tile_items, item_ct1);
 
   #pragma unroll
   for (int i = 0; i < items_per_thread; i++) {
@@ -54,7 +54,7 @@ void project(
     }
   }
 
-  store<float, block_threads, items_per_thread>(out + tile_offset, res, num_tile_items, item_ct1);
+  store<float, block_threads, items_per_thread, io>(out + tile_offset, res, num_tile_items, item_ct1);
 }
 
 template<int block_threads, int items_per_thread>
@@ -92,6 +92,7 @@ void project_sigmoid(
 }
 
 
+template<BlockIo io>
 float project_gpu(
     sycl::queue &q,
     float* in1, 
@@ -110,7 +111,7 @@ float project_gpu(
        cgh.parallel_for(
           sycl::nd_range<1>(static_cast<size_t>(num_blocks*128), 128),
            [=](sycl::nd_item<1> item_ct1) {
-               project<128, 4>(in1, in2, out, num_items, item_ct1);
+               project<128, 4, io>(in1, in2, out, num_items, item_ct1);
            });
   }).wait();
   finish = chrono::high_resolution_clock::now();
@@ -182,10 +183,12 @@ int main(int argc, char **argv)
     oneapi::mkl::rng::generate(distr_ct1, *generator, num_items, d_in2);
 
   float time_proj_gpu;
+  float time_proj_subgroup_gpu;
   float time_proj_sigmoid_gpu;  
 
   for (int t = 0; t < num_trials; t++) {
-    time_proj_gpu = project_gpu(q, d_in1, d_in2, d_out, num_items);
+    time_proj_gpu = project_gpu<BlockIo::direct>(q, d_in1, d_in2, d_out, num_items);
+    time_proj_subgroup_gpu = project_gpu<BlockIo::subgroup>(q, d_in1, d_in2, d_out, num_items);
     time_proj_sigmoid_gpu = project_sigmoid_gpu(q,
         d_in1, d_in2
         , d_out_sig,
@@ -193,6 +196,7 @@ int main(int argc, char **argv)
 
     std::cout<< "{"
         << "\"time_proj_gpu\":" << time_proj_gpu
+        << ",\"time_proj_subgroup_gpu\":" << time_proj_subgroup_gpu
         << ",\"time_proj_sigmoid_gpu\":" << time_proj_sigmoid_gpu
         << "}" << endl;
   }
@@ -0,0 +1,237 @@
+#include <CL/sycl.hpp>
+#include <iostream>
+#include <stdio.h>
+
+#include <oneapi/mkl.hpp>
+#include <oneapi_crystal/crystal.hpp>
+
+#include "../oneapi_crystal/utils/atomic.hpp"
+#include "../oneapi_crystal/tools/queue_helpers.hpp"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#define TILE_SIZE (block_threads * items_per_thread)
+
+#define NUM_BLOCK_THREAD 128
+#define NUM_ITEM_PER_THREAD 4
+
+// days of the SSB date dimension, 1992 to 1998
+#define NUM_DAYS 2556
+
+using namespace crystal;
+using namespace std;
+
+/**
+ * Filter of the benchmark: one year out of seven, as the date
+ * filter of Q1.1
+ */
+struct InYear {
+  inline bool operator()(const int &day) const {
+    return day >= 365 && day < 730;
+  }
+};
+
+// the plain scan: load the column and evaluate every value
+template<int block_threads, int items_per_thread>
+void plain_kernel(
+    int* col,
+    int num_items,
+    unsigned long long* num_selected,
+    sycl::nd_item<1> item_ct1
+)
+{
+  int items[items_per_thread];
+  int selection_flags[items_per_thread];
+
+  int tid = item_ct1.get_local_id(0);
+  int tile_offset = item_ct1.get_group(0) * TILE_SIZE;
+  int num_tiles = (num_items + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item_ct1.get_group(0) == num_tiles - 1) {
+    num_tile_items = num_items - tile_offset;
+  }
+
+  load<int, block_threads, items_per_thread>(col + tile_offset, items, num_tile_items, item_ct1);
+  predicate<int, InYear, block_threads, items_per_thread>(items, InYear(), selection_flags,
+      num_tile_items, item_ct1);
+
+  unsigned long long count = 0;
+  #pragma unroll
+  for (int i = 0; i < items_per_thread; i++) {
+    if (tid + (i * block_threads) < num_tile_items && selection_flags[i]) {
+      count++;
+    }
+  }
+
+  unsigned long long aggregate = sycl::reduce_over_group(item_ct1.get_group(), count, sycl::plus<>());
+  if (tid == 0) {
+    atomicAdd(*num_selected, aggregate);
+  }
+}
+
+// the run-aware scan, falling back on plain for the tiles with
+// about one run per row when it is not nullptr
+template<int block_threads, int items_per_thread>
+void rle_kernel(
+    int* values,
+    int* pos,
+    int num_runs,
+    int* plain,
+    int num_items,
+    unsigned long long* num_selected,
+    sycl::nd_item<1> item_ct1
+)
+{
+  int selection_flags[items_per_thread];
+
+  int tid = item_ct1.get_local_id(0);
+  int tile_offset = item_ct1.get_group(0) * TILE_SIZE;
+  int num_tiles = (num_items + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item_ct1.get_group(0) == num_tiles - 1) {
+    num_tile_items = num_items - tile_offset;
+  }
+
+  if (!predicate_rle<int, InYear, block_threads, items_per_thread>(values, pos, num_runs, plain,
+        tile_offset, InYear(), selection_flags, num_tile_items, item_ct1)) {
+    return;
+  }
+
+  unsigned long long count = 0;
+  #pragma unroll
+  for (int i = 0; i < items_per_thread; i++) {
+    if (tid + (i * block_threads) < num_tile_items && selection_flags[i]) {
+      count++;
+    }
+  }
+
+  unsigned long long aggregate = sycl::reduce_over_group(item_ct1.get_group(), count, sycl::plus<>());
+  if (tid == 0) {
+    atomicAdd(*num_selected, aggregate);
+  }
+}
+
+/**
+ * @brief Runs kernel over num_items rows, returning the time in ms
+ *        and the number of selected rows in num_selected
+ */
+template <typename Kernel>
+float time_scan(
+    sycl::queue &q,
+    int num_items,
+    unsigned long long* d_num_selected,
+    unsigned long long &num_selected,
+    Kernel kernel
+)
+{
+  int tile_items = NUM_BLOCK_THREAD * NUM_ITEM_PER_THREAD;
+  int num_blocks = (num_items + tile_items - 1) / tile_items;
+
+  q.memset(d_num_selected, 0, sizeof(unsigned long long)).wait();
+
+  chrono::high_resolution_clock::time_point st, finish;
+  st = chrono::high_resolution_clock::now();
+  q.submit([&](sycl::handler &cgh) {
+    cgh.parallel_for(
+        sycl::nd_range<1>({static_cast<size_t>(num_blocks * NUM_BLOCK_THREAD)}, {NUM_BLOCK_THREAD}),
+        kernel);
+  }).wait();
+  finish = chrono::high_resolution_clock::now();
+
+  q.memcpy(&num_selected, d_num_selected, sizeof(unsigned long long)).wait();
+
+  // time in ms
+  return std::chrono::duration<float>(finish - st).count() * 1000.;
+}
+
+/**
+ * Main
+ */
+int main(int argc, char **argv)
+{
+  auto q = try_get_queue(sycl::default_selector{});
+  int num_items = 1 << 26;
+  int num_trials = 3;
+
+  if (argc > 1) {
+    num_items = atoi(argv[1]);
+  }
+
+  std::cout<<"Running on: "
+           << q.get_device().get_info<sycl::info::device::name>() << std::endl;
+
+  unsigned long long *d_num_selected = (unsigned long long*) malloc_device(sizeof(unsigned long long), q);
+  int *d_col = (int*) malloc_device(sizeof(int) * num_items, q);
+  int *d_values = (int*) malloc_device(sizeof(int) * num_items, q);
+  int *d_pos = (int*) malloc_device(sizeof(int) * num_items, q);
+
+  // sorted: a date column ordered by day, as lineorder sorted by
+  // lo_orderdate; unsorted: a random day per row, as SSB generates it
+  std::mt19937 rng(0);
+  std::vector<int> col(num_items), values, pos;
+
+  for (int sorted = 1; sorted >= 0; sorted--) {
+    for (int i = 0; i < num_items; i++) {
+      col[i] = sorted ? (int)((long long)i * NUM_DAYS / num_items) : (int)(rng() % NUM_DAYS);
+    }
+
+    values.clear();
+    pos.clear();
+    for (int i = 0; i < num_items; i++) {
+      if (i == 0 || col[i] != col[i - 1]) {
+        values.push_back(col[i]);
+        pos.push_back(i);
+      }
+    }
+    int num_runs = values.size();
+
+    q.memcpy(d_col, col.data(), sizeof(int) * num_items).wait();
+    q.memcpy(d_values, values.data(), sizeof(int) * num_runs).wait();
+    q.memcpy(d_pos, pos.data(), sizeof(int) * num_runs).wait();
+
+    for (int t = 0; t < num_trials; t++) {
+      unsigned long long num_plain, num_rle, num_rle_fallback;
+
+      float time_plain = time_scan(q, num_items, d_num_selected, num_plain,
+          [=](sycl::nd_item<1> item_ct1) {
+            plain_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(d_col, num_items, d_num_selected, item_ct1);
+          });
+      float time_rle = time_scan(q, num_items, d_num_selected, num_rle,
+          [=](sycl::nd_item<1> item_ct1) {
+            rle_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(d_values, d_pos, num_runs, nullptr,
+                num_items, d_num_selected, item_ct1);
+          });
+      float time_rle_fallback = time_scan(q, num_items, d_num_selected, num_rle_fallback,
+          [=](sycl::nd_item<1> item_ct1) {
+            rle_kernel<NUM_BLOCK_THREAD, NUM_ITEM_PER_THREAD>(d_values, d_pos, num_runs, d_col,
+                num_items, d_num_selected, item_ct1);
+          });
+
+      std::cout<< "{"
+          << "\"num_entries\":" << num_items
+          << ",\"sorted\":" << sorted
+          << ",\"num_runs\":" << num_runs
+          << ",\"num_selected\":" << num_plain
+          << ",\"time_plain\":" << time_plain
+          << ",\"time_rle\":" << time_rle
+          << ",\"time_rle_fallback\":" << time_rle_fallback
+          << "}" << endl;
+
+      if (num_rle != num_plain || num_rle_fallback != num_plain) {
+        std::cerr << "[Error] rle and plain scans disagree: " << num_rle << ", "
+                  << num_rle_fallback << " != " << num_plain << std::endl;
+      }
+    }
+  }
+
+  sycl::free(d_num_selected, q);
+  sycl::free(d_col, q);
+  sycl::free(d_values, q);
+  sycl::free(d_pos, q);
+
+  return 0;
+}
@@ -0,0 +1,228 @@
+#include <CL/sycl.hpp>
+#include <iostream>
+#include <stdio.h>
+
+#include <oneapi/mkl.hpp>
+#include <oneapi_crystal/crystal.hpp>
+
+#include "generator.h"
+#include "../oneapi_crystal/utils/atomic.hpp"
+#include "../oneapi_crystal/tools/queue_helpers.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#define TILE_SIZE (block_threads * items_per_thread)
+
+#define NUM_BLOCK_THREAD 128
+#define NUM_ITEM_PER_THREAD 4
+
+using namespace crystal;
+using namespace std;
+
+/**
+ * Select of the original Crystal: every tile scans its flags and
+ * reserves its output range with a single atomic on a global
+ * counter, so the tiles land in arbitrary order
+ */
+template<int block_threads, int items_per_thread>
+void select_atomic(
+    float* in,
+    float* out,
+    int* num_selected,
+    float cutoff,
+    int num_items,
+    sycl::nd_item<1> item_ct1
+)
+{
+  float items[items_per_thread];
+  int selection_flags[items_per_thread];
+  int positions[items_per_thread];
+
+  int tid = item_ct1.get_local_id(0);
+  int tile_offset = item_ct1.get_group(0) * TILE_SIZE;
+  int num_tiles = (num_items + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item_ct1.get_group(0) == num_tiles - 1) {
+    num_tile_items = num_items - tile_offset;
+  }
+
+  load<float, block_threads, items_per_thread>(in + tile_offset, items, num_tile_items, item_ct1);
+  predicate<float, GreaterThan<float>, block_threads, items_per_thread>(items,
+      GreaterThan<float>(cutoff), selection_flags, num_tile_items, item_ct1);
+
+  #pragma unroll
+  for (int i = 0; i < items_per_thread; i++) {
+    if (tid + (i * block_threads) >= num_tile_items) {
+      selection_flags[i] = 0;
+    }
+  }
+
+  int num_tile_selected = block_exclusive_sum<int, block_threads, items_per_thread>(
+      selection_flags, positions, nullptr, num_tile_items, item_ct1);
+
+  int out_offset = 0;
+  if (tid == 0) {
+    out_offset = atomicAdd(num_selected[0], num_tile_selected);
+  }
+  out_offset = sycl::group_broadcast(item_ct1.get_group(), out_offset, 0);
+
+  #pragma unroll
+  for (int i = 0; i < items_per_thread; i++) {
+    if (selection_flags[i]) {
+      out[out_offset + positions[i]] = items[i];
+    }
+  }
+}
+
+float select_atomic_gpu(
+    sycl::queue &q,
+    float* in,
+    float* out,
+    int* d_num_selected,
+    float cutoff,
+    int num_items,
+    int &num_selected
+)
+{
+  int tile_items = 128*4;
+  int num_blocks = (num_items + tile_items - 1)/tile_items;
+
+  chrono::high_resolution_clock::time_point st, finish;
+  // begin time measurement
+  st = chrono::high_resolution_clock::now();
+  q.memset(d_num_selected, 0, sizeof(int)).wait();
+  q.submit([&](sycl::handler &cgh) {
+    cgh.parallel_for(
+        sycl::nd_range<1>({static_cast<size_t>(num_blocks*128)},{128}),
+        [=](sycl::nd_item<1> item_ct1) {
+            select_atomic<128, 4>(in, out, d_num_selected, cutoff, num_items, item_ct1);
+        });
+  }).wait();
+  q.memcpy(&num_selected, d_num_selected, sizeof(int)).wait();
+  finish = chrono::high_resolution_clock::now();
+
+  // time in ms
+  return std::chrono::duration<float>(finish - st).count() * 1000.;
+}
+
+float select_if_gpu(
+    sycl::queue &q,
+    float* in,
+    float* out,
+    int* tile_counts,
+    float cutoff,
+    int num_items,
+    int &num_selected
+)
+{
+  chrono::high_resolution_clock::time_point st, finish;
+  // begin time measurement
+  st = chrono::high_resolution_clock::now();
+  num_selected = select_if(q, in, num_items, GreaterThan<float>(cutoff), out, (int *)nullptr, tile_counts);
+  finish = chrono::high_resolution_clock::now();
+
+  // time in ms
+  return std::chrono::duration<float>(finish - st).count() * 1000.;
+}
+
+/**
+ * Main
+ */
+int main(int argc, char **argv)
+{
+  auto q = try_get_queue(sycl::default_selector{});
+  oneapi::mkl::rng::uniform<float> distr_ct1;
+  int num_items = 1 << 28;
+  int num_trials = 3;
+  float selectivity = 0.5;
+
+  if (argc > 1) {
+    selectivity = atof(argv[1]);
+  }
+
+  if (selectivity < 0 || selectivity > 1) {
+    std::cerr << "[Error] selectivity must be in [0, 1]" << std::endl;
+    return 1;
+  }
+
+  // the input is uniform in [0, 1)
+  float cutoff = 1 - selectivity;
+
+  float *d_in = nullptr;
+  d_in = (float*) malloc_device(num_items*sizeof(float), q.get_device(), q.get_context());
+
+  float *d_out = nullptr;
+  d_out = (float*) malloc_device(num_items*sizeof(float), q.get_device(), q.get_context());
+
+  int *d_num_selected = nullptr;
+  d_num_selected = (int*) malloc_device(sizeof(int), q.get_device(), q.get_context());
+
+  int *d_tile_counts = nullptr;
+  d_tile_counts = (int*) malloc_device(get_select_if_counts_len(num_items)*sizeof(int), q.get_device(), q.get_context());
+
+  std::cout<<"Running on: "
+           << q.get_device().get_info<sycl::info::device::name>() << std::endl;
+
+  oneapi::mkl::rng::philox4x32x10 *generator;
+  int seed = 0;
+  generator = new oneapi::mkl::rng::philox4x32x10(q, seed);
+
+  oneapi::mkl::rng::generate(distr_ct1, *generator, num_items, d_in).wait();
+
+  // host reference: the selected items in input order
+  std::vector<float> h_in(num_items);
+  q.memcpy(h_in.data(), d_in, num_items * sizeof(float)).wait();
+
+  std::vector<float> ref_out;
+  for (int i = 0; i < num_items; i++) {
+    if (h_in[i] > cutoff) {
+      ref_out.push_back(h_in[i]);
+    }
+  }
+  int ref_num_selected = ref_out.size();
+  std::vector<float> h_out(num_items);
+
+  float time_select_gpu;
+  float time_select_if_gpu;
+  int num_selected;
+  int num_selected_if;
+
+  for (int t = 0; t < num_trials; t++) {
+    time_select_gpu = select_atomic_gpu(q, d_in, d_out, d_num_selected, cutoff, num_items, num_selected);
+    time_select_if_gpu = select_if_gpu(q, d_in, d_out, d_tile_counts, cutoff, num_items, num_selected_if);
+
+    std::cout<< "{"
+        << "\"num_entries\":" << num_items
+        << ",\"selectivity\":" << selectivity
+        << ",\"num_selected\":" << num_selected_if
+        << ",\"time_select_gpu\":" << time_select_gpu
+        << ",\"time_select_if_gpu\":" << time_select_if_gpu
+        << "}" << endl;
+
+    if (num_selected != ref_num_selected) {
+      std::cerr << "[Error] select: " << num_selected << " selected, the host reference has "
+                << ref_num_selected << std::endl;
+    }
+    if (num_selected_if != ref_num_selected) {
+      std::cerr << "[Error] select_if: " << num_selected_if << " selected, the host reference has "
+                << ref_num_selected << std::endl;
+    } else {
+      // select_if preserves the input order: its output is the reference
+      q.memcpy(h_out.data(), d_out, num_selected_if * sizeof(float)).wait();
+      if (!std::equal(ref_out.begin(), ref_out.end(), h_out.begin())) {
+        std::cerr << "[Error] select_if output differs from the host reference" << std::endl;
+      }
+    }
+  }
+
+  delete generator;
+  if (d_in) sycl::free(d_in, q);
+  if (d_out) sycl::free(d_out, q);
+  if (d_num_selected) sycl::free(d_num_selected, q);
+  if (d_tile_counts) sycl::free(d_tile_counts, q);
+
+  return 0;
+}
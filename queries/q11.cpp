@@ -7,6 +7,7 @@
 
 #include "ssb_utils.h"
 #include "../oneapi_crystal/tools/queue_helpers.hpp"
+#include "../oneapi_crystal/tools/autotune.hpp"
 #include "../oneapi_crystal/tools/duration_logger.hpp"
 #include "../oneapi_crystal/utils/atomic.hpp"
 
@@ -16,14 +17,18 @@
 using namespace crystal;
 using namespace std;
 
-template<int block_threads, int items_per_thread>
+template<int block_threads, int items_per_thread, BlockIo io>
 void query_kernel (
   int* lo_orderdate, 
+  int* lo_orderdate_min, 
+  int* lo_orderdate_max, 
+  int zone_size, 
   int* lo_discount, 
   int* lo_quantity, 
   int* lo_extendedprice, 
   int lo_num_entries, 
   unsigned long long* revenue, 
+  int* tile_counter,
   sycl::nd_item<1> item_ct1
 ) 
 {
@@ -34,52 +39,73 @@ void query_kernel (
 
   unsigned long long sum = 0;
 
-  int tile_offset = item_ct1.get_group(0) * TILE_SIZE;
   int num_tiles = (lo_num_entries + TILE_SIZE - 1) / TILE_SIZE;
-  int num_tile_items = TILE_SIZE;
 
-  if (item_ct1.get_group(0) == num_tiles - 1) {
-    num_tile_items = lo_num_entries - tile_offset;
-  }
+  // a single tile unless the launch is persistent
+  for_each_tile(num_tiles, tile_counter, item_ct1, [&](int tile) {
+    int tile_offset = tile * TILE_SIZE;
+    int num_tile_items = TILE_SIZE;
 
-  load<int, block_threads, items_per_thread>(lo_orderdate + tile_offset, items, num_tile_items, item_ct1);
-  predicate_gt<int, block_threads, items_per_thread>(items, 19930000, selection_flags, num_tile_items, item_ct1);
-  predicate_and_lt<int, block_threads, items_per_thread>(items, 19940000, selection_flags, num_tile_items, item_ct1);
+    if (tile == num_tiles - 1) {
+      num_tile_items = lo_num_entries - tile_offset;
+    }
 
-  load<int, block_threads, items_per_thread>(lo_quantity + tile_offset, items, num_tile_items, item_ct1);
-  predicate_and_lt<int, block_threads, items_per_thread>(items, 25, selection_flags, num_tile_items, item_ct1);
+    // no date of the tile in 1993: skip it
+    if (!zone_map_may_match<int>(lo_orderdate_min, lo_orderdate_max, zone_size,
+          tile_offset, num_tile_items, 19930001, 19939999)) {
+      return;
+    }
 
-  load<int, block_threads, items_per_thread>(lo_discount + tile_offset, items, num_tile_items, item_ct1);
-  predicate_and_gte<int, block_threads, items_per_thread>(items, 1, selection_flags, num_tile_items, item_ct1);
-  predicate_and_lte<int, block_threads, items_per_thread>(items, 3, selection_flags, num_tile_items, item_ct1);
+    load<int, block_threads, items_per_thread, io>(lo_orderdate + tile_offset, items, num_tile_items, item_ct1);
+    predicate_gt<int, block_threads, items_per_thread>(items, 19930000, selection_flags, num_tile_items, item_ct1);
+    predicate_and_lt<int, block_threads, items_per_thread>(items, 19940000, selection_flags, num_tile_items, item_ct1);
 
-  load<int, block_threads, items_per_thread>(lo_extendedprice + tile_offset, items2, num_tile_items, item_ct1);
+    load<int, block_threads, items_per_thread, io>(lo_quantity + tile_offset, items, num_tile_items, item_ct1);
+    predicate_and_lt<int, block_threads, items_per_thread>(items, 25, selection_flags, num_tile_items, item_ct1);
 
-  #pragma unroll
-  for (int item = 0; item < items_per_thread; ++item)
-  {
-    if ((item_ct1.get_local_id(0) + (block_threads * item) < num_tile_items))
-      if (selection_flags[item])
-        sum += items[item] * items2[item];
-  }
+    load<int, block_threads, items_per_thread, io>(lo_discount + tile_offset, items, num_tile_items, item_ct1);
+    predicate_and_gte<int, block_threads, items_per_thread>(items, 1, selection_flags, num_tile_items, item_ct1);
+    predicate_and_lte<int, block_threads, items_per_thread>(items, 3, selection_flags, num_tile_items, item_ct1);
+
+    load<int, block_threads, items_per_thread, io>(lo_extendedprice + tile_offset, items2, num_tile_items, item_ct1);
 
+    #pragma unroll
+    for (int item = 0; item < items_per_thread; ++item)
+    {
+      if ((item_ct1.get_local_id(0) + (block_threads * item) < num_tile_items))
+        if (selection_flags[item])
+          sum += items[item] * items2[item];
+    }
+  });
+
+  // one reduction and atomic per work-group, whatever its tiles
   unsigned long long aggregate = sycl::reduce_over_group(item_ct1.get_group(), sum, sycl::plus<>());
 
-  if (item_ct1.get_local_id(0) == 0) {
+  if (item_ct1.get_local_id(0) == 0 && aggregate != 0) {
     atomicAdd(*revenue, aggregate);
   }
 }
 
+template<BlockIo io, int block_threads, int items_per_thread> class q11;
 
-void run_query(
+// returns the elapsed time in ms, printing the result when verbose
+template<BlockIo io, int block_threads, int items_per_thread>
+float run_query(
   sycl::queue &q,
   int *lo_orderdate, 
+  int *lo_orderdate_min, 
+  int *lo_orderdate_max, 
+  int zone_size, 
   int *lo_discount, 
   int *lo_quantity,
   int *lo_extendedprice, 
-  int lo_num_entries
+  int lo_num_entries,
+  bool persistent = false,
+  bool verbose = true
 ) 
 {
+  float time_query = 0;
+
   try {
     chrono::high_resolution_clock::time_point st, finish;
     st = chrono::high_resolution_clock::now();
@@ -90,18 +116,28 @@ void run_query(
     q.memset(d_sum, 0, sizeof(unsigned long long)).wait();
 
     // Run ----------------------
-    int tile_items = 128 * 4; 
+    int tile_items = block_threads * items_per_thread;
 
-    int n_threads = 128;
-    int n_blocks = (lo_num_entries + tile_items - 1)/tile_items;
+    int n_threads = block_threads;
+    int n_tiles = (lo_num_entries + tile_items - 1)/tile_items;
+
+    // persistent: a few work-groups per compute unit claim the tiles
+    int n_blocks = n_tiles;
+    int* d_tile_counter = nullptr;
+    if (persistent) {
+      n_blocks = get_persistent_groups(q, n_tiles);
+      d_tile_counter = (int*)malloc_device(sizeof(int), q);
+      q.memset(d_tile_counter, 0, sizeof(int)).wait();
+    }
 
     q.submit([&](sycl::handler &h){
 
-        h.parallel_for<class q11>(sycl::nd_range<1>(n_blocks * n_threads, n_threads), 
+        h.parallel_for<q11<io, block_threads, items_per_thread>>(sycl::nd_range<1>(n_blocks * n_threads, n_threads), 
          [=](auto& it) 
         {
-          query_kernel<128, 4>(lo_orderdate, lo_discount,
-            lo_quantity, lo_extendedprice, lo_num_entries, d_sum, it);
+          query_kernel<block_threads, items_per_thread, io>(lo_orderdate, lo_orderdate_min,
+            lo_orderdate_max, zone_size, lo_discount,
+            lo_quantity, lo_extendedprice, lo_num_entries, d_sum, d_tile_counter, it);
         });
 
     }).wait();
@@ -114,16 +150,24 @@ void run_query(
     finish = chrono::high_resolution_clock::now();
     std::chrono::duration<double> diff = finish - st;
     
-    std::cout << "Revenue: " << revenue << endl;
-    std::cout << "Time Taken Total: " << diff.count() * 1000 << endl;
+    time_query = diff.count() * 1000;
+
+    if (verbose) {
+      std::cout << "Revenue: " << revenue << endl;
+      std::cout << "Time Taken Total" << (io == BlockIo::subgroup ? " (sub-group I/O): " : ": ")
+                << time_query << endl;
+    }
     
     sycl::free(d_sum, q);
+    if (d_tile_counter) sycl::free(d_tile_counter, q);
   }
   catch (sycl::exception const &exc) {
     std::cerr << exc.what() << "Exception caught at file:" << __FILE__
               << ", line:" << __LINE__ << std::endl;
     std::exit(1);
   }
+
+  return time_query;
 }
 
 /**
@@ -131,6 +175,7 @@ void run_query(
  */
 int main(int argc, char** argv)
 { 
+  initCatalog(argc, argv);
   auto q = try_get_queue(sycl::default_selector{});
 
   // device
@@ -141,29 +186,54 @@ int main(int argc, char** argv)
   int num_trials          = 3;
 
   // loading data
-  int *h_lo_orderdate = loadColumn<int>("lo_orderdate", LO_LEN);
-  int *h_lo_discount = loadColumn<int>("lo_discount", LO_LEN);
-  int *h_lo_quantity = loadColumn<int>("lo_quantity", LO_LEN);
-  int *h_lo_extendedprice = loadColumn<int>("lo_extendedprice", LO_LEN);
-  int *h_d_datekey = loadColumn<int>("d_datekey", D_LEN);
-  int *h_d_year = loadColumn<int>("d_year", D_LEN);
+  int *h_lo_orderdate = mapColumn<int>("lo_orderdate", catalog.lo_len);
+  int *h_lo_discount = mapColumn<int>("lo_discount", catalog.lo_len);
+  int *h_lo_quantity = mapColumn<int>("lo_quantity", catalog.lo_len);
+  int *h_lo_extendedprice = mapColumn<int>("lo_extendedprice", catalog.lo_len);
+  ZoneMap h_lo_orderdate_zm = loadZoneMap("lo_orderdate", catalog.lo_len);
+  int *h_d_datekey = mapColumn<int>("d_datekey", catalog.d_len);
+  int *h_d_year = mapColumn<int>("d_year", catalog.d_len);
 
   cout << "** LOADED DATA **" << endl;
-  cout << "LO_LEN " << LO_LEN << endl;
+  cout << "LO_LEN " << catalog.lo_len << endl;
 
   // loading data to the device
-  int *d_lo_orderdate = load_to_device<int>(h_lo_orderdate, LO_LEN, q);
-  int *d_lo_discount = load_to_device<int>(h_lo_discount, LO_LEN, q);
-  int *d_lo_quantity = load_to_device<int>(h_lo_quantity, LO_LEN, q);
-  int *d_lo_extendedprice = load_to_device<int>(h_lo_extendedprice, LO_LEN, q);
-  int *d_d_datekey = load_to_device<int>(h_d_datekey, D_LEN, q);
-  int *d_d_year = load_to_device<int>(h_d_year, D_LEN, q);
+  int *d_lo_orderdate = map_to_device<int>(h_lo_orderdate, catalog.lo_len, q);
+  int *d_lo_discount = map_to_device<int>(h_lo_discount, catalog.lo_len, q);
+  int *d_lo_quantity = map_to_device<int>(h_lo_quantity, catalog.lo_len, q);
+  int *d_lo_extendedprice = map_to_device<int>(h_lo_extendedprice, catalog.lo_len, q);
+  int *d_lo_orderdate_min = map_to_device<int>(h_lo_orderdate_zm.zone_min, h_lo_orderdate_zm.num_zones, q);
+  int *d_lo_orderdate_max = map_to_device<int>(h_lo_orderdate_zm.zone_max, h_lo_orderdate_zm.num_zones, q);
+  int *d_d_datekey = map_to_device<int>(h_d_datekey, catalog.d_len, q);
+  int *d_d_year = map_to_device<int>(h_d_year, catalog.d_len, q);
 
   cout << "** LOADED DATA TO DEVICE: " << dev_name << " **"<< endl;
 
+  // --persistent: a fixed number of work-groups loops over the tiles
+  bool persistent = hasFlag(argc, argv, "--persistent");
+
+  // tile shape: tuned with --tune, else read from the tuning cache
+  tile_config config = load_tile_config(q, "q11");
+  if (tuning_requested(argc, argv)) {
+    config = autotune_tile_config(q, "q11", [&](auto shape) {
+      using S = decltype(shape);
+      return run_query<BlockIo::direct, S::block_threads, S::items_per_thread>(q, d_lo_orderdate,
+          d_lo_orderdate_min, d_lo_orderdate_max, h_lo_orderdate_zm.zone_size, d_lo_discount,
+          d_lo_quantity, d_lo_extendedprice, catalog.lo_len, persistent, false);
+    });
+  }
+  cout << "Tile <" << config.block_threads << "," << config.items_per_thread << ">" << endl;
+
   for (int t = 0; t < num_trials; t++) {
-      run_query(q, d_lo_orderdate, d_lo_discount, 
-          d_lo_quantity, d_lo_extendedprice, LO_LEN);    
+    dispatch_tile_config(config, [&](auto shape) {
+      using S = decltype(shape);
+      run_query<BlockIo::direct, S::block_threads, S::items_per_thread>(q, d_lo_orderdate,
+          d_lo_orderdate_min, d_lo_orderdate_max, h_lo_orderdate_zm.zone_size, d_lo_discount,
+          d_lo_quantity, d_lo_extendedprice, catalog.lo_len, persistent);
+      run_query<BlockIo::subgroup, S::block_threads, S::items_per_thread>(q, d_lo_orderdate,
+          d_lo_orderdate_min, d_lo_orderdate_max, h_lo_orderdate_zm.zone_size, d_lo_discount,
+          d_lo_quantity, d_lo_extendedprice, catalog.lo_len, persistent);
+    });
   }
 
   return 0;
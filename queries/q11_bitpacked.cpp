@@ -0,0 +1,212 @@
+#include <CL/sycl.hpp>
+
+#include <iostream>
+#include <oneapi/mkl.hpp>
+
+#include <oneapi_crystal/crystal.hpp>
+
+#include "ssb_utils.h"
+#include "../oneapi_crystal/tools/queue_helpers.hpp"
+#include "../oneapi_crystal/tools/duration_logger.hpp"
+#include "../oneapi_crystal/utils/atomic.hpp"
+
+
+#define TILE_SIZE (block_threads * items_per_thread)
+
+using namespace crystal;
+using namespace std;
+
+// Q1.1 over the bit-packed lineorder columns:
+// same plan as q11, but every tile is decoded
+// while being loaded
+template<int block_threads, int items_per_thread>
+void query_kernel (
+  uint32_t* lo_orderdate_starts, uint32_t* lo_orderdate,
+  uint32_t* lo_discount_starts, uint32_t* lo_discount,
+  uint32_t* lo_quantity_starts, uint32_t* lo_quantity,
+  uint32_t* lo_extendedprice_starts, uint32_t* lo_extendedprice,
+  int lo_num_entries,
+  unsigned long long* revenue,
+  sycl::nd_item<1> item_ct1
+)
+{
+  int items[items_per_thread];
+  int selection_flags[items_per_thread];
+  int items2[items_per_thread];
+
+  unsigned long long sum = 0;
+
+  int tile_offset = item_ct1.get_group(0) * TILE_SIZE;
+  int num_tiles = (lo_num_entries + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item_ct1.get_group(0) == num_tiles - 1) {
+    num_tile_items = lo_num_entries - tile_offset;
+  }
+
+  load_bitpacked<int, block_threads, items_per_thread>(lo_orderdate_starts, lo_orderdate,
+      tile_offset, items, num_tile_items, item_ct1);
+  predicate_gt<int, block_threads, items_per_thread>(items, 19930000, selection_flags, num_tile_items, item_ct1);
+  predicate_and_lt<int, block_threads, items_per_thread>(items, 19940000, selection_flags, num_tile_items, item_ct1);
+
+  load_bitpacked<int, block_threads, items_per_thread>(lo_quantity_starts, lo_quantity,
+      tile_offset, items, num_tile_items, item_ct1);
+  predicate_and_lt<int, block_threads, items_per_thread>(items, 25, selection_flags, num_tile_items, item_ct1);
+
+  load_bitpacked<int, block_threads, items_per_thread>(lo_discount_starts, lo_discount,
+      tile_offset, items, num_tile_items, item_ct1);
+  predicate_and_gte<int, block_threads, items_per_thread>(items, 1, selection_flags, num_tile_items, item_ct1);
+  predicate_and_lte<int, block_threads, items_per_thread>(items, 3, selection_flags, num_tile_items, item_ct1);
+
+  load_bitpacked<int, block_threads, items_per_thread>(lo_extendedprice_starts, lo_extendedprice,
+      tile_offset, items2, num_tile_items, item_ct1);
+
+  #pragma unroll
+  for (int item = 0; item < items_per_thread; ++item)
+  {
+    if ((item_ct1.get_local_id(0) + (block_threads * item) < num_tile_items))
+      if (selection_flags[item])
+        sum += items[item] * items2[item];
+  }
+
+  unsigned long long aggregate = sycl::reduce_over_group(item_ct1.get_group(), sum, sycl::plus<>());
+
+  if (item_ct1.get_local_id(0) == 0) {
+    atomicAdd(*revenue, aggregate);
+  }
+}
+
+
+void run_query(
+  sycl::queue &q,
+  int *lo_orderdate, int lo_orderdate_blocks,
+  int *lo_discount, int lo_discount_blocks,
+  int *lo_quantity, int lo_quantity_blocks,
+  int *lo_extendedprice, int lo_extendedprice_blocks,
+  int lo_num_entries
+)
+{
+  try {
+    chrono::high_resolution_clock::time_point st, finish;
+    st = chrono::high_resolution_clock::now();
+
+    unsigned long long* d_sum = nullptr;
+    d_sum = (unsigned long long*)malloc_device(sizeof(unsigned long long), q);
+
+    q.memset(d_sum, 0, sizeof(unsigned long long)).wait();
+
+    uint32_t *orderdate_starts = bitpackedBlockStarts(lo_orderdate);
+    uint32_t *orderdate_data = bitpackedData(lo_orderdate, lo_orderdate_blocks);
+    uint32_t *discount_starts = bitpackedBlockStarts(lo_discount);
+    uint32_t *discount_data = bitpackedData(lo_discount, lo_discount_blocks);
+    uint32_t *quantity_starts = bitpackedBlockStarts(lo_quantity);
+    uint32_t *quantity_data = bitpackedData(lo_quantity, lo_quantity_blocks);
+    uint32_t *extendedprice_starts = bitpackedBlockStarts(lo_extendedprice);
+    uint32_t *extendedprice_data = bitpackedData(lo_extendedprice, lo_extendedprice_blocks);
+
+    // Run ----------------------
+    int tile_items = 128 * 4;
+
+    int n_threads = 128;
+    int n_blocks = (lo_num_entries + tile_items - 1)/tile_items;
+
+    q.submit([&](sycl::handler &h){
+
+        h.parallel_for<class q11_bitpacked>(sycl::nd_range<1>(n_blocks * n_threads, n_threads),
+         [=](auto& it)
+        {
+          query_kernel<128, 4>(orderdate_starts, orderdate_data,
+            discount_starts, discount_data, quantity_starts, quantity_data,
+            extendedprice_starts, extendedprice_data, lo_num_entries, d_sum, it);
+        });
+
+    }).wait();
+    // --------------------------
+
+    // copy results
+    unsigned long long revenue;
+    q.memcpy(&revenue, d_sum, sizeof(unsigned long long)).wait();
+
+    finish = chrono::high_resolution_clock::now();
+    std::chrono::duration<double> diff = finish - st;
+
+    std::cout << "Revenue: " << revenue << endl;
+    std::cout << "Time Taken Total: " << diff.count() * 1000 << endl;
+
+    sycl::free(d_sum, q);
+  }
+  catch (sycl::exception const &exc) {
+    std::cerr << exc.what() << "Exception caught at file:" << __FILE__
+              << ", line:" << __LINE__ << std::endl;
+    std::exit(1);
+  }
+}
+
+/**
+ * Main
+ */
+int main(int argc, char** argv)
+{
+  initCatalog(argc, argv);
+  auto q = try_get_queue(sycl::default_selector{});
+
+  // device
+  auto dev_name = q.get_device().get_info<sycl::info::device::name>();
+  std::cout <<"Running on " << dev_name << '\n' ;
+
+  // number of running trials
+  int num_trials          = 3;
+
+  // loading data
+  BitpackedColumn h_lo_orderdate = mapBitpackedColumn("lo_orderdate");
+  BitpackedColumn h_lo_discount = mapBitpackedColumn("lo_discount");
+  BitpackedColumn h_lo_quantity = mapBitpackedColumn("lo_quantity");
+  BitpackedColumn h_lo_extendedprice = mapBitpackedColumn("lo_extendedprice");
+
+  if (h_lo_orderdate.words == NULL || h_lo_discount.words == NULL ||
+      h_lo_quantity.words == NULL || h_lo_extendedprice.words == NULL) {
+    cerr << "[Error] Bit-packed columns not found in " << catalog.data_dir
+         << ", build ssb/loader with 'make bitpack' and transform again" << endl;
+    return 1;
+  }
+
+  // the kernel decodes catalog.lo_len rows: every column must hold them
+  // all, and its block offsets must fit in the file
+  BitpackedColumn *cols[] = {&h_lo_orderdate, &h_lo_discount, &h_lo_quantity, &h_lo_extendedprice};
+  const char *col_names[] = {"lo_orderdate", "lo_discount", "lo_quantity", "lo_extendedprice"};
+  int num_blocks = (catalog.lo_len + bitpack_block_size - 1) / bitpack_block_size;
+  for (int c = 0; c < 4; c++) {
+    if (cols[c]->num_entries != catalog.lo_len || cols[c]->num_blocks != num_blocks ||
+        cols[c]->num_words < 2 + num_blocks + 1 ||
+        bitpackedBlockStarts(cols[c]->words)[num_blocks] > (uint32_t)(cols[c]->num_words - (2 + num_blocks + 1))) {
+      cerr << "[Error] " << col_names[c] << ".bp holds " << cols[c]->num_entries << " rows in "
+           << cols[c]->num_blocks << " blocks, expected " << catalog.lo_len << " rows in "
+           << num_blocks << " blocks: transform the dataset again" << endl;
+      return 1;
+    }
+  }
+
+  cout << "** LOADED DATA **" << endl;
+  cout << "LO_LEN " << catalog.lo_len << endl;
+  cout << "PACKED BYTES " << sizeof(int) * ((long)h_lo_orderdate.num_words + h_lo_discount.num_words
+      + h_lo_quantity.num_words + h_lo_extendedprice.num_words)
+      << " (PLAIN " << sizeof(int) * 4L * catalog.lo_len << ")" << endl;
+
+  // loading data to the device
+  int *d_lo_orderdate = map_to_device<int>(h_lo_orderdate.words, h_lo_orderdate.num_words, q);
+  int *d_lo_discount = map_to_device<int>(h_lo_discount.words, h_lo_discount.num_words, q);
+  int *d_lo_quantity = map_to_device<int>(h_lo_quantity.words, h_lo_quantity.num_words, q);
+  int *d_lo_extendedprice = map_to_device<int>(h_lo_extendedprice.words, h_lo_extendedprice.num_words, q);
+
+  cout << "** LOADED DATA TO DEVICE: " << dev_name << " **"<< endl;
+
+  for (int t = 0; t < num_trials; t++) {
+      run_query(q, d_lo_orderdate, h_lo_orderdate.num_blocks,
+          d_lo_discount, h_lo_discount.num_blocks,
+          d_lo_quantity, h_lo_quantity.num_blocks,
+          d_lo_extendedprice, h_lo_extendedprice.num_blocks,
+          catalog.lo_len);
+  }
+
+  return 0;
+}
@@ -0,0 +1,132 @@
+#include <CL/sycl.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+#include <oneapi_crystal/crystal.hpp>
+#include <oneapi_crystal/cpu/block_functions.hpp>
+
+#include "ssb_utils.h"
+
+// a tile per host thread, see oneapi_crystal/cpu/block_functions.hpp
+#define TILE_SIZE (block_threads * items_per_thread)
+#define CPU_TILE_ITEMS 2048
+
+using namespace crystal;
+using namespace std;
+
+/**
+ * Q1.1 on the native CPU backend: the same block functions as the
+ * kernel of q11.cpp, resolved to their SIMD versions on a tile_item
+ */
+template<int block_threads, int items_per_thread>
+unsigned long long query_tile (
+  int* lo_orderdate,
+  int* lo_orderdate_min,
+  int* lo_orderdate_max,
+  int zone_size,
+  int* lo_discount,
+  int* lo_quantity,
+  int* lo_extendedprice,
+  int lo_num_entries,
+  cpu::tile_item item
+)
+{
+  int items[items_per_thread];
+  int selection_flags[items_per_thread];
+  int items2[items_per_thread];
+
+  int tile_offset = item.get_group(0) * TILE_SIZE;
+  int num_tiles = (lo_num_entries + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item.get_group(0) == num_tiles - 1) {
+    num_tile_items = lo_num_entries - tile_offset;
+  }
+
+  // no date of the tile in 1993: skip it
+  if (!zone_map_may_match<int>(lo_orderdate_min, lo_orderdate_max, zone_size,
+        tile_offset, num_tile_items, 19930001, 19939999)) {
+    return 0;
+  }
+
+  load<int, block_threads, items_per_thread>(lo_orderdate + tile_offset, items, num_tile_items, item);
+  predicate_gt<int, block_threads, items_per_thread>(items, 19930000, selection_flags, num_tile_items, item);
+  predicate_and_lt<int, block_threads, items_per_thread>(items, 19940000, selection_flags, num_tile_items, item);
+
+  load<int, block_threads, items_per_thread>(lo_quantity + tile_offset, items, num_tile_items, item);
+  predicate_and_lt<int, block_threads, items_per_thread>(items, 25, selection_flags, num_tile_items, item);
+
+  load<int, block_threads, items_per_thread>(lo_discount + tile_offset, items, num_tile_items, item);
+  predicate_and_gte<int, block_threads, items_per_thread>(items, 1, selection_flags, num_tile_items, item);
+  predicate_and_lte<int, block_threads, items_per_thread>(items, 3, selection_flags, num_tile_items, item);
+
+  load<int, block_threads, items_per_thread>(lo_extendedprice + tile_offset, items2, num_tile_items, item);
+
+  return cpu::block_sum_product<block_threads, items_per_thread>(items, items2, selection_flags, num_tile_items, item);
+}
+
+void run_query(
+  int *lo_orderdate,
+  int *lo_orderdate_min,
+  int *lo_orderdate_max,
+  int zone_size,
+  int *lo_discount,
+  int *lo_quantity,
+  int *lo_extendedprice,
+  int lo_num_entries
+)
+{
+  chrono::high_resolution_clock::time_point st, finish;
+  st = chrono::high_resolution_clock::now();
+
+  std::atomic<unsigned long long> revenue(0);
+
+  cpu::for_each_tile<1, CPU_TILE_ITEMS>(lo_num_entries, [&](cpu::tile_item item) {
+    unsigned long long sum = query_tile<1, CPU_TILE_ITEMS>(lo_orderdate, lo_orderdate_min,
+        lo_orderdate_max, zone_size, lo_discount, lo_quantity, lo_extendedprice,
+        lo_num_entries, item);
+    if (sum != 0) {
+      revenue += sum;
+    }
+  });
+
+  finish = chrono::high_resolution_clock::now();
+  std::chrono::duration<double> diff = finish - st;
+
+  std::cout << "Revenue: " << revenue << endl;
+  std::cout << "Time Taken Total: " << diff.count() * 1000 << endl;
+}
+
+/**
+ * Main
+ */
+int main(int argc, char** argv)
+{
+  initCatalog(argc, argv);
+
+  std::cout << "Running on the host CPU (" << cpu::simd::isa << ", "
+            << std::thread::hardware_concurrency() << " threads)" << '\n';
+
+  // number of running trials
+  int num_trials          = 3;
+
+  // loading data
+  int *h_lo_orderdate = mapColumn<int>("lo_orderdate", catalog.lo_len);
+  int *h_lo_discount = mapColumn<int>("lo_discount", catalog.lo_len);
+  int *h_lo_quantity = mapColumn<int>("lo_quantity", catalog.lo_len);
+  int *h_lo_extendedprice = mapColumn<int>("lo_extendedprice", catalog.lo_len);
+  ZoneMap h_lo_orderdate_zm = loadZoneMap("lo_orderdate", catalog.lo_len);
+
+  cout << "** LOADED DATA **" << endl;
+  cout << "LO_LEN " << catalog.lo_len << endl;
+
+  for (int t = 0; t < num_trials; t++) {
+      run_query(h_lo_orderdate, h_lo_orderdate_zm.zone_min, h_lo_orderdate_zm.zone_max,
+          h_lo_orderdate_zm.zone_size, h_lo_discount,
+          h_lo_quantity, h_lo_extendedprice, catalog.lo_len);
+  }
+
+  return 0;
+}
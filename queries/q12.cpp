@@ -19,6 +19,9 @@ using namespace std;
 template<int block_threads, int items_per_thread>
 void device_select_if(
     int* lo_orderdate, 
+    int* lo_orderdate_min, 
+    int* lo_orderdate_max, 
+    int zone_size, 
     int* lo_discount, 
     int* lo_quantity, 
     int* lo_extendedprice,
@@ -42,6 +45,12 @@ void device_select_if(
     num_tile_items = lo_num_entries - tile_offset;
   }
 
+  // no date of the tile in January 1994: skip it
+  if (!zone_map_may_match<int>(lo_orderdate_min, lo_orderdate_max, zone_size,
+        tile_offset, num_tile_items, 19940101, 19940131)) {
+    return;
+  }
+
   load<int, block_threads, items_per_thread>(lo_orderdate + tile_offset, items, num_tile_items, item_ct1);
   predicate_gte<int, block_threads, items_per_thread>(items, 19940101, selection_flags, num_tile_items, item_ct1);
   predicate_and_lte<int, block_threads, items_per_thread>(items, 19940131, selection_flags, num_tile_items, item_ct1);
@@ -78,6 +87,9 @@ void device_select_if(
 void run_query(
     sycl::queue &q,
     int *lo_orderdate, 
+    int *lo_orderdate_min, 
+    int *lo_orderdate_max, 
+    int zone_size, 
     int *lo_discount, 
     int *lo_quantity,
     int *lo_extendedprice, 
@@ -104,7 +116,7 @@ void run_query(
 
                     h.parallel_for<class query_kernel>(sycl::nd_range<1>({static_cast<size_t>(num_blocks*128)},{128}),
                         [=](auto& it) {
-                        device_select_if<128,4>(lo_orderdate,
+                        device_select_if<128,4>(lo_orderdate, lo_orderdate_min, lo_orderdate_max, zone_size,
                             lo_discount, lo_quantity, lo_extendedprice, lo_num_entries, d_sum, it);
                         });
 
@@ -130,6 +142,7 @@ void run_query(
 
 int main(int argc, char** argv)
 {
+  initCatalog(argc, argv);
   auto q = try_get_queue(sycl::default_selector{});
   // device
   auto dev_name = q.get_device().get_info<sycl::info::device::name>();
@@ -138,26 +151,30 @@ int main(int argc, char** argv)
   // number of running trials
   int num_trials          = 3;
 
-  int *h_lo_orderdate = loadColumn<int>("lo_orderdate", LO_LEN);
-  int *h_lo_discount = loadColumn<int>("lo_discount", LO_LEN);
-  int *h_lo_quantity = loadColumn<int>("lo_quantity", LO_LEN);
-  int *h_lo_extendedprice = loadColumn<int>("lo_extendedprice", LO_LEN);
-  int *h_d_datekey = loadColumn<int>("d_datekey", D_LEN);
-  int *h_d_year = loadColumn<int>("d_year", D_LEN);
+  int *h_lo_orderdate = mapColumn<int>("lo_orderdate", catalog.lo_len);
+  int *h_lo_discount = mapColumn<int>("lo_discount", catalog.lo_len);
+  int *h_lo_quantity = mapColumn<int>("lo_quantity", catalog.lo_len);
+  int *h_lo_extendedprice = mapColumn<int>("lo_extendedprice", catalog.lo_len);
+  ZoneMap h_lo_orderdate_zm = loadZoneMap("lo_orderdate", catalog.lo_len);
+  int *h_d_datekey = mapColumn<int>("d_datekey", catalog.d_len);
+  int *h_d_year = mapColumn<int>("d_year", catalog.d_len);
 
   cout << "** LOADED DATA **" << endl;
 
-  int *d_lo_orderdate = load_to_device<int>(h_lo_orderdate, LO_LEN, q);
-  int *d_lo_discount = load_to_device<int>(h_lo_discount, LO_LEN, q);
-  int *d_lo_quantity = load_to_device<int>(h_lo_quantity, LO_LEN, q);
-  int *d_lo_extendedprice = load_to_device<int>(h_lo_extendedprice, LO_LEN, q);
-  int *d_d_datekey = load_to_device<int>(h_d_datekey, D_LEN, q);
-  int *d_d_year = load_to_device<int>(h_d_year, D_LEN, q);
+  int *d_lo_orderdate = map_to_device<int>(h_lo_orderdate, catalog.lo_len, q);
+  int *d_lo_discount = map_to_device<int>(h_lo_discount, catalog.lo_len, q);
+  int *d_lo_quantity = map_to_device<int>(h_lo_quantity, catalog.lo_len, q);
+  int *d_lo_extendedprice = map_to_device<int>(h_lo_extendedprice, catalog.lo_len, q);
+  int *d_lo_orderdate_min = map_to_device<int>(h_lo_orderdate_zm.zone_min, h_lo_orderdate_zm.num_zones, q);
+  int *d_lo_orderdate_max = map_to_device<int>(h_lo_orderdate_zm.zone_max, h_lo_orderdate_zm.num_zones, q);
+  int *d_d_datekey = map_to_device<int>(h_d_datekey, catalog.d_len, q);
+  int *d_d_year = map_to_device<int>(h_d_year, catalog.d_len, q);
 
   cout << "** LOADED DATA TO DEVICE: " << dev_name << " **"<< endl;
 
   for (int t = 0; t < num_trials; t++) {
-    run_query(q, d_lo_orderdate, d_lo_discount, d_lo_quantity, d_lo_extendedprice, LO_LEN);
+    run_query(q, d_lo_orderdate, d_lo_orderdate_min, d_lo_orderdate_max, h_lo_orderdate_zm.zone_size,
+        d_lo_discount, d_lo_quantity, d_lo_extendedprice, catalog.lo_len);
   }
 
   return 0;
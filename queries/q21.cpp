@@ -1,13 +1,20 @@
 #include <CL/sycl.hpp>
 
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <oneapi/mkl.hpp>
 
 #include <oneapi_crystal/crystal.hpp>
 
 #include "ssb_utils.h"
 #include "../oneapi_crystal/tools/queue_helpers.hpp"
+#include "../oneapi_crystal/tools/autotune.hpp"
+#include "../oneapi_crystal/tools/chunk_stream.hpp"
 #include "../oneapi_crystal/tools/duration_logger.hpp"
+#include "../oneapi_crystal/tools/event_dag.hpp"
+#include "../oneapi_crystal/tools/multi_device.hpp"
+#include "../oneapi_crystal/tools/usm_pool.hpp"
 #include "../oneapi_crystal/utils/atomic.hpp"
 
 
@@ -26,11 +33,19 @@ void probe_kernel (
     int lo_len,
     int* ht_s, 
     int s_len,
+    uint32_t* bloom_s,
+    int bloom_s_len,
     int* ht_p, 
     int p_len,
     int* ht_d, 
     int d_len,
-    int* res, 
+    uint64_t* res_keys,
+    long long* res_revenue,
+    int res_len,
+    int* res_overflow,
+    uint64_t* local_keys,
+    long long* local_revenue,
+    int* tile_counter,
     sycl::nd_item<1> item_ct1
 ) 
 {
@@ -40,47 +55,59 @@ void probe_kernel (
   int brand[items_per_thread];
   int year[items_per_thread];
   int revenue[items_per_thread];
+  uint64_t groups[items_per_thread];
 
-  int tile_offset = item_ct1.get_group(0) * TILE_SIZE;
   int num_tiles = (lo_len + TILE_SIZE - 1) / TILE_SIZE;
-  int num_tile_items = TILE_SIZE;
+  int local_len = get_linear_ht_len(TILE_SIZE);
 
-  if (item_ct1.get_group(0) == num_tiles - 1) {
-    num_tile_items = lo_len - tile_offset;
-  }
+  // the local table pre-aggregates all the tiles of the work-group
+  group_by_local_init<uint64_t, Sum, block_threads>(local_keys, local_revenue, local_len, item_ct1);
+  item_ct1.barrier(sycl::access::fence_space::local_space);
 
-  init_flags<block_threads, items_per_thread>(selection_flags);
+  // a single tile unless the launch is persistent
+  for_each_tile(num_tiles, tile_counter, item_ct1, [&](int tile) {
+    int tile_offset = tile * TILE_SIZE;
+    int num_tile_items = TILE_SIZE;
 
-  load<int, block_threads, items_per_thread>(lo_suppkey + tile_offset, items, num_tile_items, item_ct1);
-  probe_1<int, block_threads, items_per_thread>(items, selection_flags, ht_s, s_len, num_tile_items, item_ct1);
+    if (tile == num_tiles - 1) {
+      num_tile_items = lo_len - tile_offset;
+    }
 
-  load<int, block_threads, items_per_thread>(lo_partkey + tile_offset, items, num_tile_items, item_ct1);
-  probe_2<int, int, block_threads, items_per_thread>(items, brand, selection_flags,
-      ht_p, p_len, num_tile_items, item_ct1);
+    init_flags<block_threads, items_per_thread>(selection_flags);
 
-  load<int, block_threads, items_per_thread>(lo_orderdate + tile_offset, items, num_tile_items, item_ct1);
-  probe_2<int, int, block_threads, items_per_thread>(items, year, selection_flags,
-      ht_d, d_len, 19920101, num_tile_items, item_ct1);
+    load<int, block_threads, items_per_thread>(lo_suppkey + tile_offset, items, num_tile_items, item_ct1);
+    probe_bloom<int, block_threads, items_per_thread>(items, selection_flags, bloom_s, bloom_s_len, num_tile_items, item_ct1);
+    probe_1<int, block_threads, items_per_thread>(items, selection_flags, ht_s, s_len, num_tile_items, item_ct1);
 
-  load<int, block_threads, items_per_thread>(lo_revenue + tile_offset, revenue, num_tile_items, item_ct1);
+    load<int, block_threads, items_per_thread>(lo_partkey + tile_offset, items, num_tile_items, item_ct1);
+    probe_2<int, int, block_threads, items_per_thread>(items, brand, selection_flags,
+        ht_p, p_len, num_tile_items, item_ct1);
 
-  #pragma unroll
-  for (int ITEM = 0; ITEM < items_per_thread; ++ITEM) {
-    if ((item_ct1.get_local_id(0) + (block_threads * ITEM)) < num_tile_items) {
-      if (selection_flags[ITEM]) {
-        int hash = (brand[ITEM] * 7 +  (year[ITEM] - 1992)) % ((1998-1992+1) * (5*5*40));
-        res[hash * 4] = year[ITEM];
-        res[hash * 4 + 1] = brand[ITEM];
+    load<int, block_threads, items_per_thread>(lo_orderdate + tile_offset, items, num_tile_items, item_ct1);
+    probe_linear_2<int, int, block_threads, items_per_thread>(items, year, selection_flags,
+        ht_d, d_len, num_tile_items, item_ct1);
 
-        atomicAdd(res[hash * 4 + 2], revenue[ITEM]);
-      }
+    load<int, block_threads, items_per_thread>(lo_revenue + tile_offset, revenue, num_tile_items, item_ct1);
+
+    #pragma unroll
+    for (int ITEM = 0; ITEM < items_per_thread; ++ITEM) {
+      groups[ITEM] = group_key(year[ITEM], brand[ITEM]);
     }
-  }
+
+    group_by_local_fold<uint64_t, int, Sum, block_threads, items_per_thread>(groups, revenue, selection_flags,
+        Sum(), local_keys, local_revenue, local_len, res_keys, res_revenue, res_len, res_overflow,
+        num_tile_items, item_ct1);
+  });
+
+  // merge the local table into res once per work-group
+  item_ct1.barrier(sycl::access::fence_space::local_space);
+  group_by_local_flush<uint64_t, Sum, block_threads>(Sum(), local_keys, local_revenue, local_len,
+      res_keys, res_revenue, res_len, res_overflow, item_ct1);
 }
 
 template<int block_threads, int items_per_thread>
 void build_hashtable_s(int *filter_col, int *dim_key, int num_tuples, int *hash_table, int num_slots,
-                       sycl::nd_item<1> item_ct1) {
+                       uint32_t *filter, int filter_len, sycl::nd_item<1> item_ct1) {
   int items[items_per_thread];
   int selection_flags[items_per_thread];
 
@@ -98,6 +125,8 @@ void build_hashtable_s(int *filter_col, int *dim_key, int num_tuples, int *hash_
   load<int, block_threads, items_per_thread>(dim_key + tile_offset, items, num_tile_items, item_ct1);
   build_selective_1<int, block_threads, items_per_thread>(items, selection_flags,
       hash_table, num_slots, num_tile_items, item_ct1);
+  build_bloom<int, block_threads, items_per_thread>(items, selection_flags,
+      filter, filter_len, num_tile_items, item_ct1);
 }
 
 template<int block_threads, int items_per_thread>
@@ -125,7 +154,7 @@ void build_hashtable_p(int *filter_col, int *dim_key, int *dim_val, int num_tupl
 }
 
 template<int block_threads, int items_per_thread>
-void build_hashtable_d(int *dim_key, int *dim_val, int num_tuples, int *hash_table, int num_slots, int val_min,
+void build_hashtable_d(int *dim_key, int *dim_val, int num_tuples, int *hash_table, int num_slots,
                        sycl::nd_item<1> item_ct1) {
   int items[items_per_thread];
   int items2[items_per_thread];
@@ -143,11 +172,22 @@ void build_hashtable_d(int *dim_key, int *dim_val, int num_tuples, int *hash_tab
 
   load<int, block_threads, items_per_thread>(dim_key + tile_offset, items, num_tile_items, item_ct1);
   load<int, block_threads, items_per_thread>(dim_val + tile_offset, items2, num_tile_items, item_ct1);
-  build_selective_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags,
-      hash_table, num_slots, val_min, num_tile_items, item_ct1);
+  build_selective_linear_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags,
+      hash_table, num_slots, num_tile_items, item_ct1);
 }
 
-void run_query ( 
+template<int block_threads, int items_per_thread> class build_s;
+template<int block_threads, int items_per_thread> class build_p;
+template<int block_threads, int items_per_thread> class build_d;
+template<int block_threads, int items_per_thread> class Probe;
+
+// returns the elapsed time in ms, printing the result when verbose;
+// with chunk_items > 0 the lo_* columns are host columns streamed
+// through the device chunk_items rows at a time; the (key, revenue)
+// groups are appended to groups if given, and the time of the probe
+// alone (the builds done) is returned in time_probe if given
+template<int block_threads, int items_per_thread>
+float run_query ( 
   sycl::queue &q,
   int *lo_orderdate, 
   int *lo_partkey, 
@@ -163,112 +203,211 @@ void run_query (
   int d_len, 
   int *s_suppkey, 
   int *s_region, 
-  int s_len
+  int s_len,
+  bool persistent = false,
+  int chunk_items = 0,
+  bool verbose = true,
+  std::vector<std::pair<uint64_t, long long>> *groups = nullptr,
+  float *time_probe = nullptr
 ) 
 {
+  float time_query = 0;
+
   try {
     int *ht_d, *ht_p, *ht_s;
-    int d_val_len = 19981230 - 19920101 + 1;
+    int d_val_len = get_linear_ht_len(d_len);
     
     chrono::high_resolution_clock::time_point st, finish;
     st = chrono::high_resolution_clock::now();
     
-    // allocating 
-    ht_d = (int*)malloc_device(2 * d_val_len * sizeof(int), q);
-    ht_p = (int*)malloc_device(2 * p_len * sizeof(int), q);
-    ht_s = (int*)malloc_device(2 * s_len * sizeof(int), q);
-
-    q.memset(ht_d, 0, 2 * d_val_len * sizeof(int)).wait();
-    q.memset(ht_p, 0, 2 * p_len * sizeof(int)).wait();
-    q.memset(ht_s, 0, 2 * s_len * sizeof(int)).wait();
+    // allocating: from the second run on the pool serves the same blocks
+    usm_pool &pool = get_usm_pool(q);
+    ht_d = (int*)pool.allocate(2 * d_val_len * sizeof(int));
+    ht_p = (int*)pool.allocate(2 * p_len * sizeof(int));
+    ht_s = (int*)pool.allocate(2 * s_len * sizeof(int));
+
+    // Bloom filter of the selected suppliers, probed before ht_s
+    int bloom_s_len = get_bloom_len(s_len);
+    uint32_t *bloom_s = (uint32_t*)pool.allocate(bloom_s_len * sizeof(uint32_t));
+
+    // the query is a DAG of events: the three dimension builds only
+    // depend on the zeroing of their own table and run concurrently,
+    // the host waits once, for the copy of the result
+    event_dag dag(q);
+
+    sycl::event zeroed_d = dag.memset(ht_d, 0, 2 * d_val_len * sizeof(int));
+    sycl::event zeroed_p = dag.memset(ht_p, 0, 2 * p_len * sizeof(int));
+    sycl::event zeroed_s = dag.memset(ht_s, 0, 2 * s_len * sizeof(int));
+    sycl::event zeroed_bloom = dag.memset(bloom_s, 0, bloom_s_len * sizeof(uint32_t));
 
     // Run ----------------------
-    int tile_items = 128 * 4; // replace with a define!
+    int tile_items = block_threads * items_per_thread;
     int num_blocks_s = (s_len + tile_items - 1)/tile_items;
 
-    q.submit([&](sycl::handler &h){
+    sycl::event built_s = dag.submit({zeroed_s, zeroed_bloom}, [&](sycl::handler &h){
 
-        h.parallel_for<class build_s>(sycl::nd_range<1>({static_cast<size_t>(num_blocks_s * 128)},{128}),
+        h.parallel_for<build_s<block_threads, items_per_thread>>(
+            sycl::nd_range<1>({static_cast<size_t>(num_blocks_s * block_threads)},{block_threads}),
             [=](sycl::nd_item<1>  it) {
-            build_hashtable_s<128,4>(s_region, s_suppkey, s_len, ht_s, s_len, it);
+            build_hashtable_s<block_threads, items_per_thread>(s_region, s_suppkey, s_len, ht_s, s_len, bloom_s, bloom_s_len, it);
             });
 
     });
 
     int num_blocks_p = (p_len + tile_items - 1)/tile_items;
-    q.submit([&](sycl::handler &h){
+    sycl::event built_p = dag.submit({zeroed_p}, [&](sycl::handler &h){
 
-        h.parallel_for<class build_p>(sycl::nd_range<1>({static_cast<size_t>(num_blocks_p * 128)},{128}),
+        h.parallel_for<build_p<block_threads, items_per_thread>>(
+            sycl::nd_range<1>({static_cast<size_t>(num_blocks_p * block_threads)},{block_threads}),
             [=](sycl::nd_item<1>  it) {
-            build_hashtable_p<128,4>(p_category, p_partkey, p_brand1, p_len, ht_p, p_len, it);
+            build_hashtable_p<block_threads, items_per_thread>(p_category, p_partkey, p_brand1, p_len, ht_p, p_len, it);
             });
 
     });
 
-    int d_val_min = 19920101;
     int num_blocks_d = (d_len + tile_items - 1)/tile_items;
-    q.submit([&](sycl::handler &h){
+    sycl::event built_d = dag.submit({zeroed_d}, [&](sycl::handler &h){
 
-        h.parallel_for<class build_d>(sycl::nd_range<1>({static_cast<size_t>(num_blocks_d * 128)}, {128}),
+        h.parallel_for<build_d<block_threads, items_per_thread>>(
+            sycl::nd_range<1>({static_cast<size_t>(num_blocks_d * block_threads)}, {block_threads}),
             [=](sycl::nd_item<1>  it) {
-            build_hashtable_d<128,4>(d_datekey, d_year, d_len, ht_d, d_val_len, d_val_min, it);
+            build_hashtable_d<block_threads, items_per_thread>(d_datekey, d_year, d_len, ht_d, d_val_len, it);
             });
 
     });
 
-    int *res;
-    int res_size = ((1998-1992+1) * (5 * 5 * 40));
-    int res_array_size = res_size * 4;
+    // (year, brand) groups, at most 7 * 1000 of them
+    int res_len = get_linear_ht_len((1998-1992+1) * 1000);
+    uint64_t *res_keys = (uint64_t*)pool.allocate(res_len * sizeof(uint64_t));
+    long long *res_revenue = (long long*)pool.allocate(res_len * sizeof(long long));
+    int *res_overflow = (int*)pool.allocate(sizeof(int));
+
+    std::vector<sycl::event> probe_deps = init_group_by_async(q, res_keys, res_revenue, res_len,
+        res_overflow, Sum());
+    probe_deps.insert(probe_deps.end(), {built_s, built_p, built_d});
+
+    // persistent: a few work-groups per compute unit claim the tiles
+    int *tile_counter = nullptr;
+    if (persistent) {
+      tile_counter = (int*)pool.allocate(sizeof(int));
+    }
+
+    // probes lo_len rows of lineorder; called once, or per chunk when streaming
+    sycl::event probed;
+    auto probe = [&](int *lo_orderdate, int *lo_partkey, int *lo_suppkey, int *lo_revenue,
+                     int lo_len, std::vector<sycl::event> deps) {
+      int num_blocks_lo = (lo_len + tile_items - 1)/tile_items;
+
+      if (persistent) {
+        // the counter is shared with the probe of the previous chunk
+        deps.push_back(probed);
+        deps.push_back(dag.memset(tile_counter, 0, sizeof(int), deps));
+        num_blocks_lo = get_persistent_groups(q, num_blocks_lo);
+      }
+
+      probed = dag.submit(deps, [&](sycl::handler &h){
+        sycl::local_accessor<uint64_t, 1> local_keys(sycl::range<1>(get_linear_ht_len(tile_items)), h);
+        sycl::local_accessor<long long, 1> local_revenue(sycl::range<1>(get_linear_ht_len(tile_items)), h);
+
+        h.parallel_for<Probe<block_threads, items_per_thread>>(
+            sycl::nd_range<1>({static_cast<size_t>(num_blocks_lo * block_threads)},{block_threads}),
+            [=](sycl::nd_item<1>  it) {
+            probe_kernel<block_threads, items_per_thread>(lo_orderdate, lo_partkey, lo_suppkey, lo_revenue, 
+                lo_len, ht_s, s_len, bloom_s, bloom_s_len, ht_p, p_len, ht_d, d_val_len,
+                res_keys, res_revenue, res_len, res_overflow, local_keys.get_pointer(), local_revenue.get_pointer(),
+                tile_counter, it);
+            });
 
-    res = (int*)malloc_device(res_array_size * sizeof(int), q);
-    q.memset(res, 0, res_array_size * sizeof(int)).wait();
+      });
+      return probed;
+    };
 
-    int num_blocks_lo = (lo_len + tile_items - 1)/tile_items;
-    q.submit([&](sycl::handler &h){
+    // timing the probe alone means waiting for the builds first
+    chrono::high_resolution_clock::time_point probe_st;
+    if (time_probe != nullptr) {
+      sycl::event::wait(probe_deps);
+      probe_st = chrono::high_resolution_clock::now();
+    }
 
-      h.parallel_for<class Probe>(sycl::nd_range<1>({static_cast<size_t>(num_blocks_lo * 128)},{128}),
-          [=](sycl::nd_item<1>  it) {
-          probe_kernel<128,4>(lo_orderdate, lo_partkey, lo_suppkey, lo_revenue, 
-              lo_len, ht_s, s_len, ht_p, p_len, ht_d, d_val_len, res, it);
+    if (chunk_items > 0) {
+      // lo_* are host columns: only the hash tables stay on the device
+      stream_chunks<int>(q, {lo_orderdate, lo_partkey, lo_suppkey, lo_revenue}, lo_len, chunk_items,
+          probe_deps, [&](const std::vector<int*> &lo, size_t offset, int len,
+                          const std::vector<sycl::event> &deps) {
+            return probe(lo[0], lo[1], lo[2], lo[3], len, deps);
           });
+    } else {
+      probe(lo_orderdate, lo_partkey, lo_suppkey, lo_revenue, lo_len, probe_deps);
+    }
 
-    }).wait();
+    if (time_probe != nullptr) {
+      probed.wait();
+      *time_probe = std::chrono::duration<double>(chrono::high_resolution_clock::now() - probe_st).count() * 1000.;
+    }
 
-    int* h_res = new int[res_array_size];
-    q.memcpy(h_res, res, res_array_size * sizeof(int)).wait();
+    uint64_t* h_res_keys = new uint64_t[res_len];
+    long long* h_res_revenue = new long long[res_len];
+    dag.memcpy(h_res_keys, res_keys, res_len * sizeof(uint64_t), {probed});
+    dag.memcpy(h_res_revenue, res_revenue, res_len * sizeof(long long), {probed});
+    dag.wait();
 
     finish = chrono::high_resolution_clock::now();
     std::chrono::duration<double> diff = finish - st;
     
-    int res_count = 0;
-    for (int i = 0; i < res_size; i++) {
-      if (h_res[4*i] != 0) {
-        cout << h_res[4*i] << " " << h_res[4*i + 1] << " " << reinterpret_cast<unsigned long long*>(&h_res[4*i + 2])[0]  << std::endl;
-        res_count += 1;
+    time_query = diff.count() * 1000.;
+
+    // groups left out of a full table would make the result wrong
+    if (!check_group_by_overflow(q, res_overflow, res_len)) {
+      std::exit(1);
+    }
+
+    if (verbose) {
+      int res_count = 0;
+      for (int i = 0; i < res_len; i++) {
+        if (h_res_keys[i] != group_empty_key<uint64_t>()) {
+          cout << (int)(h_res_keys[i] >> 32) << " " << (int)(h_res_keys[i] & 0xFFFFFFFF) << " " << h_res_revenue[i] << std::endl;
+          res_count += 1;
+        }
       }
+
+      cout << "Res Count: " << res_count << std::endl;
+      cout << "Time Taken Total: " << time_query << " ms" << endl;
     }
-    
-    cout << "Res Count: " << res_count << std::endl;
-    cout << "Time Taken Total: " << diff.count() * 1000. << " ms" << endl;
 
-    delete[] h_res;
+    if (groups != nullptr) {
+      for (int i = 0; i < res_len; i++) {
+        if (h_res_keys[i] != group_empty_key<uint64_t>()) {
+          groups->emplace_back(h_res_keys[i], h_res_revenue[i]);
+        }
+      }
+    }
 
-    sycl::free(res, q);
-    sycl::free(ht_d, q);
-    sycl::free(ht_p, q);
-    sycl::free(ht_s, q);
+    delete[] h_res_keys;
+    delete[] h_res_revenue;
+
+    pool.deallocate(res_keys);
+    pool.deallocate(res_revenue);
+    pool.deallocate(res_overflow);
+    pool.deallocate(ht_d);
+    pool.deallocate(ht_p);
+    pool.deallocate(ht_s);
+    pool.deallocate(bloom_s);
+    if (tile_counter) pool.deallocate(tile_counter);
   }
   catch (sycl::exception const &exc) {
     std::cerr << exc.what() << "Exception caught at file:" << __FILE__
               << ", line:" << __LINE__ << std::endl;
     std::exit(1);
   }
+
+  return time_query;
 }
 
 
 
 int main(int argc, char** argv)
 {
+  initCatalog(argc, argv);
   auto q = try_get_queue(sycl::default_selector{});
 
 
@@ -278,46 +417,174 @@ int main(int argc, char** argv)
   
   int num_trials          = 3;
 
-  int *h_lo_orderdate = loadColumn<int>("lo_orderdate", LO_LEN);
-  int *h_lo_partkey = loadColumn<int>("lo_partkey", LO_LEN);
-  int *h_lo_suppkey = loadColumn<int>("lo_suppkey", LO_LEN);
-  int *h_lo_revenue = loadColumn<int>("lo_revenue", LO_LEN);
-
-  int *h_p_partkey = loadColumn<int>("p_partkey", P_LEN);
-  int *h_p_brand1 = loadColumn<int>("p_brand1", P_LEN);
-  int *h_p_category = loadColumn<int>("p_category", P_LEN);
-
-  int *h_d_datekey = loadColumn<int>("d_datekey", D_LEN);
-  int *h_d_year = loadColumn<int>("d_year", D_LEN);
-
-  int *h_s_suppkey = loadColumn<int>("s_suppkey", S_LEN);
-  int *h_s_region = loadColumn<int>("s_region", S_LEN);
+  int *h_lo_orderdate = mapColumn<int>("lo_orderdate", catalog.lo_len);
+  int *h_lo_partkey = mapColumn<int>("lo_partkey", catalog.lo_len);
+  int *h_lo_suppkey = mapColumn<int>("lo_suppkey", catalog.lo_len);
+  int *h_lo_revenue = mapColumn<int>("lo_revenue", catalog.lo_len);
+
+  int *h_p_partkey = mapColumn<int>("p_partkey", catalog.p_len);
+  int *h_p_brand1 = mapColumn<int>("p_brand1", catalog.p_len);
+  int *h_p_category = mapColumn<int>("p_category", catalog.p_len);
+
+  int *h_d_datekey = mapColumn<int>("d_datekey", catalog.d_len);
+  int *h_d_year = mapColumn<int>("d_year", catalog.d_len);
+
+  int *h_s_suppkey = mapColumn<int>("s_suppkey", catalog.s_len);
+  int *h_s_region = mapColumn<int>("s_region", catalog.s_len);
+
+  // --chunk-rows <n>: lineorder stays on the host and is streamed
+  // through the device n rows at a time, for datasets too large for it
+  int chunk_items = flagValue(argc, argv, "--chunk-rows", 0);
+  bool streaming = chunk_items > 0;
+
+  // --persistent: a fixed number of work-groups loops over the tiles
+  bool persistent = hasFlag(argc, argv, "--persistent");
+
+  // --multi-device: lineorder is split across every device, each
+  // with its own copy of the dimension tables and hash tables and a
+  // copy of its own range of lineorder only
+  if (hasFlag(argc, argv, "--multi-device")) {
+    struct DeviceColumns {
+      int *lo_orderdate, *lo_partkey, *lo_suppkey, *lo_revenue;
+      int lo_begin, lo_end;
+      int *p_partkey, *p_brand1, *p_category;
+      int *d_datekey, *d_year;
+      int *s_suppkey, *s_region;
+      tile_config config;
+    };
+
+    multi_device_executor exec(get_all_queues());
+    std::vector<DeviceColumns> dev_cols;
+    int granularity = 0;
+
+    for (int d = 0; d < exec.size(); d++) {
+      sycl::queue &dq = exec.queue(d);
+      tile_config config = load_tile_config(dq, "q21");
+      cout << "Device " << d << ": " << dq.get_device().get_info<sycl::info::device::name>()
+           << ", tile <" << config.block_threads << "," << config.items_per_thread << ">" << endl;
+
+      // the lineorder range is only known once the run splits the rows
+      dev_cols.push_back({
+          nullptr, nullptr, nullptr, nullptr, 0, 0,
+          map_to_device<int>(h_p_partkey, catalog.p_len, dq),
+          map_to_device<int>(h_p_brand1, catalog.p_len, dq),
+          map_to_device<int>(h_p_category, catalog.p_len, dq),
+          map_to_device<int>(h_d_datekey, catalog.d_len, dq),
+          map_to_device<int>(h_d_year, catalog.d_len, dq),
+          map_to_device<int>(h_s_suppkey, catalog.s_len, dq),
+          map_to_device<int>(h_s_region, catalog.s_len, dq),
+          config});
+      granularity = std::max(granularity, config.block_threads * config.items_per_thread);
+    }
 
-  int *d_lo_orderdate = load_to_device<int>(h_lo_orderdate, LO_LEN, q);
-  int *d_lo_partkey = load_to_device<int>(h_lo_partkey, LO_LEN, q);
-  int *d_lo_suppkey = load_to_device<int>(h_lo_suppkey, LO_LEN, q); 
-  int *d_lo_revenue = load_to_device<int>(h_lo_revenue, LO_LEN, q);
+    for (int t = 0; t < num_trials; t++) {
+      std::map<uint64_t, long long> groups;
+      std::mutex groups_mutex;
+
+      chrono::high_resolution_clock::time_point st = chrono::high_resolution_clock::now();
+
+      exec.run(catalog.lo_len, granularity, [&](int d, sycl::queue &dq, int begin, int end) {
+        DeviceColumns &c = dev_cols[d];
+        std::vector<std::pair<uint64_t, long long>> partial;
+        float time_probe = 0;
+
+        // copy the range of the device, again only when the split moved it;
+        // streamed rows stay on the host
+        if (streaming) {
+          c.lo_orderdate = h_lo_orderdate + begin;
+          c.lo_partkey = h_lo_partkey + begin;
+          c.lo_suppkey = h_lo_suppkey + begin;
+          c.lo_revenue = h_lo_revenue + begin;
+        } else if (c.lo_begin != begin || c.lo_end != end || c.lo_orderdate == nullptr) {
+          if (c.lo_orderdate != nullptr && !is_zero_copy(dq)) {
+            for (int *col : {c.lo_orderdate, c.lo_partkey, c.lo_suppkey, c.lo_revenue}) {
+              sycl::free(col, dq);
+            }
+          }
+          c.lo_orderdate = map_to_device<int>(h_lo_orderdate + begin, end - begin, dq);
+          c.lo_partkey = map_to_device<int>(h_lo_partkey + begin, end - begin, dq);
+          c.lo_suppkey = map_to_device<int>(h_lo_suppkey + begin, end - begin, dq);
+          c.lo_revenue = map_to_device<int>(h_lo_revenue + begin, end - begin, dq);
+          c.lo_begin = begin;
+          c.lo_end = end;
+        }
+
+        dispatch_tile_config(c.config, [&](auto shape) {
+          using S = decltype(shape);
+          run_query<S::block_threads, S::items_per_thread>(dq,
+              c.lo_orderdate, c.lo_partkey, c.lo_suppkey, c.lo_revenue,
+              end - begin, c.p_partkey, c.p_brand1, c.p_category, catalog.p_len,
+              c.d_datekey, c.d_year, catalog.d_len, c.s_suppkey, c.s_region, catalog.s_len,
+              persistent, chunk_items, false, &partial, &time_probe);
+        });
+
+        std::lock_guard<std::mutex> lock(groups_mutex);
+        merge_groups(groups, partial);
+
+        // the throughput is the probe rate: builds and copies do not scale with the rows
+        return time_probe;
+      });
+
+      chrono::high_resolution_clock::time_point finish = chrono::high_resolution_clock::now();
+
+      for (const auto &group : groups) {
+        cout << (int)(group.first >> 32) << " " << (int)(group.first & 0xFFFFFFFF) << " " << group.second << std::endl;
+      }
+      cout << "Res Count: " << groups.size() << std::endl;
+      for (int d = 0; d < exec.size(); d++) {
+        cout << "Device " << d << " throughput: " << exec.throughput(d) << " rows/ms" << endl;
+      }
+      cout << "Time Taken Total: " << std::chrono::duration<double>(finish - st).count() * 1000. << " ms" << endl;
+    }
 
-  int *d_d_datekey = load_to_device<int>(h_d_datekey, D_LEN, q);
-  int *d_d_year = load_to_device<int>(h_d_year, D_LEN, q);
+    for (int d = 0; d < exec.size(); d++) {
+      get_usm_pool(exec.queue(d)).print_stats(cout);
+    }
 
-  int *d_p_partkey = load_to_device<int>(h_p_partkey, P_LEN, q);
-  int *d_p_brand1  = load_to_device<int>(h_p_brand1, P_LEN, q);
-  int *d_p_category = load_to_device<int>(h_p_category, P_LEN, q);
+    return 0;
+  }
 
-  int *d_s_suppkey = load_to_device<int>(h_s_suppkey, S_LEN, q);
-  int *d_s_region = load_to_device<int>(h_s_region, S_LEN, q);
+  int *d_lo_orderdate = streaming ? h_lo_orderdate : map_to_device<int>(h_lo_orderdate, catalog.lo_len, q);
+  int *d_lo_partkey = streaming ? h_lo_partkey : map_to_device<int>(h_lo_partkey, catalog.lo_len, q);
+  int *d_lo_suppkey = streaming ? h_lo_suppkey : map_to_device<int>(h_lo_suppkey, catalog.lo_len, q); 
+  int *d_lo_revenue = streaming ? h_lo_revenue : map_to_device<int>(h_lo_revenue, catalog.lo_len, q);
+
+  int *d_d_datekey = map_to_device<int>(h_d_datekey, catalog.d_len, q);
+  int *d_d_year = map_to_device<int>(h_d_year, catalog.d_len, q);
+
+  int *d_p_partkey = map_to_device<int>(h_p_partkey, catalog.p_len, q);
+  int *d_p_brand1  = map_to_device<int>(h_p_brand1, catalog.p_len, q);
+  int *d_p_category = map_to_device<int>(h_p_category, catalog.p_len, q);
+
+  int *d_s_suppkey = map_to_device<int>(h_s_suppkey, catalog.s_len, q);
+  int *d_s_region = map_to_device<int>(h_s_region, catalog.s_len, q);
+
+  // tile shape: tuned with --tune, else read from the tuning cache
+  auto launch = [&](auto shape, bool verbose) {
+    using S = decltype(shape);
+    return run_query<S::block_threads, S::items_per_thread>(q,
+        d_lo_orderdate, d_lo_partkey, d_lo_suppkey, d_lo_revenue, catalog.lo_len,
+        d_p_partkey, d_p_brand1, d_p_category, catalog.p_len,
+        d_d_datekey, d_d_year, catalog.d_len,
+        d_s_suppkey, d_s_region, catalog.s_len, persistent, chunk_items, verbose);
+  };
+
+  tile_config config = load_tile_config(q, "q21");
+  if (tuning_requested(argc, argv)) {
+    // the probe keeps a tile-sized group by table (keys and revenue) in local memory
+    config = autotune_tile_config(q, "q21", [&](auto shape) { return launch(shape, false); },
+        [](tile_config c) {
+          return get_linear_ht_len(c.block_threads * c.items_per_thread) * (sizeof(uint64_t) + sizeof(long long));
+        });
+  }
+  cout << "Tile <" << config.block_threads << "," << config.items_per_thread << ">" << endl;
 
   for (int t = 0; t < num_trials; t++) {
-        run_query (q,
-          d_lo_orderdate, d_lo_partkey, d_lo_suppkey, d_lo_revenue, LO_LEN,
-          d_p_partkey, d_p_brand1, d_p_category, P_LEN,
-          d_d_datekey, d_d_year, D_LEN,
-          d_s_suppkey, d_s_region, S_LEN
-        ); 
-    
+    dispatch_tile_config(config, [&](auto shape) { launch(shape, true); });
   }
 
+  get_usm_pool(q).print_stats(cout);
+
   return 0;
 }
  
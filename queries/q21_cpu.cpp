@@ -0,0 +1,280 @@
+#include <CL/sycl.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <oneapi_crystal/crystal.hpp>
+#include <oneapi_crystal/cpu/block_functions.hpp>
+
+#include "ssb_utils.h"
+
+// a tile per host thread, see oneapi_crystal/cpu/block_functions.hpp
+#define TILE_SIZE (block_threads * items_per_thread)
+#define CPU_TILE_ITEMS 2048
+
+using namespace crystal;
+using namespace std;
+
+// (year, brand) groups, dense over the years of date and the brands of part
+struct GroupRange {
+  int min_year;
+  int min_brand;
+  int num_brands;
+  int num_groups;
+};
+
+/**
+ * Q2.1 on the native CPU backend: the three joins of q21.cpp on open
+ * addressing tables, probed with gathers. About one supplier in five
+ * qualifies, so the tile is compacted after the supplier probe and the
+ * other columns are only gathered for the selected rows
+ */
+template<int block_threads, int items_per_thread>
+void probe_tile (
+  int* lo_orderdate,
+  int* lo_partkey,
+  int* lo_suppkey,
+  int* lo_revenue,
+  int lo_len,
+  int* ht_s,
+  int s_len,
+  int* ht_p,
+  int p_len,
+  int* ht_d,
+  int d_len,
+  GroupRange range,
+  std::atomic<long long>* res,
+  cpu::tile_item item
+)
+{
+  int items[items_per_thread];
+  int selection_flags[items_per_thread];
+  int selection[items_per_thread];
+  int brand[items_per_thread];
+  int year[items_per_thread];
+  int revenue[items_per_thread];
+
+  int tile_offset = item.get_group(0) * TILE_SIZE;
+  int num_tiles = (lo_len + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item.get_group(0) == num_tiles - 1) {
+    num_tile_items = lo_len - tile_offset;
+  }
+
+  init_flags<block_threads, items_per_thread>(selection_flags);
+
+  load<int, block_threads, items_per_thread>(lo_suppkey + tile_offset, items, num_tile_items, item);
+  probe_linear_1<int, block_threads, items_per_thread>(items, selection_flags, ht_s, s_len, num_tile_items, item);
+
+  int num_selected = block_compact<block_threads, items_per_thread>(selection_flags, selection,
+      num_tile_items, item);
+
+  load_selected<int, block_threads, items_per_thread>(lo_partkey + tile_offset, selection, items,
+      num_selected, item);
+  probe_linear_2<int, int, block_threads, items_per_thread>(items, brand, selection_flags,
+      ht_p, p_len, num_selected, item);
+
+  load_selected<int, block_threads, items_per_thread>(lo_orderdate + tile_offset, selection, items,
+      num_selected, item);
+  probe_linear_2<int, int, block_threads, items_per_thread>(items, year, selection_flags,
+      ht_d, d_len, num_selected, item);
+
+  load_selected<int, block_threads, items_per_thread>(lo_revenue + tile_offset, selection, revenue,
+      num_selected, item);
+
+  for (int i = 0; i < num_selected; i++) {
+    if (selection_flags[i]) {
+      int group = (year[i] - range.min_year) * range.num_brands + (brand[i] - range.min_brand);
+      res[group].fetch_add(revenue[i], std::memory_order_relaxed);
+    }
+  }
+}
+
+template<int block_threads, int items_per_thread>
+void build_hashtable_s(int *filter_col, int *dim_key, int num_tuples, int *hash_table, int num_slots,
+                       cpu::tile_item item) {
+  int items[items_per_thread];
+  int selection_flags[items_per_thread];
+
+  int tile_offset = item.get_group(0) * TILE_SIZE;
+  int num_tiles = (num_tuples + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item.get_group(0) == num_tiles - 1) {
+    num_tile_items = num_tuples - tile_offset;
+  }
+
+  load<int, block_threads, items_per_thread>(filter_col + tile_offset, items, num_tile_items, item);
+  predicate_eq<int, block_threads, items_per_thread>(items, 1, selection_flags, num_tile_items, item);
+
+  load<int, block_threads, items_per_thread>(dim_key + tile_offset, items, num_tile_items, item);
+  build_selective_linear_1<int, block_threads, items_per_thread>(items, selection_flags,
+      hash_table, num_slots, num_tile_items, item);
+}
+
+template<int block_threads, int items_per_thread>
+void build_hashtable_p(int *filter_col, int *dim_key, int *dim_val, int num_tuples, int *hash_table, int num_slots,
+                       cpu::tile_item item) {
+  int items[items_per_thread];
+  int items2[items_per_thread];
+  int selection_flags[items_per_thread];
+
+  int tile_offset = item.get_group(0) * TILE_SIZE;
+  int num_tiles = (num_tuples + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item.get_group(0) == num_tiles - 1) {
+    num_tile_items = num_tuples - tile_offset;
+  }
+
+  load<int, block_threads, items_per_thread>(filter_col + tile_offset, items, num_tile_items, item);
+  predicate_eq<int, block_threads, items_per_thread>(items, 1, selection_flags, num_tile_items, item);
+
+  load<int, block_threads, items_per_thread>(dim_key + tile_offset, items, num_tile_items, item);
+  load<int, block_threads, items_per_thread>(dim_val + tile_offset, items2, num_tile_items, item);
+  build_selective_linear_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags,
+      hash_table, num_slots, num_tile_items, item);
+}
+
+template<int block_threads, int items_per_thread>
+void build_hashtable_d(int *dim_key, int *dim_val, int num_tuples, int *hash_table, int num_slots,
+                       cpu::tile_item item) {
+  int items[items_per_thread];
+  int items2[items_per_thread];
+  int selection_flags[items_per_thread];
+
+  int tile_offset = item.get_group(0) * TILE_SIZE;
+  int num_tiles = (num_tuples + TILE_SIZE - 1) / TILE_SIZE;
+  int num_tile_items = TILE_SIZE;
+
+  if (item.get_group(0) == num_tiles - 1) {
+    num_tile_items = num_tuples - tile_offset;
+  }
+
+  init_flags<block_threads, items_per_thread>(selection_flags);
+
+  load<int, block_threads, items_per_thread>(dim_key + tile_offset, items, num_tile_items, item);
+  load<int, block_threads, items_per_thread>(dim_val + tile_offset, items2, num_tile_items, item);
+  build_selective_linear_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags,
+      hash_table, num_slots, num_tile_items, item);
+}
+
+void run_query(
+  int *lo_orderdate,
+  int *lo_partkey,
+  int *lo_suppkey,
+  int *lo_revenue,
+  int lo_len,
+  int *p_partkey,
+  int *p_brand1,
+  int *p_category,
+  int p_len,
+  int *d_datekey,
+  int *d_year,
+  int d_len,
+  int *s_suppkey,
+  int *s_region,
+  int s_len,
+  GroupRange range
+)
+{
+  chrono::high_resolution_clock::time_point st, finish;
+  st = chrono::high_resolution_clock::now();
+
+  int s_ht_len = get_linear_ht_len(s_len);
+  int p_ht_len = get_linear_ht_len(p_len);
+  int d_ht_len = get_linear_ht_len(d_len);
+
+  // zeroed: key 0 marks an empty slot
+  std::vector<int> ht_s(s_ht_len, 0);
+  std::vector<int> ht_p(2 * p_ht_len, 0);
+  std::vector<int> ht_d(2 * d_ht_len, 0);
+
+  cpu::for_each_tile<1, CPU_TILE_ITEMS>(s_len, [&](cpu::tile_item item) {
+    build_hashtable_s<1, CPU_TILE_ITEMS>(s_region, s_suppkey, s_len, ht_s.data(), s_ht_len, item);
+  });
+  cpu::for_each_tile<1, CPU_TILE_ITEMS>(p_len, [&](cpu::tile_item item) {
+    build_hashtable_p<1, CPU_TILE_ITEMS>(p_category, p_partkey, p_brand1, p_len, ht_p.data(), p_ht_len, item);
+  });
+  cpu::for_each_tile<1, CPU_TILE_ITEMS>(d_len, [&](cpu::tile_item item) {
+    build_hashtable_d<1, CPU_TILE_ITEMS>(d_datekey, d_year, d_len, ht_d.data(), d_ht_len, item);
+  });
+
+  std::vector<std::atomic<long long>> res(range.num_groups);
+
+  cpu::for_each_tile<1, CPU_TILE_ITEMS>(lo_len, [&](cpu::tile_item item) {
+    probe_tile<1, CPU_TILE_ITEMS>(lo_orderdate, lo_partkey, lo_suppkey, lo_revenue, lo_len,
+        ht_s.data(), s_ht_len, ht_p.data(), p_ht_len, ht_d.data(), d_ht_len, range, res.data(), item);
+  });
+
+  finish = chrono::high_resolution_clock::now();
+  std::chrono::duration<double> diff = finish - st;
+
+  int res_count = 0;
+  for (int group = 0; group < range.num_groups; group++) {
+    long long revenue = res[group].load();
+    if (revenue != 0) {
+      cout << range.min_year + group / range.num_brands << " "
+           << range.min_brand + group % range.num_brands << " " << revenue << std::endl;
+      res_count += 1;
+    }
+  }
+
+  cout << "Res Count: " << res_count << std::endl;
+  cout << "Time Taken Total: " << diff.count() * 1000 << " ms" << endl;
+}
+
+/**
+ * Main
+ */
+int main(int argc, char** argv)
+{
+  initCatalog(argc, argv);
+
+  std::cout << "Running on the host CPU (" << cpu::simd::isa << ", "
+            << std::thread::hardware_concurrency() << " threads)" << '\n';
+
+  // number of running trials
+  int num_trials          = 3;
+
+  // loading data
+  int *h_lo_orderdate = mapColumn<int>("lo_orderdate", catalog.lo_len);
+  int *h_lo_partkey = mapColumn<int>("lo_partkey", catalog.lo_len);
+  int *h_lo_suppkey = mapColumn<int>("lo_suppkey", catalog.lo_len);
+  int *h_lo_revenue = mapColumn<int>("lo_revenue", catalog.lo_len);
+
+  int *h_p_partkey = mapColumn<int>("p_partkey", catalog.p_len);
+  int *h_p_brand1 = mapColumn<int>("p_brand1", catalog.p_len);
+  int *h_p_category = mapColumn<int>("p_category", catalog.p_len);
+
+  int *h_d_datekey = mapColumn<int>("d_datekey", catalog.d_len);
+  int *h_d_year = mapColumn<int>("d_year", catalog.d_len);
+
+  int *h_s_suppkey = mapColumn<int>("s_suppkey", catalog.s_len);
+  int *h_s_region = mapColumn<int>("s_region", catalog.s_len);
+
+  cout << "** LOADED DATA **" << endl;
+  cout << "LO_LEN " << catalog.lo_len << endl;
+
+  auto years = std::minmax_element(h_d_year, h_d_year + catalog.d_len);
+  auto brands = std::minmax_element(h_p_brand1, h_p_brand1 + catalog.p_len);
+
+  GroupRange range;
+  range.min_year = *years.first;
+  range.min_brand = *brands.first;
+  range.num_brands = *brands.second - *brands.first + 1;
+  range.num_groups = (*years.second - *years.first + 1) * range.num_brands;
+
+  for (int t = 0; t < num_trials; t++) {
+    run_query(h_lo_orderdate, h_lo_partkey, h_lo_suppkey, h_lo_revenue, catalog.lo_len,
+        h_p_partkey, h_p_brand1, h_p_category, catalog.p_len,
+        h_d_datekey, h_d_year, catalog.d_len,
+        h_s_suppkey, h_s_region, catalog.s_len, range);
+  }
+
+  return 0;
+}
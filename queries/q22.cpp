@@ -56,8 +56,8 @@ void probe(
       ht_p, p_len, num_tile_items, item_ct1);
 
   load<int, block_threads, items_per_thread>(lo_orderdate + tile_offset, items, num_tile_items, item_ct1);
-  probe_2<int, int, block_threads, items_per_thread>(items, year, selection_flags,
-      ht_d, d_len, 19920101, num_tile_items, item_ct1);
+  probe_linear_2<int, int, block_threads, items_per_thread>(items, year, selection_flags,
+      ht_d, d_len, num_tile_items, item_ct1);
 
   load<int, block_threads, items_per_thread>(lo_revenue + tile_offset, revenue, num_tile_items, item_ct1);
 
@@ -122,7 +122,7 @@ void build_hashtable_p(int *dim_key, int *dim_val, int num_tuples, int *hash_tab
 }
 
 template<int block_threads, int items_per_thread>
-void build_hashtable_d(int *dim_key, int *dim_val, int num_tuples, int *hash_table, int num_slots, int val_min,
+void build_hashtable_d(int *dim_key, int *dim_val, int num_tuples, int *hash_table, int num_slots,
                        sycl::nd_item<1> item_ct1) {
   int items[items_per_thread];
   int items2[items_per_thread];
@@ -140,8 +140,8 @@ void build_hashtable_d(int *dim_key, int *dim_val, int num_tuples, int *hash_tab
 
   load<int, block_threads, items_per_thread>(dim_key + tile_offset, items, num_tile_items, item_ct1);
   load<int, block_threads, items_per_thread>(dim_val + tile_offset, items2, num_tile_items, item_ct1);
-  build_selective_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags, 
-      hash_table, num_slots, val_min, num_tile_items, item_ct1);
+  build_selective_linear_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags, 
+      hash_table, num_slots, num_tile_items, item_ct1);
 }
 
 void runQuery(
@@ -168,7 +168,7 @@ void runQuery(
     st = chrono::high_resolution_clock::now();
 
     int *ht_d, *ht_p, *ht_s;
-    int d_val_len = 19981230 - 19920101 + 1;
+    int d_val_len = get_linear_ht_len(d_len);
 
     // allocating 
     ht_d = (int*)malloc_device(2 * d_val_len * sizeof(int), q);
@@ -202,13 +202,12 @@ void runQuery(
 
     });
 
-    int d_val_min = 19920101;
     int num_blocks_d = (d_len + tile_items - 1)/tile_items;
     q.submit([&](sycl::handler &h){
 
         h.parallel_for<class build_d>(sycl::nd_range<1>({static_cast<size_t>(num_blocks_d * 128)}, {128}),
             [=](sycl::nd_item<1>  it) {
-            build_hashtable_d<128,4>(d_datekey, d_year, d_len, ht_d, d_val_len, d_val_min, it);
+            build_hashtable_d<128,4>(d_datekey, d_year, d_len, ht_d, d_val_len, it);
             });
 
     });
@@ -269,45 +268,46 @@ void runQuery(
 
 
 int main(int argc, char **argv) try {
+  initCatalog(argc, argv);
   auto q = try_get_queue(sycl::default_selector{});
 
   
   int num_trials          = 3;
 
-  int *h_lo_orderdate = loadColumn<int>("lo_orderdate", LO_LEN);
-  int *h_lo_partkey = loadColumn<int>("lo_partkey", LO_LEN);
-  int *h_lo_suppkey = loadColumn<int>("lo_suppkey", LO_LEN);
-  int *h_lo_revenue = loadColumn<int>("lo_revenue", LO_LEN);
+  int *h_lo_orderdate = mapColumn<int>("lo_orderdate", catalog.lo_len);
+  int *h_lo_partkey = mapColumn<int>("lo_partkey", catalog.lo_len);
+  int *h_lo_suppkey = mapColumn<int>("lo_suppkey", catalog.lo_len);
+  int *h_lo_revenue = mapColumn<int>("lo_revenue", catalog.lo_len);
 
-  int *h_p_partkey = loadColumn<int>("p_partkey", P_LEN);
-  int *h_p_brand1 = loadColumn<int>("p_brand1", P_LEN);
+  int *h_p_partkey = mapColumn<int>("p_partkey", catalog.p_len);
+  int *h_p_brand1 = mapColumn<int>("p_brand1", catalog.p_len);
 
-  int *h_d_datekey = loadColumn<int>("d_datekey", D_LEN);
-  int *h_d_year = loadColumn<int>("d_year", D_LEN);
+  int *h_d_datekey = mapColumn<int>("d_datekey", catalog.d_len);
+  int *h_d_year = mapColumn<int>("d_year", catalog.d_len);
 
-  int *h_s_suppkey = loadColumn<int>("s_suppkey", S_LEN);
-  int *h_s_region = loadColumn<int>("s_region", S_LEN);
+  int *h_s_suppkey = mapColumn<int>("s_suppkey", catalog.s_len);
+  int *h_s_region = mapColumn<int>("s_region", catalog.s_len);
 
-  int *d_lo_orderdate = load_to_device<int>(h_lo_orderdate, LO_LEN, q);
-  int *d_lo_partkey = load_to_device<int>(h_lo_partkey, LO_LEN, q);
-  int *d_lo_suppkey = load_to_device<int>(h_lo_suppkey, LO_LEN, q);
-  int *d_lo_revenue = load_to_device<int>(h_lo_revenue, LO_LEN, q);
+  int *d_lo_orderdate = map_to_device<int>(h_lo_orderdate, catalog.lo_len, q);
+  int *d_lo_partkey = map_to_device<int>(h_lo_partkey, catalog.lo_len, q);
+  int *d_lo_suppkey = map_to_device<int>(h_lo_suppkey, catalog.lo_len, q);
+  int *d_lo_revenue = map_to_device<int>(h_lo_revenue, catalog.lo_len, q);
 
-  int *d_d_datekey = load_to_device<int>(h_d_datekey, D_LEN, q);
-  int *d_d_year = load_to_device<int>(h_d_year, D_LEN, q);
+  int *d_d_datekey = map_to_device<int>(h_d_datekey, catalog.d_len, q);
+  int *d_d_year = map_to_device<int>(h_d_year, catalog.d_len, q);
 
-  int *d_p_partkey = load_to_device<int>(h_p_partkey, P_LEN, q);
-  int *d_p_brand1  = load_to_device<int>(h_p_brand1, P_LEN, q);
+  int *d_p_partkey = map_to_device<int>(h_p_partkey, catalog.p_len, q);
+  int *d_p_brand1  = map_to_device<int>(h_p_brand1, catalog.p_len, q);
 
-  int *d_s_suppkey = load_to_device<int>(h_s_suppkey, S_LEN, q);
-  int *d_s_region = load_to_device<int>(h_s_region, S_LEN, q);
+  int *d_s_suppkey = map_to_device<int>(h_s_suppkey, catalog.s_len, q);
+  int *d_s_region = map_to_device<int>(h_s_region, catalog.s_len, q);
 
   for (int t = 0; t < num_trials; t++) {
     runQuery(q,
-        d_lo_orderdate, d_lo_partkey, d_lo_suppkey, d_lo_revenue, LO_LEN,
-        d_p_partkey, d_p_brand1, P_LEN,
-        d_d_datekey, d_d_year, D_LEN,
-        d_s_suppkey, d_s_region, S_LEN);
+        d_lo_orderdate, d_lo_partkey, d_lo_suppkey, d_lo_revenue, catalog.lo_len,
+        d_p_partkey, d_p_brand1, catalog.p_len,
+        d_d_datekey, d_d_year, catalog.d_len,
+        d_s_suppkey, d_s_region, catalog.s_len);
   }
 
   return 0;
@@ -25,6 +25,8 @@ void probe(
     int lo_len,
     int* ht_s,
     int s_len,
+    uint32_t* bloom_s,
+    int bloom_s_len,
     int* ht_c, 
     int c_len,
     int* ht_d, 
@@ -52,6 +54,7 @@ void probe(
   init_flags<block_threads, items_per_thread>(selection_flags);
 
   load<int, block_threads, items_per_thread>(lo_suppkey + tile_offset, items, num_tile_items, item_ct1);
+  probe_bloom<int, block_threads, items_per_thread>(items, selection_flags, bloom_s, bloom_s_len, num_tile_items, item_ct1);
   probe_2<int, int, block_threads, items_per_thread>(items, s_nation, selection_flags,
       ht_s, s_len, num_tile_items, item_ct1);
 
@@ -60,8 +63,8 @@ void probe(
       ht_c, c_len, num_tile_items, item_ct1);
 
   load<int, block_threads, items_per_thread>(lo_orderdate + tile_offset, items, num_tile_items, item_ct1);
-  probe_2<int, int, block_threads, items_per_thread>(items, year, selection_flags,
-      ht_d, d_len, 19920101, num_tile_items, item_ct1);
+  probe_linear_2<int, int, block_threads, items_per_thread>(items, year, selection_flags,
+      ht_d, d_len, num_tile_items, item_ct1);
 
   load<int, block_threads, items_per_thread>(lo_revenue + tile_offset, revenue, num_tile_items, item_ct1);
 
@@ -92,6 +95,8 @@ void build_hashtable_s(
     int num_tuples, 
     int *hash_table, 
     int num_slots,
+    uint32_t *filter,
+    int filter_len,
     sycl::nd_item<1> item_ct1
 ) 
 {
@@ -114,6 +119,8 @@ void build_hashtable_s(
   load<int, block_threads, items_per_thread>(dim_val + tile_offset, items2, num_tile_items, item_ct1);
   build_selective_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags, 
       hash_table, num_slots, num_tile_items, item_ct1);
+  build_bloom<int, block_threads, items_per_thread>(items, selection_flags,
+      filter, filter_len, num_tile_items, item_ct1);
 }
 
 template <int block_threads, int items_per_thread>
@@ -154,7 +161,6 @@ SYCL_EXTERNAL void build_hashtable_d (
     int num_tuples,
     int *hash_table, 
     int num_slots,
-    int val_min,
     sycl::nd_item<1> item_ct1
 )
 {
@@ -175,8 +181,8 @@ SYCL_EXTERNAL void build_hashtable_d (
   predicate_lte<int, block_threads, items_per_thread>(items, 1997, selection_flags, num_tile_items, item_ct1);
 
   load<int, block_threads, items_per_thread>(dim_key + tile_offset, items2, num_tile_items, item_ct1);
-  build_selective_2<int, int, block_threads, items_per_thread>(items2, items, selection_flags, 
-      hash_table, num_slots, 19920101, num_tile_items, item_ct1);
+  build_selective_linear_2<int, int, block_threads, items_per_thread>(items2, items, selection_flags, 
+      hash_table, num_slots, num_tile_items, item_ct1);
 }
 
 void runQuery(
@@ -204,15 +210,20 @@ void runQuery(
     st = chrono::high_resolution_clock::now();
 
     int *ht_d, *ht_c, *ht_s;
-    int d_val_len = 19981230 - 19920101 + 1;
+    int d_val_len = get_linear_ht_len(d_len);
    
      
     ht_d = (int*)malloc_device(2 * d_val_len * sizeof(int), q);
     ht_c = (int*)malloc_device(2 * c_len * sizeof(int), q);
     ht_s = (int*)malloc_device(2 * s_len * sizeof(int), q);
 
+    // Bloom filter of the selected suppliers, probed before ht_s
+    int bloom_s_len = get_bloom_len(s_len);
+    uint32_t *bloom_s = (uint32_t*)malloc_device(bloom_s_len * sizeof(uint32_t), q);
+
     q.memset(ht_d, 0, 2 * d_val_len * sizeof(int)).wait();
     q.memset(ht_s, 0, 2 * s_len * sizeof(int)).wait();
+    q.memset(bloom_s, 0, bloom_s_len * sizeof(uint32_t)).wait();
 
     int tile_items = 128*4;
     int num_blocks_s = (s_len + tile_items - 1)/tile_items;
@@ -221,7 +232,8 @@ void runQuery(
 
         h.parallel_for<class build_s>(sycl::nd_range<1>({static_cast<size_t>(num_blocks_s * 128)},{128}),
             [=](sycl::nd_item<1>  it) {
-            build_hashtable_s<128,4>(s_region, s_suppkey, s_nation, s_len, ht_s, s_len, it);
+            build_hashtable_s<128,4>(s_region, s_suppkey, s_nation, s_len, ht_s, s_len,
+                                     bloom_s, bloom_s_len, it);
             });
 
     });
@@ -238,13 +250,12 @@ void runQuery(
     });
 
 
-    int d_val_min = 19920101;
     int num_blocks_d = (d_len + tile_items - 1)/tile_items;
     q.submit([&](sycl::handler &h){
 
         h.parallel_for<class build_d>(sycl::nd_range<1>({static_cast<size_t>(num_blocks_d * 128)}, {128}),
             [=](sycl::nd_item<1>  it) {
-            build_hashtable_d<128,4>(d_datekey, d_year, d_len, ht_d, d_val_len, d_val_min, it);
+            build_hashtable_d<128,4>(d_datekey, d_year, d_len, ht_d, d_val_len, it);
             });
 
     });
@@ -263,7 +274,7 @@ void runQuery(
         h.parallel_for<class Probe>(sycl::nd_range<1>({static_cast<size_t>(num_blocks_lo * 128)},{128}),
             [=](sycl::nd_item<1>  it) {
             probe<128,4>(lo_orderdate, lo_custkey, lo_suppkey, lo_revenue, lo_len,
-                        ht_s, s_len, ht_c, c_len, ht_d, d_val_len, res, it);
+                        ht_s, s_len, bloom_s, bloom_s_len, ht_c, c_len, ht_d, d_val_len, res, it);
             });
 
     }).wait();
@@ -293,6 +304,7 @@ void runQuery(
     sycl::free(ht_d, q);
     sycl::free(ht_c, q);
     sycl::free(ht_s, q);
+    sycl::free(bloom_s, q);
 
   }
   catch (sycl::exception const &exc) {
@@ -306,6 +318,7 @@ void runQuery(
  * Main
  */
 int main(int argc, char **argv) try {
+  initCatalog(argc, argv);
   auto q = try_get_queue(sycl::default_selector{});
 
   // device
@@ -315,48 +328,48 @@ int main(int argc, char **argv) try {
   int num_trials          = 3;
 
 
-  int *h_lo_orderdate = loadColumn<int>("lo_orderdate", LO_LEN);
-  int *h_lo_custkey = loadColumn<int>("lo_custkey", LO_LEN);
-  int *h_lo_suppkey = loadColumn<int>("lo_suppkey", LO_LEN);
-  int *h_lo_revenue = loadColumn<int>("lo_revenue", LO_LEN);
+  int *h_lo_orderdate = mapColumn<int>("lo_orderdate", catalog.lo_len);
+  int *h_lo_custkey = mapColumn<int>("lo_custkey", catalog.lo_len);
+  int *h_lo_suppkey = mapColumn<int>("lo_suppkey", catalog.lo_len);
+  int *h_lo_revenue = mapColumn<int>("lo_revenue", catalog.lo_len);
 
-  int *h_d_datekey = loadColumn<int>("d_datekey", D_LEN);
-  int *h_d_year = loadColumn<int>("d_year", D_LEN);
+  int *h_d_datekey = mapColumn<int>("d_datekey", catalog.d_len);
+  int *h_d_year = mapColumn<int>("d_year", catalog.d_len);
 
-  int *h_s_suppkey = loadColumn<int>("s_suppkey", S_LEN);
-  int *h_s_nation = loadColumn<int>("s_nation", S_LEN);
-  int *h_s_region = loadColumn<int>("s_region", S_LEN);
+  int *h_s_suppkey = mapColumn<int>("s_suppkey", catalog.s_len);
+  int *h_s_nation = mapColumn<int>("s_nation", catalog.s_len);
+  int *h_s_region = mapColumn<int>("s_region", catalog.s_len);
 
-  int *h_c_custkey = loadColumn<int>("c_custkey", C_LEN);
-  int *h_c_nation = loadColumn<int>("c_nation", C_LEN);
-  int *h_c_region = loadColumn<int>("c_region", C_LEN);
+  int *h_c_custkey = mapColumn<int>("c_custkey", catalog.c_len);
+  int *h_c_nation = mapColumn<int>("c_nation", catalog.c_len);
+  int *h_c_region = mapColumn<int>("c_region", catalog.c_len);
 
   cout << "** LOADED DATA **" << endl;
 
-  int *d_lo_orderdate = load_to_device<int>(h_lo_orderdate, LO_LEN, q);
-  int *d_lo_custkey = load_to_device<int>(h_lo_custkey, LO_LEN, q);
-  int *d_lo_suppkey = load_to_device<int>(h_lo_suppkey, LO_LEN, q);
-  int *d_lo_revenue = load_to_device<int>(h_lo_revenue, LO_LEN, q);
+  int *d_lo_orderdate = map_to_device<int>(h_lo_orderdate, catalog.lo_len, q);
+  int *d_lo_custkey = map_to_device<int>(h_lo_custkey, catalog.lo_len, q);
+  int *d_lo_suppkey = map_to_device<int>(h_lo_suppkey, catalog.lo_len, q);
+  int *d_lo_revenue = map_to_device<int>(h_lo_revenue, catalog.lo_len, q);
 
-  int *d_d_datekey = load_to_device<int>(h_d_datekey, D_LEN, q);
-  int *d_d_year = load_to_device<int>(h_d_year, D_LEN, q);
+  int *d_d_datekey = map_to_device<int>(h_d_datekey, catalog.d_len, q);
+  int *d_d_year = map_to_device<int>(h_d_year, catalog.d_len, q);
 
-  int *d_s_suppkey = load_to_device<int>(h_s_suppkey, S_LEN, q);
-  int *d_s_region = load_to_device<int>(h_s_region, S_LEN, q);
-  int *d_s_nation = load_to_device<int>(h_s_nation, S_LEN, q);
+  int *d_s_suppkey = map_to_device<int>(h_s_suppkey, catalog.s_len, q);
+  int *d_s_region = map_to_device<int>(h_s_region, catalog.s_len, q);
+  int *d_s_nation = map_to_device<int>(h_s_nation, catalog.s_len, q);
 
-  int *d_c_custkey = load_to_device<int>(h_c_custkey, C_LEN, q);
-  int *d_c_region = load_to_device<int>(h_c_region, C_LEN, q);
-  int *d_c_nation = load_to_device<int>(h_c_nation, C_LEN, q);
+  int *d_c_custkey = map_to_device<int>(h_c_custkey, catalog.c_len, q);
+  int *d_c_region = map_to_device<int>(h_c_region, catalog.c_len, q);
+  int *d_c_nation = map_to_device<int>(h_c_nation, catalog.c_len, q);
 
   cout << "** LOADED DATA TO DEVICE: " << dev_name << "**" << endl;
 
   for (int t = 0; t < num_trials; t++) {
     runQuery(q,
-        d_lo_orderdate, d_lo_custkey, d_lo_suppkey, d_lo_revenue, LO_LEN,
-        d_d_datekey, d_d_year, D_LEN,
-        d_s_suppkey, d_s_region, d_s_nation, S_LEN,
-        d_c_custkey, d_c_region, d_c_nation, C_LEN
+        d_lo_orderdate, d_lo_custkey, d_lo_suppkey, d_lo_revenue, catalog.lo_len,
+        d_d_datekey, d_d_year, catalog.d_len,
+        d_s_suppkey, d_s_region, d_s_nation, catalog.s_len,
+        d_c_custkey, d_c_region, d_c_nation, catalog.c_len
     );
   }
 
@@ -60,8 +60,8 @@ void probe(
       ht_c, c_len, num_tile_items, item_ct1);
 
   load<int, block_threads, items_per_thread>(lo_orderdate + tile_offset, items, num_tile_items, item_ct1);
-  probe_2<int, int, block_threads, items_per_thread>(items, year, selection_flags,
-      ht_d, d_len, 19920101, num_tile_items, item_ct1);
+  probe_linear_2<int, int, block_threads, items_per_thread>(items, year, selection_flags,
+      ht_d, d_len, num_tile_items, item_ct1);
 
   load<int, block_threads, items_per_thread>(lo_revenue + tile_offset, revenue, num_tile_items, item_ct1);
 
@@ -151,7 +151,6 @@ void build_hashtable_d(
     int num_tuples, 
     int *hash_table, 
     int num_slots, 
-    int val_min,
     sycl::nd_item<1> item_ct1
 ) 
 {
@@ -172,8 +171,8 @@ void build_hashtable_d(
   predicate_and_lte<int, block_threads, items_per_thread>(items, 1997, selection_flags, num_tile_items, item_ct1);
 
   load<int, block_threads, items_per_thread>(dim_key + tile_offset, items2, num_tile_items, item_ct1);
-  build_selective_2<int, int, block_threads, items_per_thread>(items2, items, selection_flags, 
-      hash_table, num_slots, 19920101, num_tile_items, item_ct1);
+  build_selective_linear_2<int, int, block_threads, items_per_thread>(items2, items, selection_flags, 
+      hash_table, num_slots, num_tile_items, item_ct1);
 }
 
 void runQuery(
@@ -201,7 +200,7 @@ void runQuery(
     st = chrono::high_resolution_clock::now();
 
     int *ht_d, *ht_c, *ht_s;
-    int d_val_len = 19981230 - 19920101 + 1;
+    int d_val_len = get_linear_ht_len(d_len);
 
     ht_d = (int*)malloc_device(2 * d_val_len * sizeof(int), q);
     ht_c = (int*)malloc_device(2 * c_len * sizeof(int), q);
@@ -234,14 +233,12 @@ void runQuery(
     });
 
 
-    int d_val_min = 19920101;
     int num_blocks_d = (d_len + tile_items - 1)/tile_items;
     q.submit([&](sycl::handler &h){
 
         h.parallel_for<class build_d>(sycl::nd_range<1>({static_cast<size_t>(num_blocks_d * 128)}, {128}),
             [=](sycl::nd_item<1>  it) {
-            build_hashtable_d<128,4>(d_datekey, d_year, d_len, ht_d, d_val_len,
-                                    d_val_min, it);
+            build_hashtable_d<128,4>(d_datekey, d_year, d_len, ht_d, d_val_len, it);
         });
     });
 
@@ -300,6 +297,7 @@ void runQuery(
  */
 int main(int argc, char **argv)
 {
+  initCatalog(argc, argv);
   auto q = try_get_queue(sycl::default_selector{});
 
   // device
@@ -307,48 +305,48 @@ int main(int argc, char **argv)
   std::cout <<"Running on " << dev_name << '\n' ;
   int num_trials          = 3;
 
-  int *h_lo_orderdate = loadColumn<int>("lo_orderdate", LO_LEN);
-  int *h_lo_custkey = loadColumn<int>("lo_custkey", LO_LEN);
-  int *h_lo_suppkey = loadColumn<int>("lo_suppkey", LO_LEN);
-  int *h_lo_revenue = loadColumn<int>("lo_revenue", LO_LEN);
+  int *h_lo_orderdate = mapColumn<int>("lo_orderdate", catalog.lo_len);
+  int *h_lo_custkey = mapColumn<int>("lo_custkey", catalog.lo_len);
+  int *h_lo_suppkey = mapColumn<int>("lo_suppkey", catalog.lo_len);
+  int *h_lo_revenue = mapColumn<int>("lo_revenue", catalog.lo_len);
 
-  int *h_d_datekey = loadColumn<int>("d_datekey", D_LEN);
-  int *h_d_year = loadColumn<int>("d_year", D_LEN);
+  int *h_d_datekey = mapColumn<int>("d_datekey", catalog.d_len);
+  int *h_d_year = mapColumn<int>("d_year", catalog.d_len);
 
-  int *h_s_suppkey = loadColumn<int>("s_suppkey", S_LEN);
-  int *h_s_nation = loadColumn<int>("s_nation", S_LEN);
-  int *h_s_city = loadColumn<int>("s_city", S_LEN);
+  int *h_s_suppkey = mapColumn<int>("s_suppkey", catalog.s_len);
+  int *h_s_nation = mapColumn<int>("s_nation", catalog.s_len);
+  int *h_s_city = mapColumn<int>("s_city", catalog.s_len);
 
-  int *h_c_custkey = loadColumn<int>("c_custkey", C_LEN);
-  int *h_c_nation = loadColumn<int>("c_nation", C_LEN);
-  int *h_c_city = loadColumn<int>("c_city", C_LEN);
+  int *h_c_custkey = mapColumn<int>("c_custkey", catalog.c_len);
+  int *h_c_nation = mapColumn<int>("c_nation", catalog.c_len);
+  int *h_c_city = mapColumn<int>("c_city", catalog.c_len);
 
   cout << "** LOADED DATA **" << endl;
 
-  int *d_lo_orderdate = load_to_device<int>(h_lo_orderdate, LO_LEN, q);
-  int *d_lo_custkey = load_to_device<int>(h_lo_custkey, LO_LEN, q);
-  int *d_lo_suppkey = load_to_device<int>(h_lo_suppkey, LO_LEN, q);
-  int *d_lo_revenue = load_to_device<int>(h_lo_revenue, LO_LEN, q);
+  int *d_lo_orderdate = map_to_device<int>(h_lo_orderdate, catalog.lo_len, q);
+  int *d_lo_custkey = map_to_device<int>(h_lo_custkey, catalog.lo_len, q);
+  int *d_lo_suppkey = map_to_device<int>(h_lo_suppkey, catalog.lo_len, q);
+  int *d_lo_revenue = map_to_device<int>(h_lo_revenue, catalog.lo_len, q);
 
-  int *d_d_datekey = load_to_device<int>(h_d_datekey, D_LEN, q);
-  int *d_d_year = load_to_device<int>(h_d_year, D_LEN, q);
+  int *d_d_datekey = map_to_device<int>(h_d_datekey, catalog.d_len, q);
+  int *d_d_year = map_to_device<int>(h_d_year, catalog.d_len, q);
 
-  int *d_s_suppkey = load_to_device<int>(h_s_suppkey, S_LEN, q);
-  int *d_s_nation = load_to_device<int>(h_s_nation, S_LEN, q);
-  int *d_s_city = load_to_device<int>(h_s_city, S_LEN, q);
+  int *d_s_suppkey = map_to_device<int>(h_s_suppkey, catalog.s_len, q);
+  int *d_s_nation = map_to_device<int>(h_s_nation, catalog.s_len, q);
+  int *d_s_city = map_to_device<int>(h_s_city, catalog.s_len, q);
 
-  int *d_c_custkey = load_to_device<int>(h_c_custkey, C_LEN, q);
-  int *d_c_nation = load_to_device<int>(h_c_nation, C_LEN, q);
-  int *d_c_city = load_to_device<int>(h_c_city, C_LEN, q);
+  int *d_c_custkey = map_to_device<int>(h_c_custkey, catalog.c_len, q);
+  int *d_c_nation = map_to_device<int>(h_c_nation, catalog.c_len, q);
+  int *d_c_city = map_to_device<int>(h_c_city, catalog.c_len, q);
 
   cout << "** LOADED DATA TO DEVICE: " << dev_name << "**" << endl;
 
   for (int t = 0; t < num_trials; t++) {
     runQuery(q,
-        d_lo_orderdate, d_lo_custkey, d_lo_suppkey, d_lo_revenue, LO_LEN,
-        d_d_datekey, d_d_year, D_LEN,
-        d_s_suppkey, d_s_nation, d_s_city, S_LEN,
-        d_c_custkey, d_c_nation, d_c_city, C_LEN);
+        d_lo_orderdate, d_lo_custkey, d_lo_suppkey, d_lo_revenue, catalog.lo_len,
+        d_d_datekey, d_d_year, catalog.d_len,
+        d_s_suppkey, d_s_nation, d_s_city, catalog.s_len,
+        d_c_custkey, d_c_nation, d_c_city, catalog.c_len);
   }
 
   return 0;
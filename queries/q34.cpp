@@ -22,6 +22,9 @@ void probe (
     int* lo_suppkey, 
     int* lo_revenue, 
     int lo_len,
+    int* lo_orderdate_min, 
+    int* lo_orderdate_max, 
+    int zone_size, 
     int* ht_s, 
     int s_len,
     int* ht_c, 
@@ -29,6 +32,8 @@ void probe (
     int* ht_d, 
     int d_len,
     int* res, 
+    int* selection,
+    int* local_values,
     sycl::nd_item<1> item_ct1
 ) 
 {
@@ -48,25 +53,40 @@ void probe (
     num_tile_items = lo_len - tile_offset;
   }
 
+  // d_yearmonthnum = 199712: no date of the tile in December 1997, skip it
+  if (!zone_map_may_match<int>(lo_orderdate_min, lo_orderdate_max, zone_size,
+        tile_offset, num_tile_items, 19971201, 19971231)) {
+    return;
+  }
+
   init_flags<block_threads, items_per_thread>(selection_flags);
 
   load<int, block_threads, items_per_thread>(lo_suppkey + tile_offset, items, num_tile_items, item_ct1);
   probe_2<int, int, block_threads, items_per_thread>(items, s_nation, selection_flags,
       ht_s, s_len, num_tile_items, item_ct1);
 
-  load<int, block_threads, items_per_thread>(lo_custkey + tile_offset, items, num_tile_items, item_ct1);
+  // only 2 cities out of 250 pass: keep going on the surviving rows only,
+  // carrying s_nation along in the compacted arrangement
+  int num_selected = block_compact<int, block_threads, items_per_thread>(
+      s_nation, selection_flags, selection, local_values, num_tile_items, item_ct1);
+  if (num_selected == 0) {
+    return;
+  }
+
+  load_selected<int, block_threads, items_per_thread>(lo_custkey + tile_offset, selection, items,
+      num_selected, item_ct1);
   probe_2<int, int, block_threads, items_per_thread>(items, c_nation, selection_flags,
-      ht_c, c_len, num_tile_items, item_ct1);
+      ht_c, c_len, num_selected, item_ct1);
 
-  load<int, block_threads, items_per_thread>(lo_orderdate + tile_offset, items, num_tile_items, item_ct1);
-  probe_2<int, int, block_threads, items_per_thread>(items, year, selection_flags,
-      ht_d, d_len, 19920101,num_tile_items, item_ct1);
+  probe_selected_linear_2<int, int, block_threads, items_per_thread>(lo_orderdate + tile_offset, selection,
+      items, year, selection_flags, ht_d, d_len, num_selected, item_ct1);
 
-  load<int, block_threads, items_per_thread>(lo_revenue + tile_offset, revenue, num_tile_items, item_ct1);
+  load_selected<int, block_threads, items_per_thread>(lo_revenue + tile_offset, selection, revenue,
+      num_selected, item_ct1);
 
   #pragma unroll
   for (int ITEM = 0; ITEM < items_per_thread; ++ITEM) {
-    if ((item_ct1.get_local_id(0) + (block_threads * ITEM)) < num_tile_items) {
+    if ((item_ct1.get_local_id(0) + (block_threads * ITEM)) < num_selected) {
       if (selection_flags[ITEM]) {
         int hash = (s_nation[ITEM] * 250 * 7  + c_nation[ITEM] * 7 +  (year[ITEM] - 1992)) % ((1998-1992+1) * 250 * 250);
         res[hash * 4] = year[ITEM];
@@ -149,7 +169,6 @@ void build_hashtable_d(
     int num_tuples, 
     int *hash_table, 
     int num_slots, 
-    int val_min,
     sycl::nd_item<1> item_ct1
 ) 
 {
@@ -170,8 +189,8 @@ void build_hashtable_d(
 
   load<int, block_threads, items_per_thread>(dim_key + tile_offset, items, num_tile_items, item_ct1);
   load<int, block_threads, items_per_thread>(dim_val + tile_offset, items2, num_tile_items, item_ct1);
-  build_selective_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags, 
-      hash_table, num_slots, 19920101, num_tile_items, item_ct1);
+  build_selective_linear_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags, 
+      hash_table, num_slots, num_tile_items, item_ct1);
 }
 
 void runQuery(
@@ -181,6 +200,9 @@ void runQuery(
     int *lo_suppkey,
     int *lo_revenue, 
     int lo_len, 
+    int *lo_orderdate_min, 
+    int *lo_orderdate_max, 
+    int zone_size, 
     int *d_datekey, 
     int *d_year,
     int *d_yearmonthnum, 
@@ -198,7 +220,7 @@ void runQuery(
     st = chrono::high_resolution_clock::now();
 
     int *ht_d, *ht_c, *ht_s;
-    int d_val_len = 19981230 - 19920101 + 1;
+    int d_val_len = get_linear_ht_len(d_len);
 
     ht_d = (int*)malloc_device(2 * d_val_len * sizeof(int), q);
     ht_c = (int*)malloc_device(2 * c_len * sizeof(int), q);
@@ -230,7 +252,6 @@ void runQuery(
     });
 
 
-    int d_val_min = 19920101;
     
     int num_blocks_d = (d_len + tile_items - 1)/tile_items;
     q.submit([&](sycl::handler &h){
@@ -238,7 +259,7 @@ void runQuery(
         h.parallel_for<class build_d>(sycl::nd_range<1>({static_cast<size_t>(num_blocks_d * 128)}, {128}),
             [=](sycl::nd_item<1>  it) {
             build_hashtable_d<128,4>(d_yearmonthnum, d_datekey, d_year, d_len,
-                                    ht_d, d_val_len, d_val_min, it);
+                                    ht_d, d_val_len, it);
         });
     });
 
@@ -257,11 +278,15 @@ void runQuery(
     int num_blocks_lo = (lo_len + tile_items - 1)/tile_items;
     // Run
     q.submit([&](sycl::handler &h){
+        sycl::local_accessor<int, 1> selection(sycl::range<1>(tile_items), h);
+        sycl::local_accessor<int, 1> local_values(sycl::range<1>(tile_items), h);
 
         h.parallel_for<class Probe>(sycl::nd_range<1>({static_cast<size_t>(num_blocks_lo * 128)},{128}),
             [=](sycl::nd_item<1>  it) {
             probe<128,4>(lo_orderdate, lo_custkey, lo_suppkey, lo_revenue, lo_len,
-                        ht_s, s_len, ht_c, c_len, ht_d, d_val_len, res, it);
+                        lo_orderdate_min, lo_orderdate_max, zone_size,
+                        ht_s, s_len, ht_c, c_len, ht_d, d_val_len, res, selection.get_pointer(),
+                        local_values.get_pointer(), it);
             });
 
     }).wait();
@@ -323,6 +348,7 @@ int murmur(int k) {
  * Main
  */
 int main(int argc, char **argv) {
+  initCatalog(argc, argv);
   auto q = try_get_queue(sycl::default_selector{});
 
   // device
@@ -331,46 +357,50 @@ int main(int argc, char **argv) {
   int num_trials          = 3;
 
 
-  int *h_lo_orderdate = loadColumn<int>("lo_orderdate", LO_LEN);
-  int *h_lo_custkey = loadColumn<int>("lo_custkey", LO_LEN);
-  int *h_lo_suppkey = loadColumn<int>("lo_suppkey", LO_LEN);
-  int *h_lo_revenue = loadColumn<int>("lo_revenue", LO_LEN);
+  int *h_lo_orderdate = mapColumn<int>("lo_orderdate", catalog.lo_len);
+  int *h_lo_custkey = mapColumn<int>("lo_custkey", catalog.lo_len);
+  int *h_lo_suppkey = mapColumn<int>("lo_suppkey", catalog.lo_len);
+  int *h_lo_revenue = mapColumn<int>("lo_revenue", catalog.lo_len);
+  ZoneMap h_lo_orderdate_zm = loadZoneMap("lo_orderdate", catalog.lo_len);
 
-  int *h_d_datekey = loadColumn<int>("d_datekey", D_LEN);
-  int *h_d_year = loadColumn<int>("d_year", D_LEN);
-  int *h_d_yearmonthnum = loadColumn<int>("d_yearmonthnum", D_LEN);
+  int *h_d_datekey = mapColumn<int>("d_datekey", catalog.d_len);
+  int *h_d_year = mapColumn<int>("d_year", catalog.d_len);
+  int *h_d_yearmonthnum = mapColumn<int>("d_yearmonthnum", catalog.d_len);
 
-  int *h_s_suppkey = loadColumn<int>("s_suppkey", S_LEN);
-  int *h_s_city = loadColumn<int>("s_city", S_LEN);
+  int *h_s_suppkey = mapColumn<int>("s_suppkey", catalog.s_len);
+  int *h_s_city = mapColumn<int>("s_city", catalog.s_len);
 
-  int *h_c_custkey = loadColumn<int>("c_custkey", C_LEN);
-  int *h_c_city = loadColumn<int>("c_city", C_LEN);
+  int *h_c_custkey = mapColumn<int>("c_custkey", catalog.c_len);
+  int *h_c_city = mapColumn<int>("c_city", catalog.c_len);
 
   cout << "** LOADED DATA **" << endl;
 
-  int *d_lo_orderdate = load_to_device<int>(h_lo_orderdate, LO_LEN, q);
-  int *d_lo_custkey = load_to_device<int>(h_lo_custkey, LO_LEN, q);
-  int *d_lo_suppkey = load_to_device<int>(h_lo_suppkey, LO_LEN, q);
-  int *d_lo_revenue = load_to_device<int>(h_lo_revenue, LO_LEN, q);
+  int *d_lo_orderdate = map_to_device<int>(h_lo_orderdate, catalog.lo_len, q);
+  int *d_lo_custkey = map_to_device<int>(h_lo_custkey, catalog.lo_len, q);
+  int *d_lo_suppkey = map_to_device<int>(h_lo_suppkey, catalog.lo_len, q);
+  int *d_lo_revenue = map_to_device<int>(h_lo_revenue, catalog.lo_len, q);
+  int *d_lo_orderdate_min = map_to_device<int>(h_lo_orderdate_zm.zone_min, h_lo_orderdate_zm.num_zones, q);
+  int *d_lo_orderdate_max = map_to_device<int>(h_lo_orderdate_zm.zone_max, h_lo_orderdate_zm.num_zones, q);
 
-  int *d_d_datekey = load_to_device<int>(h_d_datekey, D_LEN, q);
-  int *d_d_year = load_to_device<int>(h_d_year, D_LEN, q);
-  int *d_d_yearmonthnum = load_to_device<int>(h_d_yearmonthnum, D_LEN, q);
+  int *d_d_datekey = map_to_device<int>(h_d_datekey, catalog.d_len, q);
+  int *d_d_year = map_to_device<int>(h_d_year, catalog.d_len, q);
+  int *d_d_yearmonthnum = map_to_device<int>(h_d_yearmonthnum, catalog.d_len, q);
 
-  int *d_s_suppkey = load_to_device<int>(h_s_suppkey, S_LEN, q);
-  int *d_s_city = load_to_device<int>(h_s_city, S_LEN, q);
+  int *d_s_suppkey = map_to_device<int>(h_s_suppkey, catalog.s_len, q);
+  int *d_s_city = map_to_device<int>(h_s_city, catalog.s_len, q);
 
-  int *d_c_custkey = load_to_device<int>(h_c_custkey, C_LEN, q);
-  int *d_c_city = load_to_device<int>(h_c_city, C_LEN, q);
+  int *d_c_custkey = map_to_device<int>(h_c_custkey, catalog.c_len, q);
+  int *d_c_city = map_to_device<int>(h_c_city, catalog.c_len, q);
 
   cout << "** LOADED DATA TO DEVICE: " << dev_name << "**" << endl;
 
   for (int t = 0; t < num_trials; t++) {
     runQuery(q,
-        d_lo_orderdate, d_lo_custkey, d_lo_suppkey, d_lo_revenue, LO_LEN,
-        d_d_datekey, d_d_year, d_d_yearmonthnum, D_LEN,
-        d_s_suppkey, d_s_city, S_LEN,
-        d_c_custkey, d_c_city, C_LEN);
+        d_lo_orderdate, d_lo_custkey, d_lo_suppkey, d_lo_revenue, catalog.lo_len,
+        d_lo_orderdate_min, d_lo_orderdate_max, h_lo_orderdate_zm.zone_size,
+        d_d_datekey, d_d_year, d_d_yearmonthnum, catalog.d_len,
+        d_s_suppkey, d_s_city, catalog.s_len,
+        d_c_custkey, d_c_city, catalog.c_len);
   }
 
   return 0;
@@ -29,6 +29,8 @@ void probe(
     int p_len,
     int* ht_s, 
     int s_len,
+    uint32_t* bloom_s,
+    int bloom_s_len,
     int* ht_c, 
     int c_len,
     int* ht_d, 
@@ -56,6 +58,7 @@ void probe(
   init_flags<block_threads, items_per_thread>(selection_flags);
 
   load<int, block_threads, items_per_thread>(lo_suppkey + tile_offset, items, num_tile_items, item_ct1);
+  probe_bloom<int, block_threads, items_per_thread>(items, selection_flags, bloom_s, bloom_s_len, num_tile_items, item_ct1);
   probe_1<int, block_threads, items_per_thread>(items, selection_flags, ht_s, s_len, num_tile_items, item_ct1);
 
   load<int, block_threads, items_per_thread>(lo_custkey + tile_offset, items, num_tile_items, item_ct1);
@@ -66,8 +69,8 @@ void probe(
   probe_1<int, block_threads, items_per_thread>(items, selection_flags, ht_p, p_len, num_tile_items, item_ct1);
 
   load<int, block_threads, items_per_thread>(lo_orderdate + tile_offset, items, num_tile_items, item_ct1);
-  probe_2<int, int, block_threads, items_per_thread>(items, year, selection_flags,
-      ht_d, d_len, 19920101, num_tile_items, item_ct1);
+  probe_linear_2<int, int, block_threads, items_per_thread>(items, year, selection_flags,
+      ht_d, d_len, num_tile_items, item_ct1);
 
   load<int, block_threads, items_per_thread>(lo_revenue + tile_offset, revenue, num_tile_items, item_ct1);
   load<int, block_threads, items_per_thread>(lo_supplycost + tile_offset, items, num_tile_items, item_ct1);
@@ -91,7 +94,7 @@ void probe(
 
 template<int block_threads, int items_per_thread>
 void build_hashtable_s(int *filter_col, int *dim_key, int num_tuples, int *hash_table, int num_slots,
-                       sycl::nd_item<1> item_ct1) {
+                       uint32_t *filter, int filter_len, sycl::nd_item<1> item_ct1) {
   int items[items_per_thread];
   int selection_flags[items_per_thread];
 
@@ -109,6 +112,8 @@ void build_hashtable_s(int *filter_col, int *dim_key, int num_tuples, int *hash_
   load<int, block_threads, items_per_thread>(dim_key + tile_offset, items, num_tile_items, item_ct1);
   build_selective_1<int, block_threads, items_per_thread>(items, selection_flags, 
       hash_table, num_slots, num_tile_items, item_ct1);
+  build_bloom<int, block_threads, items_per_thread>(items, selection_flags,
+      filter, filter_len, num_tile_items, item_ct1);
 }
 
 template<int block_threads, int items_per_thread>
@@ -176,7 +181,7 @@ SYCL_EXTERNAL void build_hashtable_c(
 template <int block_threads, int items_per_thread>
 SYCL_EXTERNAL void build_hashtable_d(int *dim_key, int *dim_val, int num_tuples,
                                      int *hash_table, int num_slots,
-                                     int val_min, sycl::nd_item<1> item_ct1) {
+                                     sycl::nd_item<1> item_ct1) {
   int items[items_per_thread];
   int items2[items_per_thread];
   int selection_flags[items_per_thread];
@@ -192,8 +197,8 @@ SYCL_EXTERNAL void build_hashtable_d(int *dim_key, int *dim_val, int num_tuples,
   init_flags<block_threads, items_per_thread>(selection_flags);
   load<int, block_threads, items_per_thread>(dim_key + tile_offset, items, num_tile_items, item_ct1);
   load<int, block_threads, items_per_thread>(dim_val + tile_offset, items2, num_tile_items, item_ct1);
-  build_selective_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags,
-      hash_table, num_slots, val_min, num_tile_items, item_ct1);
+  build_selective_linear_2<int, int, block_threads, items_per_thread>(items, items2, selection_flags,
+      hash_table, num_slots, num_tile_items, item_ct1);
 }
 
 void runQuery(
@@ -225,15 +230,20 @@ void runQuery(
     st = chrono::high_resolution_clock::now();
 
     int *ht_d, *ht_c, *ht_s, *ht_p;
-    int d_val_len = 19981230 - 19920101 + 1;
+    int d_val_len = get_linear_ht_len(d_len);
     
     ht_d = (int*)malloc_device(2 * d_val_len * sizeof(int), q);
     ht_s = (int*)malloc_device(2 * s_len * sizeof(int), q);
     ht_c = (int*)malloc_device(2 * c_len * sizeof(int), q);
     ht_p = (int*)malloc_device(2 * p_len * sizeof(int), q);
 
+    // Bloom filter of the selected suppliers, probed before ht_s
+    int bloom_s_len = get_bloom_len(s_len);
+    uint32_t *bloom_s = (uint32_t*)malloc_device(bloom_s_len * sizeof(uint32_t), q);
+
     q.memset(ht_d, 0, 2 * d_val_len * sizeof(int)).wait();
     q.memset(ht_s, 0, 2 * s_len * sizeof(int)).wait();
+    q.memset(bloom_s, 0, bloom_s_len * sizeof(uint32_t)).wait();
     q.memset(ht_c, 0, 2 * c_len * sizeof(int)).wait();
     q.memset(ht_p, 0, 2 * p_len * sizeof(int)).wait();
 
@@ -244,7 +254,7 @@ void runQuery(
 
         h.parallel_for<class build_s>(sycl::nd_range<1>({static_cast<size_t>(num_blocks_s * 128)},{128}),
             [=](sycl::nd_item<1>  it) {
-            build_hashtable_s<128,4>(s_region, s_suppkey, s_len, ht_s, s_len, it);
+            build_hashtable_s<128,4>(s_region, s_suppkey, s_len, ht_s, s_len, bloom_s, bloom_s_len, it);
             });
 
     });
@@ -281,13 +291,12 @@ void runQuery(
     int* p_res = new int[p_len * 2];
     q.memcpy(p_res, ht_p, p_len * 2 * sizeof(int)).wait();
 
-    int d_val_min = 19920101;
     int num_blocks_d = (d_len + tile_items - 1)/tile_items;
     q.submit([&](sycl::handler &h){
 
         h.parallel_for<class build_d>(sycl::nd_range<1>({static_cast<size_t>(num_blocks_d * 128)}, {128}),
             [=](sycl::nd_item<1>  it) {
-            build_hashtable_d<128,4>(d_datekey, d_year, d_len, ht_d, d_val_len, d_val_min, it);
+            build_hashtable_d<128,4>(d_datekey, d_year, d_len, ht_d, d_val_len, it);
             });
 
     });
@@ -309,7 +318,7 @@ void runQuery(
             [=](sycl::nd_item<1>  it) {
             probe<128,4>(lo_orderdate, lo_partkey, lo_custkey, lo_suppkey,
                         lo_revenue, lo_supplycost, lo_len, ht_p, p_len, ht_s,
-                        s_len, ht_c, c_len, ht_d, d_val_len, res, it);
+                        s_len, bloom_s, bloom_s_len, ht_c, c_len, ht_d, d_val_len, res, it);
             });
 
     }).wait();
@@ -340,6 +349,7 @@ void runQuery(
     sycl::free(ht_d, q);
     sycl::free(ht_p, q);
     sycl::free(ht_s, q);
+    sycl::free(bloom_s, q);
     sycl::free(ht_c, q);
   }
   catch (sycl::exception const &exc) {
@@ -353,6 +363,7 @@ void runQuery(
  * Main
  */
 int main(int argc, char **argv) try {
+  initCatalog(argc, argv);
   auto q = try_get_queue(sycl::default_selector{});
 
   // device
@@ -360,58 +371,58 @@ int main(int argc, char **argv) try {
   std::cout <<"Running on " << dev_name << '\n' ;
   int num_trials          = 3;
 
-  int *h_lo_orderdate = loadColumn<int>("lo_orderdate", LO_LEN);
-  int *h_lo_suppkey = loadColumn<int>("lo_suppkey", LO_LEN);
-  int *h_lo_custkey = loadColumn<int>("lo_custkey", LO_LEN);
-  int *h_lo_partkey = loadColumn<int>("lo_partkey", LO_LEN);
-  int *h_lo_revenue = loadColumn<int>("lo_revenue", LO_LEN);
-  int *h_lo_supplycost = loadColumn<int>("lo_supplycost", LO_LEN);
+  int *h_lo_orderdate = mapColumn<int>("lo_orderdate", catalog.lo_len);
+  int *h_lo_suppkey = mapColumn<int>("lo_suppkey", catalog.lo_len);
+  int *h_lo_custkey = mapColumn<int>("lo_custkey", catalog.lo_len);
+  int *h_lo_partkey = mapColumn<int>("lo_partkey", catalog.lo_len);
+  int *h_lo_revenue = mapColumn<int>("lo_revenue", catalog.lo_len);
+  int *h_lo_supplycost = mapColumn<int>("lo_supplycost", catalog.lo_len);
 
-  int *h_d_datekey = loadColumn<int>("d_datekey", D_LEN);
-  int *h_d_year = loadColumn<int>("d_year", D_LEN);
-  int *h_d_yearmonthnum = loadColumn<int>("d_yearmonthnum", D_LEN);
+  int *h_d_datekey = mapColumn<int>("d_datekey", catalog.d_len);
+  int *h_d_year = mapColumn<int>("d_year", catalog.d_len);
+  int *h_d_yearmonthnum = mapColumn<int>("d_yearmonthnum", catalog.d_len);
 
-  int *h_s_suppkey = loadColumn<int>("s_suppkey", S_LEN);
-  int *h_s_region = loadColumn<int>("s_region", S_LEN);
+  int *h_s_suppkey = mapColumn<int>("s_suppkey", catalog.s_len);
+  int *h_s_region = mapColumn<int>("s_region", catalog.s_len);
 
-  int *h_p_partkey = loadColumn<int>("p_partkey", P_LEN);
-  int *h_p_mfgr = loadColumn<int>("p_mfgr", P_LEN);
+  int *h_p_partkey = mapColumn<int>("p_partkey", catalog.p_len);
+  int *h_p_mfgr = mapColumn<int>("p_mfgr", catalog.p_len);
 
-  int *h_c_custkey = loadColumn<int>("c_custkey", C_LEN);
-  int *h_c_region = loadColumn<int>("c_region", C_LEN);
-  int *h_c_nation = loadColumn<int>("c_nation", C_LEN);
+  int *h_c_custkey = mapColumn<int>("c_custkey", catalog.c_len);
+  int *h_c_region = mapColumn<int>("c_region", catalog.c_len);
+  int *h_c_nation = mapColumn<int>("c_nation", catalog.c_len);
 
   cout << "** LOADED DATA **" << endl;
 
-  int *d_lo_orderdate = load_to_device<int>(h_lo_orderdate, LO_LEN, q);
-  int *d_lo_custkey = load_to_device<int>(h_lo_custkey, LO_LEN, q);
-  int *d_lo_suppkey = load_to_device<int>(h_lo_suppkey, LO_LEN, q);
-  int *d_lo_partkey = load_to_device<int>(h_lo_partkey, LO_LEN, q);
-  int *d_lo_revenue = load_to_device<int>(h_lo_revenue, LO_LEN, q);
-  int *d_lo_supplycost = load_to_device<int>(h_lo_supplycost, LO_LEN, q);
+  int *d_lo_orderdate = map_to_device<int>(h_lo_orderdate, catalog.lo_len, q);
+  int *d_lo_custkey = map_to_device<int>(h_lo_custkey, catalog.lo_len, q);
+  int *d_lo_suppkey = map_to_device<int>(h_lo_suppkey, catalog.lo_len, q);
+  int *d_lo_partkey = map_to_device<int>(h_lo_partkey, catalog.lo_len, q);
+  int *d_lo_revenue = map_to_device<int>(h_lo_revenue, catalog.lo_len, q);
+  int *d_lo_supplycost = map_to_device<int>(h_lo_supplycost, catalog.lo_len, q);
 
-  int *d_d_datekey = load_to_device<int>(h_d_datekey, D_LEN, q);
-  int *d_d_year = load_to_device<int>(h_d_year, D_LEN, q);
+  int *d_d_datekey = map_to_device<int>(h_d_datekey, catalog.d_len, q);
+  int *d_d_year = map_to_device<int>(h_d_year, catalog.d_len, q);
 
-  int *d_p_partkey = load_to_device<int>(h_p_partkey, P_LEN, q);
-  int *d_p_mfgr = load_to_device<int>(h_p_mfgr, P_LEN, q);
+  int *d_p_partkey = map_to_device<int>(h_p_partkey, catalog.p_len, q);
+  int *d_p_mfgr = map_to_device<int>(h_p_mfgr, catalog.p_len, q);
 
-  int *d_s_suppkey = load_to_device<int>(h_s_suppkey, S_LEN, q);
-  int *d_s_region = load_to_device<int>(h_s_region, S_LEN, q);
+  int *d_s_suppkey = map_to_device<int>(h_s_suppkey, catalog.s_len, q);
+  int *d_s_region = map_to_device<int>(h_s_region, catalog.s_len, q);
 
-  int *d_c_custkey = load_to_device<int>(h_c_custkey, C_LEN, q);
-  int *d_c_region = load_to_device<int>(h_c_region, C_LEN, q);
-  int *d_c_nation = load_to_device<int>(h_c_nation, C_LEN, q);
+  int *d_c_custkey = map_to_device<int>(h_c_custkey, catalog.c_len, q);
+  int *d_c_region = map_to_device<int>(h_c_region, catalog.c_len, q);
+  int *d_c_nation = map_to_device<int>(h_c_nation, catalog.c_len, q);
 
   cout << "** LOADED DATA TO DEVICE: " << dev_name << " **" << endl;
 
   for (int t = 0; t < num_trials; t++) {
     runQuery(q, 
-        d_lo_orderdate, d_lo_custkey, d_lo_partkey, d_lo_suppkey, d_lo_revenue, d_lo_supplycost, LO_LEN,
-        d_d_datekey, d_d_year, D_LEN,
-        d_p_partkey, d_p_mfgr, P_LEN,
-        d_s_suppkey, d_s_region, S_LEN,
-        d_c_custkey, d_c_region, d_c_nation, C_LEN
+        d_lo_orderdate, d_lo_custkey, d_lo_partkey, d_lo_suppkey, d_lo_revenue, d_lo_supplycost, catalog.lo_len,
+        d_d_datekey, d_d_year, catalog.d_len,
+        d_p_partkey, d_p_mfgr, catalog.p_len,
+        d_s_suppkey, d_s_region, catalog.s_len,
+        d_c_custkey, d_c_region, d_c_nation, catalog.c_len
     );
   }
 
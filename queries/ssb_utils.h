@@ -1,37 +1,21 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include <sys/stat.h>
 
-using namespace std;
+#include "../oneapi_crystal/tools/mapped_column.hpp"
 
-#define SF 1
+using namespace std;
 
 #define BASE_PATH "/home/u141905/sp/oneapi-crystal/ssb/data/"
 
-#if SF == 1
-#define DATA_DIR BASE_PATH "s1_columnar/"
-#define LO_LEN 6001171
-#define P_LEN 200000
-#define S_LEN 2000
-#define C_LEN 30000
-#define D_LEN 2556
-#elif SF == 10
-#define DATA_DIR BASE_PATH "s10_columnar/"
-#define LO_LEN 59986214
-#define P_LEN 800000
-#define S_LEN 20000
-#define C_LEN 300000
-#define D_LEN 2556
-#else // 20
-#define DATA_DIR BASE_PATH "s20_columnar/"
-#define LO_LEN 119994746
-#define P_LEN 1000000
-#define S_LEN 40000
-#define C_LEN 600000
-#define D_LEN 2556
-#endif
-
-
+// dataset used when --data-dir is not given
+#define DEFAULT_DATA_DIR BASE_PATH "s1_columnar/"
 
 int index_of(string* arr, int len, string val) {
   for (int i=0; i<len; i++)
@@ -68,10 +52,146 @@ string lookup(string col_name) {
   return "";
 }
 
+// dataset the query runs on, filled in by initCatalog; it also
+// owns the files mapped and the columns encoded for the query,
+// released at exit
+struct Catalog {
+  string data_dir = DEFAULT_DATA_DIR;
+  int lo_len = 0;
+  int p_len = 0;
+  int s_len = 0;
+  int c_len = 0;
+  int d_len = 0;
+  vector<function<void()>> mappings;
+
+  ~Catalog() {
+    for (function<void()> &release : mappings) {
+      release();
+    }
+  }
+};
+
+Catalog catalog;
+
+long fileSize(string filename) {
+  struct stat st;
+  if (stat(filename.c_str(), &st) != 0) {
+    return -1;
+  }
+
+  return st.st_size;
+}
+
+// row counts written by the loader into <data_dir>/METADATA
+// as "<TABLE> <rows>" lines, a later line overrides an earlier one
+map<string, long> readMetadata(string data_dir) {
+  map<string, long> rows;
+  ifstream meta ((data_dir + "METADATA").c_str());
+  string table;
+  long num_rows;
+
+  while (meta >> table >> num_rows) {
+    rows[table] = num_rows;
+  }
+
+  return rows;
+}
+
+// number of rows of a table, taken from METADATA or, for
+// datasets loaded before it existed, from the size of its
+// first column (always a 4 byte key)
+int tableRows(map<string, long> &rows, string data_dir, string table) {
+  if (rows.count(table)) {
+    return rows[table];
+  }
+
+  long size = fileSize(data_dir + table + "0");
+  return size < 0 ? -1 : size / sizeof(int);
+}
+
+// number of rows of the table a column belongs to
+int columnRows(string col_name) {
+  switch (col_name[0]) {
+    case 'l': return catalog.lo_len;
+    case 'p': return catalog.p_len;
+    case 's': return catalog.s_len;
+    case 'c': return catalog.c_len;
+    case 'd': return catalog.d_len;
+  }
+
+  return 0;
+}
+
+// width in bytes of a column entry, as found on disk
+int columnWidth(string col_name) {
+  int num_rows = columnRows(col_name);
+  long size = fileSize(catalog.data_dir + lookup(col_name));
+  if (size < 0 || num_rows <= 0) {
+    return -1;
+  }
+
+  return size / num_rows;
+}
+
+// whether the command line holds the given flag
+bool hasFlag(int argc, char** argv, string flag) {
+  for (int i = 1; i < argc; i++) {
+    if (argv[i] == flag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// value of an integer flag given as <flag> <n>, fallback if absent
+int flagValue(int argc, char** argv, string flag, int fallback) {
+  for (int i = 1; i + 1 < argc; i++) {
+    if (argv[i] == flag) {
+      return atoi(argv[i + 1]);
+    }
+  }
+  return fallback;
+}
+
+// parses --data-dir <dir> (or --data-dir=<dir>) and
+// fills the catalog with the row counts of that dataset
+void initCatalog(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "--data-dir") {
+      catalog.data_dir = i + 1 < argc ? argv[++i] : "";
+    } else if (arg.rfind("--data-dir=", 0) == 0) {
+      catalog.data_dir = arg.substr(11);
+    }
+  }
+
+  if (catalog.data_dir.empty()) {
+    cerr << "[Error] --data-dir needs a directory" << endl;
+    exit(1);
+  }
+
+  if (catalog.data_dir.back() != '/') {
+    catalog.data_dir += '/';
+  }
+
+  map<string, long> rows = readMetadata(catalog.data_dir);
+  catalog.lo_len = tableRows(rows, catalog.data_dir, "LINEORDER");
+  catalog.p_len = tableRows(rows, catalog.data_dir, "PART");
+  catalog.s_len = tableRows(rows, catalog.data_dir, "SUPPLIER");
+  catalog.c_len = tableRows(rows, catalog.data_dir, "CUSTOMER");
+  catalog.d_len = tableRows(rows, catalog.data_dir, "DDATE");
+
+  if (catalog.lo_len <= 0 || catalog.p_len <= 0 || catalog.s_len <= 0 ||
+      catalog.c_len <= 0 || catalog.d_len <= 0) {
+    cerr << "[Error] No SSB dataset found in " << catalog.data_dir << endl;
+    exit(1);
+  }
+}
+
 template<typename T>
 T* loadColumn(string col_name, int num_entries) {
   T* h_col = new T[num_entries];
-  string filename = DATA_DIR + lookup(col_name);
+  string filename = catalog.data_dir + lookup(col_name);
   ifstream colData (filename.c_str(), ios::in | ios::binary);
   if (!colData) {
     return NULL;
@@ -81,9 +201,343 @@ T* loadColumn(string col_name, int num_entries) {
   return h_col;
 }
 
+// hands a mapped file over to the catalog, which unmaps it at exit
+template<typename T>
+T* keepMapped(T* file, size_t num_entries) {
+  if (file != NULL) {
+    catalog.mappings.push_back([file, num_entries]() {
+      crystal::unmap_column(file, num_entries);
+    });
+  }
+  return file;
+}
+
+// hands a column encoded on the host over to the catalog, which
+// frees it at exit
+template<typename T>
+T* keepAllocated(T* buf) {
+  if (buf != NULL) {
+    catalog.mappings.push_back([buf]() {
+      delete[] buf;
+    });
+  }
+  return buf;
+}
+
+// maps the column file instead of reading it,
+// release with crystal::unmap_column
+template<typename T>
+T* mapColumnFile(string col_name, int num_entries) {
+  if (columnWidth(col_name) != sizeof(T)) {
+    cerr << "[Error] " << col_name << " is not a column of "
+         << sizeof(T) << " byte entries" << endl;
+    return NULL;
+  }
+
+  string filename = catalog.data_dir + lookup(col_name);
+  return crystal::map_column<T>(filename, num_entries);
+}
+
+// maps the column file for the rest of the run
+template<typename T>
+T* mapColumn(string col_name, int num_entries) {
+  return keepMapped(mapColumnFile<T>(col_name, num_entries), num_entries);
+}
+
+// column bit-packed by ssb/loader/bitpack.c, stored next to
+// the plain one with a .bp suffix; words holds the whole file
+struct BitpackedColumn {
+  int *words = NULL;
+  int num_words = 0;
+  int num_entries = 0;
+  int num_blocks = 0;
+};
+
+BitpackedColumn mapBitpackedColumn(string col_name) {
+  BitpackedColumn col;
+  string filename = catalog.data_dir + lookup(col_name) + ".bp";
+  long size = fileSize(filename);
+  if (size < 0) {
+    return col;
+  }
+
+  col.num_words = size / sizeof(int);
+  col.words = keepMapped(crystal::map_column<int>(filename, col.num_words), col.num_words);
+  if (col.words != NULL) {
+    col.num_entries = col.words[0];
+    col.num_blocks = col.words[1];
+  }
+
+  return col;
+}
+
+// offsets of the blocks and the packed data, given the
+// (possibly device) copy of the words of a bit-packed column
+inline uint32_t* bitpackedBlockStarts(int *words) {
+  return (uint32_t*)words + 2;
+}
+
+inline uint32_t* bitpackedData(int *words, int num_blocks) {
+  return (uint32_t*)words + 2 + num_blocks + 1;
+}
+
+// dictionary-encoded column as written by ssb/loader/dict.c
+// (columnHeader, dictHeader, packed codes), stored next to the
+// plain one with a .dict suffix, see crystal::load_dict
+#define COLUMN_HEADER_SIZE 4096
+#define DICT_FORMAT 1
+#define MAX_DICT_NUM 30000
+
+struct DictColumn {
+  uint32_t *codes = NULL;
+  int num_words = 0;
+  int *dict = NULL;
+  int dict_len = 0;
+  int bit_width = 0;
+};
+
+// encodes a plain column on the host, for datasets
+// whose dimension columns were not compressed
+DictColumn encodeDictColumn(string col_name, int num_entries) {
+  DictColumn col;
+  int *plain = mapColumnFile<int>(col_name, num_entries);
+  if (plain == NULL) {
+    return col;
+  }
+
+  vector<int> values(plain, plain + num_entries);
+  sort(values.begin(), values.end());
+  values.erase(unique(values.begin(), values.end()), values.end());
+
+  // byte aligned codes, like dict.c
+  col.bit_width = 8;
+  while ((1L << col.bit_width) < (long)values.size()) {
+    col.bit_width += 8;
+  }
+
+  if (col.bit_width >= 32) {
+    crystal::unmap_column(plain, num_entries);
+    return DictColumn();
+  }
+
+  int codes_per_word = 32 / col.bit_width;
+  col.dict_len = values.size();
+  col.dict = keepAllocated(new int[col.dict_len]);
+  copy(values.begin(), values.end(), col.dict);
+
+  col.num_words = (num_entries + codes_per_word - 1) / codes_per_word;
+  col.codes = keepAllocated(new uint32_t[col.num_words]());
+  for (int i = 0; i < num_entries; i++) {
+    uint32_t code = lower_bound(values.begin(), values.end(), plain[i]) - values.begin();
+    col.codes[i / codes_per_word] |= code << ((i % codes_per_word) * col.bit_width);
+  }
+
+  crystal::unmap_column(plain, num_entries);
+  return col;
+}
+
+DictColumn loadDictColumn(string col_name, int num_entries) {
+  string filename = catalog.data_dir + lookup(col_name) + ".dict";
+  long size = fileSize(filename);
+  char *file = size < 0 ? NULL : crystal::map_column<char>(filename, size);
+
+  if (file == NULL) {
+    return encodeDictColumn(col_name, num_entries);
+  }
+
+  // columnHeader: totalTupleNum, tupleNum, blockSize, blockTotal, blockId, format;
+  // then dictHeader: dictNum, bitNum, the dictionary of MAX_DICT_NUM ints
+  long dict_end = COLUMN_HEADER_SIZE + (2 + MAX_DICT_NUM) * sizeof(int);
+  string error;
+  DictColumn col;
+
+  if (size < dict_end) {
+    error = "is too short for a dictionary";
+  } else {
+    long total_tuples = *(long*)file;
+    int block_total = *(int*)(file + 3 * sizeof(long));
+    int format = *(int*)(file + 3 * sizeof(long) + 2 * sizeof(int));
+
+    int *dict_header = (int*)(file + COLUMN_HEADER_SIZE);
+    col.dict_len = dict_header[0];
+    col.bit_width = dict_header[1];
+    col.dict = dict_header + 2;
+    col.codes = (uint32_t*)(dict_header + 2 + MAX_DICT_NUM);
+
+    // dict_code decodes byte aligned codes only, as dict.c writes them
+    if (format != DICT_FORMAT || block_total != 1 || total_tuples != num_entries) {
+      error = "is not a single block dictionary of " + col_name;
+    } else if (col.bit_width != 8 && col.bit_width != 16) {
+      error = "has " + to_string(col.bit_width) + " bit codes, not 8 or 16";
+    } else if (col.dict_len < 0 || col.dict_len > MAX_DICT_NUM || col.dict_len > (1 << col.bit_width)) {
+      error = "has a dictionary of " + to_string(col.dict_len) + " values";
+    } else {
+      int codes_per_word = 32 / col.bit_width;
+      col.num_words = (num_entries + codes_per_word - 1) / codes_per_word;
+      if (size < dict_end + (long)col.num_words * (long)sizeof(uint32_t)) {
+        error = "is too short for the codes of " + to_string(num_entries) + " rows";
+      }
+    }
+  }
+
+  if (!error.empty()) {
+    cerr << "[Warning] " << filename << " " << error << ", encoding it on the host" << endl;
+    crystal::unmap_column(file, size);
+    return encodeDictColumn(col_name, num_entries);
+  }
+
+  keepMapped(file, size);
+  return col;
+}
+
+// code of value in the dictionary, -1 (matching no
+// code) when the value does not occur in the column
+int dictCode(const DictColumn &col, int value) {
+  for (int i = 0; i < col.dict_len; i++) {
+    if (col.dict[i] == value) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+// run-length encoded column as written by ssb/loader/rle.c
+// (columnHeader, rleHeader, then values, counts and starting
+// positions of the runs), stored next to the plain one with a
+// .rle suffix, see crystal::load_rle and crystal::predicate_rle
+#define RLE_FORMAT 0
+
+struct RleColumn {
+  int *values = NULL;
+  int *counts = NULL;
+  int *pos = NULL;
+  int num_runs = 0;
+};
+
+// encodes a plain column on the host, results are the same but
+// runs are only long (and scans cheap) if the column is sorted
+RleColumn encodeRleColumn(string col_name, int num_entries) {
+  RleColumn col;
+  int *plain = mapColumnFile<int>(col_name, num_entries);
+  if (plain == NULL || num_entries == 0) {
+    return col;
+  }
+
+  vector<int> values, counts, pos;
+  for (int i = 0; i < num_entries; i++) {
+    if (i == 0 || plain[i] != values.back()) {
+      values.push_back(plain[i]);
+      counts.push_back(0);
+      pos.push_back(i);
+    }
+    counts.back()++;
+  }
+
+  col.num_runs = values.size();
+  col.values = keepAllocated(new int[3 * col.num_runs]);
+  col.counts = col.values + col.num_runs;
+  col.pos = col.counts + col.num_runs;
+  copy(values.begin(), values.end(), col.values);
+  copy(counts.begin(), counts.end(), col.counts);
+  copy(pos.begin(), pos.end(), col.pos);
+
+  crystal::unmap_column(plain, num_entries);
+  return col;
+}
+
+RleColumn loadRleColumn(string col_name, int num_entries) {
+  string filename = catalog.data_dir + lookup(col_name) + ".rle";
+  long size = fileSize(filename);
+  char *file = size < 0 ? NULL : crystal::map_column<char>(filename, size);
+
+  if (file == NULL) {
+    return encodeRleColumn(col_name, num_entries);
+  }
+
+  long total_tuples = *(long*)file;
+  int block_total = *(int*)(file + 3 * sizeof(long));
+  int format = *(int*)(file + 3 * sizeof(long) + 2 * sizeof(int));
+
+  if (format != RLE_FORMAT || block_total != 1 || total_tuples != num_entries) {
+    cerr << "[Warning] " << filename << " is not a single block RLE column of "
+         << col_name << ", encoding it on the host" << endl;
+    crystal::unmap_column(file, size);
+    return encodeRleColumn(col_name, num_entries);
+  }
+
+  keepMapped(file, size);
+
+  RleColumn col;
+  int *rle_header = (int*)(file + COLUMN_HEADER_SIZE);
+  col.num_runs = rle_header[0];
+  col.values = rle_header + 1;
+  col.counts = col.values + col.num_runs;
+  col.pos = col.counts + col.num_runs;
+  return col;
+}
+
+// zone map of a column as written by ssb/loader/zonemap.c
+// (zoneMapHeader, minimums, maximums), stored next to the
+// plain column with a .zm suffix, see crystal::zone_map_may_match
+#define ZONE_SIZE 512
+
+struct ZoneMap {
+  int *zone_min = NULL;
+  int *zone_max = NULL;
+  int zone_size = 0;
+  int num_zones = 0;
+};
+
+ZoneMap buildZoneMap(string col_name, int num_entries) {
+  ZoneMap zm;
+  int *plain = mapColumnFile<int>(col_name, num_entries);
+  if (plain == NULL) {
+    return zm;
+  }
+
+  zm.zone_size = ZONE_SIZE;
+  zm.num_zones = (num_entries + ZONE_SIZE - 1) / ZONE_SIZE;
+  zm.zone_min = keepAllocated(new int[2 * zm.num_zones]);
+  zm.zone_max = zm.zone_min + zm.num_zones;
+
+  for (int z = 0; z < zm.num_zones; z++) {
+    int first = z * ZONE_SIZE;
+    int last = min(first + ZONE_SIZE, num_entries);
+    zm.zone_min[z] = *min_element(plain + first, plain + last);
+    zm.zone_max[z] = *max_element(plain + first, plain + last);
+  }
+
+  crystal::unmap_column(plain, num_entries);
+  return zm;
+}
+
+ZoneMap loadZoneMap(string col_name, int num_entries) {
+  string filename = catalog.data_dir + lookup(col_name) + ".zm";
+  long size = fileSize(filename);
+  int *file = size < 0 ? NULL : crystal::map_column<int>(filename, size / sizeof(int));
+
+  // header: totalTupleNum, zoneSize, zoneNum
+  if (file == NULL || file[0] != num_entries) {
+    if (file != NULL) {
+      crystal::unmap_column(file, size / sizeof(int));
+    }
+    return buildZoneMap(col_name, num_entries);
+  }
+
+  keepMapped(file, size / sizeof(int));
+
+  ZoneMap zm;
+  zm.zone_size = file[1];
+  zm.num_zones = file[2];
+  zm.zone_min = file + 3;
+  zm.zone_max = zm.zone_min + zm.num_zones;
+  return zm;
+}
+
 template<typename T>
 int storeColumn(string col_name, int num_entries, int* h_col) {
-  string filename = DATA_DIR + lookup(col_name);
+  string filename = catalog.data_dir + lookup(col_name);
   ofstream colData (filename.c_str(), ios::out | ios::binary);
   if (!colData) {
     return -1;
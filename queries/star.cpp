@@ -0,0 +1,385 @@
+#include <CL/sycl.hpp>
+
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <oneapi/mkl.hpp>
+
+#include <oneapi_crystal/crystal.hpp>
+
+#include "ssb_utils.h"
+#include "../oneapi_crystal/tools/queue_helpers.hpp"
+#include "../oneapi_crystal/tools/duration_logger.hpp"
+#include "../oneapi_crystal/tools/multi_device.hpp"
+
+using namespace crystal;
+using namespace std;
+
+// The SSB queries written as plans for the star query engine,
+// run with: star <query> [--data-dir <dir>] [--coexec [--batch-rows <n>]] [--check]
+// New ad-hoc queries only need an entry here
+map<string, StarQuery> ssb_queries() {
+  DimensionSpec date_year = {"lo_orderdate", "d_datekey", {}, "d_year", 1992, 7};
+
+  map<string, StarQuery> queries;
+
+  queries["q11"] = {"q11",
+    {{"lo_orderdate", Filter::between(19930101, 19931231)},
+     {"lo_quantity", Filter::between(1, 24)},
+     {"lo_discount", Filter::between(1, 3)}},
+    {}, MeasureKind::sum_product, "lo_extendedprice", "lo_discount"};
+
+  queries["q12"] = {"q12",
+    {{"lo_orderdate", Filter::between(19940101, 19940131)},
+     {"lo_quantity", Filter::between(26, 35)},
+     {"lo_discount", Filter::between(4, 6)}},
+    {}, MeasureKind::sum_product, "lo_extendedprice", "lo_discount"};
+
+  // week 6 of 1994
+  queries["q13"] = {"q13",
+    {{"lo_orderdate", Filter::between(19940204, 19940210)},
+     {"lo_quantity", Filter::between(26, 35)},
+     {"lo_discount", Filter::between(5, 7)}},
+    {}, MeasureKind::sum_product, "lo_extendedprice", "lo_discount"};
+
+  queries["q21"] = {"q21", {},
+    {{"lo_suppkey", "s_suppkey", {"s_region", Filter::eq(1)}},
+     {"lo_partkey", "p_partkey", {"p_category", Filter::eq(1)}, "p_brand1", 0, 1000},
+     date_year},
+    MeasureKind::sum, "lo_revenue"};
+
+  queries["q22"] = {"q22", {},
+    {{"lo_suppkey", "s_suppkey", {"s_region", Filter::eq(2)}},
+     {"lo_partkey", "p_partkey", {"p_brand1", Filter::between(260, 267)}, "p_brand1", 0, 1000},
+     date_year},
+    MeasureKind::sum, "lo_revenue"};
+
+  queries["q23"] = {"q23", {},
+    {{"lo_suppkey", "s_suppkey", {"s_region", Filter::eq(3)}},
+     {"lo_partkey", "p_partkey", {"p_brand1", Filter::eq(260)}, "p_brand1", 0, 1000},
+     date_year},
+    MeasureKind::sum, "lo_revenue"};
+
+  queries["q31"] = {"q31", {},
+    {{"lo_custkey", "c_custkey", {"c_region", Filter::eq(2)}, "c_nation", 0, 25},
+     {"lo_suppkey", "s_suppkey", {"s_region", Filter::eq(2)}, "s_nation", 0, 25},
+     {"lo_orderdate", "d_datekey", {"d_year", Filter::between(1992, 1997)}, "d_year", 1992, 7}},
+    MeasureKind::sum, "lo_revenue"};
+
+  queries["q32"] = {"q32", {},
+    {{"lo_custkey", "c_custkey", {"c_nation", Filter::eq(24)}, "c_city", 0, 250},
+     {"lo_suppkey", "s_suppkey", {"s_nation", Filter::eq(24)}, "s_city", 0, 250},
+     {"lo_orderdate", "d_datekey", {"d_year", Filter::between(1992, 1997)}, "d_year", 1992, 7}},
+    MeasureKind::sum, "lo_revenue"};
+
+  queries["q33"] = {"q33", {},
+    {{"lo_custkey", "c_custkey", {"c_city", Filter::eq_or(231, 235)}, "c_city", 0, 250},
+     {"lo_suppkey", "s_suppkey", {"s_city", Filter::eq_or(231, 235)}, "s_city", 0, 250},
+     {"lo_orderdate", "d_datekey", {"d_year", Filter::between(1992, 1997)}, "d_year", 1992, 7}},
+    MeasureKind::sum, "lo_revenue"};
+
+  queries["q34"] = {"q34", {},
+    {{"lo_custkey", "c_custkey", {"c_city", Filter::eq_or(231, 235)}, "c_city", 0, 250},
+     {"lo_suppkey", "s_suppkey", {"s_city", Filter::eq_or(231, 235)}, "s_city", 0, 250},
+     {"lo_orderdate", "d_datekey", {"d_yearmonthnum", Filter::eq(199712)}, "d_year", 1992, 7}},
+    MeasureKind::sum, "lo_revenue"};
+
+  queries["q41"] = {"q41", {},
+    {{"lo_suppkey", "s_suppkey", {"s_region", Filter::eq(1)}},
+     {"lo_custkey", "c_custkey", {"c_region", Filter::eq(1)}, "c_nation", 0, 25},
+     {"lo_partkey", "p_partkey", {"p_mfgr", Filter::eq_or(0, 1)}},
+     date_year},
+    MeasureKind::sum_difference, "lo_revenue", "lo_supplycost"};
+
+  queries["q42"] = {"q42", {},
+    {{"lo_custkey", "c_custkey", {"c_region", Filter::eq(1)}},
+     {"lo_suppkey", "s_suppkey", {"s_region", Filter::eq(1)}, "s_nation", 0, 25},
+     {"lo_partkey", "p_partkey", {"p_mfgr", Filter::eq_or(0, 1)}, "p_category", 0, 25},
+     {"lo_orderdate", "d_datekey", {"d_year", Filter::eq_or(1997, 1998)}, "d_year", 1992, 7}},
+    MeasureKind::sum_difference, "lo_revenue", "lo_supplycost"};
+
+  queries["q43"] = {"q43", {},
+    {{"lo_custkey", "c_custkey", {"c_region", Filter::eq(1)}},
+     {"lo_suppkey", "s_suppkey", {"s_nation", Filter::eq(24)}, "s_city", 0, 250},
+     {"lo_partkey", "p_partkey", {"p_category", Filter::eq(3)}, "p_brand1", 0, 1000},
+     {"lo_orderdate", "d_datekey", {"d_year", Filter::eq_or(1997, 1998)}, "d_year", 1992, 7}},
+    MeasureKind::sum_difference, "lo_revenue", "lo_supplycost"};
+
+  // the most selective plans only carry the surviving rows past their first stage
+  queries["q13"].compact = true;
+  queries["q43"].compact = true;
+
+  return queries;
+}
+
+/**
+ * The query evaluated row by row on the host from the mapped columns,
+ * as the hand-written queries compute it, indexed as run_star_query
+ * returns its groups. Empty when a column is missing
+ */
+vector<unsigned long long> star_reference(const StarQuery &query)
+{
+  map<string, int*> host_columns;
+  bool resolved = true;
+
+  auto column = [&](const string &name) -> int* {
+    if (name.empty()) return NULL;
+    if (host_columns.count(name) == 0) {
+      host_columns[name] = mapColumn<int>(name, columnRows(name));
+      resolved = resolved && host_columns[name] != NULL;
+    }
+    return host_columns[name];
+  };
+
+  int fact_len = columnRows(query.measure_a);
+  int *measure_a = column(query.measure_a);
+  int *measure_b = column(query.measure_b);
+
+  vector<int*> filter_columns;
+  for (const FilterSpec &filter : query.filters) {
+    filter_columns.push_back(column(filter.column));
+  }
+
+  // per dimension, the grouping value (0 if it does not group) of the selected keys
+  int num_groups = 1;
+  vector<unordered_map<int, int>> dim_values(query.dims.size());
+  vector<int*> fact_fkeys;
+
+  for (size_t d = 0; d < query.dims.size(); d++) {
+    const DimensionSpec &spec = query.dims[d];
+    int dim_len = columnRows(spec.key);
+    int *key = column(spec.key);
+    int *filter_column = column(spec.filter.column);
+    int *group_column = column(spec.group_column);
+    fact_fkeys.push_back(column(spec.fact_fkey));
+
+    if (!resolved) {
+      return {};
+    }
+
+    for (int i = 0; i < dim_len; i++) {
+      if (filter_column == NULL || spec.filter.filter(filter_column[i])) {
+        dim_values[d][key[i]] = group_column == NULL ? 0 : group_column[i];
+      }
+    }
+
+    if (group_column != NULL) {
+      num_groups *= spec.group_cardinality;
+    }
+  }
+
+  if (!resolved) {
+    return {};
+  }
+
+  vector<unsigned long long> groups(num_groups, 0);
+
+  for (int row = 0; row < fact_len; row++) {
+    bool selected = true;
+    for (size_t f = 0; f < query.filters.size() && selected; f++) {
+      selected = query.filters[f].filter(filter_columns[f][row]);
+    }
+
+    int group = 0;
+    for (size_t d = 0; d < query.dims.size() && selected; d++) {
+      const DimensionSpec &spec = query.dims[d];
+      auto match = dim_values[d].find(fact_fkeys[d][row]);
+      selected = match != dim_values[d].end();
+
+      if (selected && !spec.group_column.empty()) {
+        int value = match->second - spec.group_min;
+        selected = value >= 0 && value < spec.group_cardinality;
+        group = group * spec.group_cardinality + value;
+      }
+    }
+
+    if (!selected) {
+      continue;
+    }
+
+    switch (query.measure) {
+      case MeasureKind::sum_product:
+        groups[group] += (long long)measure_a[row] * measure_b[row];
+        break;
+      case MeasureKind::sum_difference:
+        groups[group] += (long long)measure_a[row] - measure_b[row];
+        break;
+      default:
+        groups[group] += measure_a[row];
+    }
+  }
+
+  return groups;
+}
+
+/**
+ * @brief Compares the groups of the engine with the host reference,
+ *        reporting every mismatch; true if they all match
+ */
+bool check_groups(const StarQuery &query, const vector<unsigned long long> &groups,
+                  const vector<unsigned long long> &reference)
+{
+  if (groups.size() != reference.size()) {
+    cerr << "[Error] " << query.name << ": " << groups.size() << " groups, expected "
+         << reference.size() << endl;
+    return false;
+  }
+
+  int mismatches = 0;
+  for (size_t g = 0; g < groups.size(); g++) {
+    if (groups[g] != reference[g]) {
+      cerr << "[Error] " << query.name << ": group";
+      for (int value : star_group_values(query, g)) cerr << " " << value;
+      cerr << " is " << groups[g] << ", expected " << reference[g] << endl;
+      mismatches++;
+    }
+  }
+
+  if (mismatches == 0) {
+    cout << "Check: " << query.name << " matches the host reference" << endl;
+  }
+  return mismatches == 0;
+}
+
+/**
+ * Main
+ */
+int main(int argc, char** argv)
+{
+  map<string, StarQuery> queries = ssb_queries();
+  string name = argc > 1 ? argv[1] : "";
+
+  if (queries.count(name) == 0) {
+    cerr << "usage: " << argv[0] << " <query> [--data-dir <dir>] [--coexec [--batch-rows <n>]] [--check],"
+         << " query one of:";
+    for (auto &query : queries) cerr << " " << query.first;
+    cerr << endl;
+    return 1;
+  }
+
+  initCatalog(argc, argv);
+  auto q = try_get_queue(sycl::default_selector{});
+
+  // device
+  auto dev_name = q.get_device().get_info<sycl::info::device::name>();
+  std::cout <<"Running on " << dev_name << '\n' ;
+
+  // number of running trials
+  int num_trials          = 3;
+
+  // columns are loaded to the device the first time the plan
+  // uses them, so the first trial also accounts for the transfers
+  map<string, int*> columns;
+  ColumnResolver resolve = [&](const string &column, int &len) -> int* {
+    len = columnRows(column);
+    if (columns.count(column) == 0) {
+      int *h_col = mapColumn<int>(column, len);
+      columns[column] = h_col == NULL ? NULL : map_to_device<int>(h_col, len, q);
+    }
+    return columns[column];
+  };
+
+  const StarQuery &query = queries[name];
+
+  // --check: every trial is compared with the query evaluated on the host
+  bool check = hasFlag(argc, argv, "--check");
+  vector<unsigned long long> reference;
+  if (check) {
+    reference = star_reference(query);
+    if (reference.empty()) {
+      cerr << "[Error] " << name << ": the host reference cannot be computed" << endl;
+      return 1;
+    }
+  }
+
+  // --coexec: every device (e.g. CPU and integrated GPU) pulls batches
+  // of lineorder tiles from a shared counter until none is left
+  if (hasFlag(argc, argv, "--coexec")) {
+    vector<sycl::queue> queues = get_all_queues();
+    int batch_items = flagValue(argc, argv, "--batch-rows", 1 << 19);
+
+    // host mappings are shared, device copies are per queue
+    map<string, int*> host_columns;
+    vector<map<string, int*>> device_columns(queues.size());
+    mutex columns_mutex;
+    vector<ColumnResolver> resolvers;
+
+    for (int d = 0; d < (int)queues.size(); d++) {
+      cout << "Device " << d << ": " << queues[d].get_device().get_info<sycl::info::device::name>() << endl;
+
+      resolvers.push_back([&, d](const string &column, int &len) -> int* {
+        lock_guard<mutex> lock(columns_mutex);
+        len = columnRows(column);
+        if (host_columns.count(column) == 0) {
+          host_columns[column] = mapColumn<int>(column, len);
+        }
+        if (device_columns[d].count(column) == 0) {
+          int *h_col = host_columns[column];
+          device_columns[d][column] = h_col == NULL ? NULL : map_to_device<int>(h_col, len, queues[d]);
+        }
+        return device_columns[d][column];
+      });
+    }
+
+    for (int t = 0; t < num_trials; t++) {
+      chrono::high_resolution_clock::time_point st, finish;
+      st = chrono::high_resolution_clock::now();
+
+      vector<co_execution_stats> stats;
+      vector<unsigned long long> groups = run_star_query_coexec(queues, query, resolvers, batch_items, &stats);
+
+      finish = chrono::high_resolution_clock::now();
+      std::chrono::duration<double> diff = finish - st;
+
+      if (groups.empty() || (check && !check_groups(query, groups, reference))) {
+        return 1;
+      }
+
+      int res_count = 0;
+      for (int g = 0; g < (int)groups.size(); g++) {
+        if (groups[g] != 0) {
+          for (int value : star_group_values(query, g)) cout << value << " ";
+          cout << groups[g] << endl;
+          res_count += 1;
+        }
+      }
+
+      cout << "Res Count: " << res_count << endl;
+      for (int d = 0; d < (int)stats.size(); d++) {
+        cout << "Device " << d << ": " << stats[d].batches << " batches, " << stats[d].ms << " ms" << endl;
+      }
+      cout << "Time Taken Total: " << diff.count() * 1000 << endl;
+    }
+
+    return 0;
+  }
+
+  for (int t = 0; t < num_trials; t++) {
+    chrono::high_resolution_clock::time_point st, finish;
+    st = chrono::high_resolution_clock::now();
+
+    vector<unsigned long long> groups = run_star_query(q, query, resolve);
+
+    finish = chrono::high_resolution_clock::now();
+    std::chrono::duration<double> diff = finish - st;
+
+    if (groups.empty() || (check && !check_groups(query, groups, reference))) {
+      return 1;
+    }
+
+    int res_count = 0;
+    for (int g = 0; g < (int)groups.size(); g++) {
+      if (groups[g] != 0) {
+        for (int value : star_group_values(query, g)) cout << value << " ";
+        cout << groups[g] << endl;
+        res_count += 1;
+      }
+    }
+
+    cout << "Res Count: " << res_count << endl;
+    cout << "Time Taken Total: " << diff.count() * 1000 << endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * @file bitpack.c
+ * Compress lineorder columns used in the Star Schema Benchmark using
+ * frame of reference and bit-packing (GPU-FOR).
+ * The input is a plain column as written by the columnar loader.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <string.h>
+#include "include/common.h"
+
+int main(int argc, char ** argv){
+
+	if(argc !=3 ){
+		printf("Usage: bitpackCompression inputColumn outputColumn\n");
+		exit(-1);
+	}
+
+	int inFd = open(argv[1],O_RDONLY);
+
+	if(inFd == -1){
+		printf("Failed to open the input column\n");
+		exit(-1);
+	}
+
+	struct stat st;
+	fstat(inFd, &st);
+
+	long tupleNum = st.st_size / sizeof(int);
+	if(tupleNum == 0){
+		printf("The input column is empty\n");
+		exit(-1);
+	}
+
+	int *content = (int *) mmap(0,st.st_size,PROT_READ,MAP_SHARED,inFd,0);
+	if(content == MAP_FAILED){
+		printf("Failed to map the input column\n");
+		exit(-1);
+	}
+
+	struct bitpackHeader header;
+	header.totalTupleNum = tupleNum;
+	header.blockNum = (tupleNum + BITPACK_BLOCK_SIZE - 1) / BITPACK_BLOCK_SIZE;
+
+	/* worst case: 32 bits per value plus reference and bit width */
+	long maxWords = (long)header.blockNum * (BITPACK_BLOCK_SIZE + 2) + 2;
+	uint32_t *data = (uint32_t *) calloc(maxWords, sizeof(uint32_t));
+	int *blockStart = (int *) malloc(sizeof(int) * (header.blockNum + 1));
+
+	if(!data || !blockStart){
+		printf("Failed to allocate memory to accomodate the column\n");
+		exit(-1);
+	}
+
+	long outOffset = 0;
+
+	for(int b=0;b<header.blockNum;b++){
+		long first = (long)b * BITPACK_BLOCK_SIZE;
+		long count = tupleNum - first < BITPACK_BLOCK_SIZE ? tupleNum - first : BITPACK_BLOCK_SIZE;
+
+		int minValue = content[first], maxValue = content[first];
+		for(long i=1;i<count;i++){
+			if(content[first+i] < minValue) minValue = content[first+i];
+			if(content[first+i] > maxValue) maxValue = content[first+i];
+		}
+
+		uint32_t range = (uint32_t)maxValue - (uint32_t)minValue;
+		int bitNum = 0;
+		while(bitNum < 32 && (range >> bitNum) != 0)
+			bitNum ++;
+
+		blockStart[b] = outOffset;
+		data[outOffset++] = (uint32_t)minValue;
+		data[outOffset++] = bitNum;
+
+		/* the tail of the last block is packed as zeros */
+		if(bitNum > 0){
+			for(long i=0;i<count;i++){
+				uint32_t delta = (uint32_t)content[first+i] - (uint32_t)minValue;
+				long bitPos = i * bitNum;
+				int shift = bitPos % 32;
+
+				data[outOffset + bitPos/32] |= delta << shift;
+				if(shift + bitNum > 32)
+					data[outOffset + bitPos/32 + 1] |= delta >> (32 - shift);
+			}
+		}
+
+		outOffset += (BITPACK_BLOCK_SIZE * bitNum + 31) / 32;
+	}
+
+	blockStart[header.blockNum] = outOffset;
+
+	/* the decoder always reads two consecutive words past the block header */
+	outOffset += 2;
+
+	int outFd = open(argv[2],O_RDWR|O_CREAT|O_TRUNC,0644);
+	if(outFd == -1){
+		printf("Failed to create output column\n");
+		exit(-1);
+	}
+
+	write(outFd, &header, sizeof(struct bitpackHeader));
+	write(outFd, blockStart, sizeof(int) * (header.blockNum + 1));
+	write(outFd, data, sizeof(uint32_t) * outOffset);
+
+	printf("%s: %ld bytes -> %ld bytes\n", argv[1], (long)st.st_size,
+		(long)(sizeof(struct bitpackHeader) + sizeof(int) * (header.blockNum + 1) + sizeof(uint32_t) * outOffset));
+
+	close(outFd);
+	munmap(content, st.st_size);
+	close(inFd);
+	free(data);
+	free(blockStart);
+
+	return 0;
+}
@@ -23,7 +23,7 @@
 #include <unistd.h>
 #include <sys/mman.h>
 #include <string.h>
-#include "../include/common.h"
+#include "include/common.h"
 
 #define	HHSIZE	(1024*1024)
 
@@ -35,9 +35,17 @@
 int main(int argc, char ** argv){
 
 	int res = 0;
+	int plain = 0;
+
+	/* -p: the input is a plain column without columnHeader, as written by the columnar loader */
+	if(argc == 4 && strcmp(argv[1],"-p") == 0){
+		plain = 1;
+		argv ++;
+		argc --;
+	}
 
 	if(argc !=3 ){
-		printf("Usage: dictCompression inputColumn outputColumn\n");
+		printf("Usage: dictCompression [-p] inputColumn outputColumn\n");
 		exit(-1);
 	}
 
@@ -55,7 +63,21 @@ int main(int argc, char ** argv){
 		exit(-1);
 	}
 
-	read(inFd, &header, sizeof(struct columnHeader));
+	long headerSize = sizeof(struct columnHeader);
+
+	if(plain){
+		struct stat st;
+		fstat(inFd, &st);
+		memset(&header, 0, sizeof(struct columnHeader));
+		header.totalTupleNum = st.st_size / sizeof(int);
+		header.tupleNum = header.totalTupleNum;
+		header.blockSize = st.st_size;
+		header.blockTotal = 1;
+		header.format = UNCOMPRESSED;
+		headerSize = 0;
+	}else{
+		read(inFd, &header, sizeof(struct columnHeader));
+	}
 
 	if(header.format != UNCOMPRESSED){
 		printf("The column has already been compressed. Nested Compression not supported yet\n");
@@ -68,11 +90,12 @@ int main(int argc, char ** argv){
 	long offset = 0;
 
 	for(int j=0;j<blockTotal;j++){
-		offset = j* sizeof(struct columnHeader) + tupleOffset * sizeof(int);
+		offset = j* headerSize + tupleOffset * sizeof(int);
 		lseek(inFd,offset,SEEK_SET);
-		read(inFd,&header, sizeof(struct columnHeader));
+		if(!plain)
+			read(inFd,&header, sizeof(struct columnHeader));
 		header.format = DICT;
-		offset += sizeof(struct columnHeader);
+		offset += headerSize;
 
 		tupleNum = header.tupleNum;
 		size = tupleNum * sizeof(int);
@@ -105,7 +128,7 @@ int main(int argc, char ** argv){
 
 				int j = 1;
 				while(hashTable[hKey] != -1 && hashTable[hKey] != key){
-					hKey = key % (HHSIZE + j*111) % HHSIZE; 
+					hKey = (hKey + 1) % HHSIZE;
 					j = j+1;
 				}
 
@@ -158,7 +181,7 @@ int main(int argc, char ** argv){
 			}else{
 				int j = 1;
 				while(result[hKey] !=-1){
-					hKey = key % (numOfDistinct + 111*j) % numOfDistinct;
+					hKey = (hKey + 1) % numOfDistinct;
 					j++;
 				}
 				result[hKey] = key;
@@ -172,7 +195,7 @@ int main(int argc, char ** argv){
 
 		int bitInInt = sizeof(int) * 8/ stride;
 
-		outFd = open(argv[2],O_RDWR|O_CREAT);
+		outFd = open(argv[2],O_RDWR|O_CREAT|O_TRUNC,0644);
 		if(outFd == -1){
 			printf("Failed to create output column\n");
 			exit(-1);
@@ -195,7 +218,7 @@ int main(int argc, char ** argv){
 
 				int j = 1;
 				while(result[hKey] != key){
-					hKey = key % (numOfDistinct + 111 * j) % numOfDistinct;
+					hKey = (hKey + 1) % numOfDistinct;
 					j++;
 				}
 
@@ -127,6 +127,36 @@ struct rleHeader{
     int dictNum;
 };
 
+/*
+ * bit-packed (frame of reference) columns are made of blocks of
+ * BITPACK_BLOCK_SIZE values. Each block stores its reference (the
+ * block minimum) and bit width, followed by the packed differences.
+ * The bitpackHeader is followed by blockNum+1 word offsets of the
+ * blocks in the data section, and then the data section itself.
+ */
+
+#define BITPACK_BLOCK_SIZE  128
+
+struct bitpackHeader{
+    int totalTupleNum;          /* the total number of tuples in this column */
+    int blockNum;               /* the number of bit-packed blocks */
+};
+
+/*
+ * zone maps keep the minimum and the maximum of every zone of
+ * ZONEMAP_ZONE_SIZE values of a column (one tile of the query
+ * kernels). The zoneMapHeader is followed by zoneNum minimums
+ * and then by zoneNum maximums.
+ */
+
+#define ZONEMAP_ZONE_SIZE   512
+
+struct zoneMapHeader{
+    int totalTupleNum;          /* the total number of tuples in this column */
+    int zoneSize;               /* the number of tuples in each zone */
+    int zoneNum;                /* the number of zones */
+};
+
 struct whereExp{
     int index;
     int relation;
@@ -19,6 +19,17 @@
 
 static char delimiter = '|';
 
+/* row count of each table, read back by the queries to size the columns */
+static void writeMetadata(char *table, long tupleNum){
+  FILE *meta = fopen("METADATA","a");
+  if(!meta){
+    printf("Failed to open METADATA\n");
+    exit(-1);
+  }
+  fprintf(meta,"%s %ld\n",table,tupleNum);
+  fclose(meta);
+}
+
 void supplier (FILE *fp, char *outName){
   struct supplier tmp;
   char data [1024] = {0};
@@ -164,6 +175,7 @@ void supplier (FILE *fp, char *outName){
     fclose(out[i]);
   }
 
+  writeMetadata(outName,tupleNum);
 }
 
 void customer (FILE *fp, char *outName){
@@ -321,6 +333,7 @@ void customer (FILE *fp, char *outName){
     fclose(out[i]);
   }
 
+  writeMetadata(outName,tupleNum);
 }
 
 void part (FILE *fp, char *outName){
@@ -488,6 +501,7 @@ void part (FILE *fp, char *outName){
     fclose(out[i]);
   }
 
+  writeMetadata(outName,tupleNum);
 }
 
 void ddate (FILE *fp, char *outName){
@@ -732,6 +746,7 @@ void ddate (FILE *fp, char *outName){
     fclose(out[i]);
   }
 
+  writeMetadata(outName,tupleNum);
 }
 
 void lineorder (FILE *fp, char *outName){
@@ -976,6 +991,7 @@ void lineorder (FILE *fp, char *outName){
     fclose(out[i]);
   }
 
+  writeMetadata(outName,tupleNum);
 }
 
 int main(int argc, char ** argv){
@@ -23,7 +23,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
-#include "../include/common.h"
+#include "include/common.h"
 
 /*
  * @file rle.c
@@ -36,8 +36,17 @@
 
 int main(int argc, char ** argv){
 
+	int plain = 0;
+
+	/* -p: the input is a plain column without columnHeader, as written by the columnar loader */
+	if(argc == 4 && strcmp(argv[1],"-p") == 0){
+		plain = 1;
+		argv ++;
+		argc --;
+	}
+
 	if(argc != 3){
-		printf("./rleCompresssion inputColumn outputColumn\n");
+		printf("./rleCompresssion [-p] inputColumn outputColumn\n");
 		exit(-1);
 	}
 
@@ -47,14 +56,28 @@ int main(int argc, char ** argv){
 		exit(-1);
 	}
 
-	int outFd = open(argv[2],O_RDWR|O_CREAT);
+	int outFd = open(argv[2],O_RDWR|O_CREAT|O_TRUNC,0644);
 	if(outFd == -1){
 		printf("Failed to create output column\n");
 		exit(-1);
 	}
 
 	struct columnHeader header;
-	read(inFd, &header, sizeof(struct columnHeader));
+	long headerSize = sizeof(struct columnHeader);
+
+	if(plain){
+		struct stat st;
+		fstat(inFd, &st);
+		memset(&header, 0, sizeof(struct columnHeader));
+		header.totalTupleNum = st.st_size / sizeof(int);
+		header.tupleNum = header.totalTupleNum;
+		header.blockSize = st.st_size;
+		header.blockTotal = 1;
+		header.format = UNCOMPRESSED;
+		headerSize = 0;
+	}else{
+		read(inFd, &header, sizeof(struct columnHeader));
+	}
 
 	int blockTotal = header.blockTotal;
 
@@ -62,10 +85,11 @@ int main(int argc, char ** argv){
 	long offset = 0;
 
 	for(int i=0;i<blockTotal;i++){
-		offset = i*sizeof(struct columnHeader) + tupleOffset * sizeof(int);
+		offset = i*headerSize + tupleOffset * sizeof(int);
 		lseek(inFd,offset,SEEK_SET);
-		read(inFd, &header, sizeof(struct columnHeader));
-		offset += sizeof(struct columnHeader);
+		if(!plain)
+			read(inFd, &header, sizeof(struct columnHeader));
+		offset += headerSize;
 		long tupleNum = header.tupleNum;
 		long size = tupleNum * sizeof(int);
         	char *content = (char *) malloc(size);
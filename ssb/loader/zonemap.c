@@ -0,0 +1,89 @@
+/*
+ * @file zonemap.c
+ * Build the zone map (minimum and maximum of every zone of
+ * ZONEMAP_ZONE_SIZE values) of a column, so that the query
+ * kernels can skip the tiles that cannot match a range predicate.
+ * The input is a plain column as written by the columnar loader.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "include/common.h"
+
+int main(int argc, char ** argv){
+
+	if(argc !=3 ){
+		printf("Usage: zoneMap inputColumn outputZoneMap\n");
+		exit(-1);
+	}
+
+	int inFd = open(argv[1],O_RDONLY);
+
+	if(inFd == -1){
+		printf("Failed to open the input column\n");
+		exit(-1);
+	}
+
+	struct stat st;
+	fstat(inFd, &st);
+
+	long tupleNum = st.st_size / sizeof(int);
+	if(tupleNum == 0){
+		printf("The input column is empty\n");
+		exit(-1);
+	}
+
+	int *content = (int *) mmap(0,st.st_size,PROT_READ,MAP_SHARED,inFd,0);
+	if(content == MAP_FAILED){
+		printf("Failed to map the input column\n");
+		exit(-1);
+	}
+
+	struct zoneMapHeader header;
+	header.totalTupleNum = tupleNum;
+	header.zoneSize = ZONEMAP_ZONE_SIZE;
+	header.zoneNum = (tupleNum + ZONEMAP_ZONE_SIZE - 1) / ZONEMAP_ZONE_SIZE;
+
+	int *zoneMin = (int *) malloc(sizeof(int) * header.zoneNum);
+	int *zoneMax = (int *) malloc(sizeof(int) * header.zoneNum);
+
+	if(!zoneMin || !zoneMax){
+		printf("Failed to allocate memory for the zone map\n");
+		exit(-1);
+	}
+
+	for(int z=0;z<header.zoneNum;z++){
+		long first = (long)z * ZONEMAP_ZONE_SIZE;
+		long last = first + ZONEMAP_ZONE_SIZE < tupleNum ? first + ZONEMAP_ZONE_SIZE : tupleNum;
+
+		zoneMin[z] = content[first];
+		zoneMax[z] = content[first];
+		for(long i=first+1;i<last;i++){
+			if(content[i] < zoneMin[z]) zoneMin[z] = content[i];
+			if(content[i] > zoneMax[z]) zoneMax[z] = content[i];
+		}
+	}
+
+	int outFd = open(argv[2],O_RDWR|O_CREAT|O_TRUNC,0644);
+	if(outFd == -1){
+		printf("Failed to create output zone map\n");
+		exit(-1);
+	}
+
+	write(outFd, &header, sizeof(struct zoneMapHeader));
+	write(outFd, zoneMin, sizeof(int) * header.zoneNum);
+	write(outFd, zoneMax, sizeof(int) * header.zoneNum);
+
+	close(outFd);
+	munmap(content, st.st_size);
+	close(inFd);
+	free(zoneMin);
+	free(zoneMax);
+
+	return 0;
+}
@@ -27,8 +27,23 @@ def transform(dataset, scale_factor):
     op = '../data/s%d_columnar/' % scale_factor
     with cd(path):
         os.system('mkdir -p %s' % op)
+        os.system('rm -f %s/METADATA' % op)
         os.system('python convert.py ../data/s%d/' % scale_factor)
         os.system('./loader --lineorder %s/lineorder.tbl --ddate %s/date.tbl --customer %s/customer.tbl.p --supplier %s/supplier.tbl.p --part %s/part.tbl.p --datadir %s' % (ip, ip, ip, ip, ip, op))
+        # bit-packed copies of the lineorder columns scanned by q11_bitpacked
+        if os.path.exists('./bitpackCompression'):
+            for col in [5, 8, 9, 11]:
+                os.system('./bitpackCompression %s/LINEORDER%d %s/LINEORDER%d.bp' % (op, col, op, col))
+        # dictionary-encoded copy of p_brand1 for q23
+        if os.path.exists('./dictCompression'):
+            os.system('./dictCompression -p %s/PART4 %s/PART4.dict' % (op, op))
+        # run-length encoded lo_orderdate for q11_rle, which pays
+        # off once lineorder has been sorted by lo_orderdate
+        if os.path.exists('./rleCompression'):
+            os.system('./rleCompression -p %s/LINEORDER5 %s/LINEORDER5.rle' % (op, op))
+        # zone map of lo_orderdate, used to skip tiles in q11, q12 and q34
+        if os.path.exists('./zoneMap'):
+            os.system('./zoneMap %s/LINEORDER5 %s/LINEORDER5.zm' % (op, op))
 
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description = 'data gen')